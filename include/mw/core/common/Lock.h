@@ -6,254 +6,271 @@
 
 #include <mw/core/traits/Batchable.h>
 #include <mw/core/exceptions/UnimplementedException.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <shared_mutex>
 #include <mutex>
+#include <thread>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
 template<class T>
-class Reader
+class Locked;
+
+//
+// What every copy of a Locked<T> shares: the object, its mutex, and the object's IBatchable interface, if it has one.
+// The IBatchable is looked up once, when the Locked<T> is created, rather than on every write.
+//
+template<class T>
+struct LockedState
 {
-    template<class U>
-    class InnerReader
+    LockedState(std::shared_ptr<T> pObject_)
+        : pObject(std::move(pObject_)), pBatchable(GetBatchable(pObject.get())) { }
+
+    std::shared_ptr<T> pObject;
+    Traits::IBatchable* pBatchable;
+    mutable std::shared_mutex mutex;
+
+private:
+    template<typename U = T, typename std::enable_if_t<std::is_polymorphic_v<U>>* = nullptr>
+    static Traits::IBatchable* GetBatchable(U* pObject)
     {
-    public:
-        InnerReader(std::shared_ptr<const U> pObject, std::shared_ptr<std::shared_mutex> pMutex, const bool lock, const bool unlock)
-            : m_pObject(pObject), m_pMutex(pMutex), m_unlock(unlock)
-        {
-            if (lock)
-            {
-                m_pMutex->lock_shared();
-            }
-        }
+        return dynamic_cast<Traits::IBatchable*>(pObject);
+    }
 
-        ~InnerReader()
-        {
-            if (m_unlock)
-            {
-                m_pMutex->unlock_shared();
-            }
-        }
+    template<typename U = T, typename std::enable_if_t<!std::is_polymorphic_v<U>>* = nullptr>
+    static Traits::IBatchable* GetBatchable(U*)
+    {
+        return nullptr;
+    }
+};
 
-        std::shared_ptr<const U> m_pObject;
-        std::shared_ptr<std::shared_mutex> m_pMutex;
-        bool m_unlock;
-    };
+//
+// Holds a shared lock on a Locked<T> until destroyed.
+// Readers are moved rather than copied, and don't allocate, so they must not outlive every copy of the Locked<T>.
+//
+template<class T>
+class Reader
+{
+    friend class Locked<T>;
 
 public:
-    static Reader Create(std::shared_ptr<T> pObject, std::shared_ptr<std::shared_mutex> pMutex, const bool lock, const bool unlock)
+    Reader() noexcept : m_pState(nullptr), m_unlock(false) { }
+
+    Reader(Reader&& other) noexcept
+        : m_pState(std::exchange(other.m_pState, nullptr)), m_unlock(std::exchange(other.m_unlock, false)) { }
+
+    Reader& operator=(Reader&& other) noexcept
     {
-        return Reader(std::shared_ptr<InnerReader<T>>(new InnerReader<T>(pObject, pMutex, lock, unlock)));
+        if (this != &other)
+        {
+            Release();
+            m_pState = std::exchange(other.m_pState, nullptr);
+            m_unlock = std::exchange(other.m_unlock, false);
+        }
+
+        return *this;
     }
 
-    Reader() = default;
-    virtual ~Reader() = default;
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    ~Reader() { Release(); }
 
     const T* operator->() const
     {
-        return m_pReader->m_pObject.get();
+        return m_pState->pObject.get();
     }
 
     const T& operator*() const
     {
-        return *m_pReader->m_pObject;
+        return *m_pState->pObject;
     }
 
     std::shared_ptr<const T> GetShared() const
     {
-        return m_pReader->m_pObject;
+        return m_pState->pObject;
     }
 
     bool IsNull() const
     {
-        return m_pReader->m_pObject == nullptr;
+        return m_pState == nullptr || m_pState->pObject == nullptr;
     }
 
 private:
-    Reader(std::shared_ptr<InnerReader<T>> pReader)
-        : m_pReader(pReader)
+    Reader(const LockedState<T>* pState, const bool lock, const bool unlock)
+        : m_pState(pState), m_unlock(unlock)
     {
-
+        if (lock)
+        {
+            m_pState->mutex.lock_shared();
+        }
     }
 
-    std::shared_ptr<InnerReader<T>> m_pReader;
-};
-
-class MutexUnlocker
-{
-public:
-    MutexUnlocker(std::shared_ptr<std::shared_mutex> pMutex)
-        : m_pMutex(pMutex)
+    void Release() noexcept
     {
+        if (m_unlock)
+        {
+            m_pState->mutex.unlock_shared();
+            m_unlock = false;
+        }
 
+        m_pState = nullptr;
     }
 
-    ~MutexUnlocker()
-    {
-        m_pMutex->unlock();
-    }
-
-private:
-    std::shared_ptr<std::shared_mutex> m_pMutex;
+    const LockedState<T>* m_pState;
+    bool m_unlock;
 };
 
+//
+// Holds the exclusive lock on a Locked<T> until destroyed or cleared.
+//
+// If the object is IBatchable, it's marked dirty when the lock is taken. When the lock is released, a plain write is
+// committed, while a batch write is rolled back, unless the object was committed (and so marked clean) in the meantime.
+//
+// Like Readers, Writers are moved rather than copied, don't allocate, and must not outlive every copy of the Locked<T>.
+//
 template<class T>
-class Writer : virtual public Reader<T>
+class Writer
 {
-    template<class U>
-    class InnerWriter
-    {
-    public:
-        InnerWriter(const bool batched, std::shared_ptr<U> pObject, std::shared_ptr<std::shared_mutex> pMutex, const bool lock)
-            : m_batched(batched), m_pObject(pObject), m_pMutex(pMutex)
-        {
-            if (lock)
-            {
-                m_pMutex->lock();
-            }
-
-            OnInitWrite();
-        }
-
-        virtual ~InnerWriter()
-        {
-            // Using MutexUnlocker in case exception is thrown.
-            MutexUnlocker unlocker(m_pMutex);
-
-            if (m_batched)
-            {
-                Rollback();
-            }
-            else
-            {
-                Commit();
-            }
-
-            OnEndWrite();
-        }
-
-        void Commit()
-        {
-            Traits::IBatchable* pBatchable = GetBatchable(m_pObject);
-            if (pBatchable != nullptr)
-            {
-                if (pBatchable->IsDirty())
-                {
-                    pBatchable->Commit();
-                    pBatchable->SetDirty(false);
-                }
-            }
-        }
-
-        void Rollback()
-        {
-            Traits::IBatchable* pBatchable = GetBatchable(m_pObject);
-            if (pBatchable != nullptr)
-            {
-                if (pBatchable->IsDirty())
-                {
-                    pBatchable->Rollback();
-                    pBatchable->SetDirty(false);
-                }
-            }
-        }
-
-        void OnInitWrite()
-        {
-            Traits::IBatchable* pBatchable = GetBatchable(m_pObject);
-            if (pBatchable != nullptr)
-            {
-                pBatchable->SetDirty(true);
-                pBatchable->OnInitWrite();
-            }
-        }
-
-        void OnEndWrite()
-        {
-            Traits::IBatchable* pBatchable = GetBatchable(m_pObject);
-            if (pBatchable != nullptr)
-            {
-                pBatchable->OnEndWrite();
-            }
-        }
+    friend class Locked<T>;
+    friend class MultiLocker;
 
-        bool m_batched;
-        std::shared_ptr<U> m_pObject;
-        std::shared_ptr<std::shared_mutex> m_pMutex;
+public:
+    Writer() noexcept : m_pState(nullptr), m_batched(false) { }
 
-    private:
-        template<typename V = void, typename std::enable_if_t<std::is_polymorphic_v<U>, V>* = nullptr>
-        Traits::IBatchable* GetBatchable(const std::shared_ptr<U>& pObject) const
-        {
-            return dynamic_cast<Traits::IBatchable*>(pObject.get());
-        }
+    Writer(Writer&& other) noexcept
+        : m_pState(std::exchange(other.m_pState, nullptr)), m_batched(other.m_batched) { }
 
-        template<typename V = void, typename std::enable_if_t<!std::is_polymorphic_v<U>, V>* = nullptr>
-        Traits::IBatchable* GetBatchable(const std::shared_ptr<U>&) const
+    Writer& operator=(Writer&& other)
+    {
+        if (this != &other)
         {
-            return nullptr;
+            Clear();
+            m_pState = std::exchange(other.m_pState, nullptr);
+            m_batched = other.m_batched;
         }
-    };
 
-public:
-    static Writer Create(const bool batched, std::shared_ptr<T> pObject, std::shared_ptr<std::shared_mutex> pMutex, const bool lock)
-    {
-        return Writer(std::shared_ptr<InnerWriter<T>>(new InnerWriter<T>(batched, pObject, pMutex, lock)));
+        return *this;
     }
 
-    Writer() = default;
-    virtual ~Writer() = default;
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    ~Writer() { Clear(); }
 
     T* operator->()
     {
-        return m_pWriter->m_pObject.get();
+        return m_pState->pObject.get();
     }
 
     const T* operator->() const
     {
-        return m_pWriter->m_pObject.get();
+        return m_pState->pObject.get();
     }
 
     T& operator*()
     {
-        return *m_pWriter->m_pObject;
+        return *m_pState->pObject;
     }
 
     const T& operator*() const
     {
-        return *m_pWriter->m_pObject;
+        return *m_pState->pObject;
     }
 
     std::shared_ptr<T> GetShared()
     {
-        return m_pWriter->m_pObject;
+        return m_pState->pObject;
     }
 
     std::shared_ptr<const T> GetShared() const
     {
-        return m_pWriter->m_pObject;
+        return m_pState->pObject;
     }
 
     bool IsNull() const
     {
-        return m_pWriter == nullptr;
+        return m_pState == nullptr;
     }
 
+    //
+    // Commits or rolls back, then releases the lock.
+    //
     void Clear()
     {
-        m_pWriter = nullptr;
+        if (m_pState == nullptr)
+        {
+            return;
+        }
+
+        // Using MutexUnlocker in case exception is thrown.
+        MutexUnlocker unlocker(std::exchange(m_pState, nullptr));
+
+        Traits::IBatchable* pBatchable = unlocker.GetState().pBatchable;
+        if (pBatchable != nullptr)
+        {
+            if (pBatchable->IsDirty())
+            {
+                if (m_batched)
+                {
+                    pBatchable->Rollback();
+                }
+                else
+                {
+                    pBatchable->Commit();
+                }
+
+                pBatchable->SetDirty(false);
+            }
+
+            pBatchable->OnEndWrite();
+        }
     }
 
 private:
-    Writer(std::shared_ptr<InnerWriter<T>> pWriter)
-        : m_pWriter(pWriter), Reader<T>(Reader<T>::Create(pWriter->m_pObject, pWriter->m_pMutex, false, false))
+    class MutexUnlocker
+    {
+    public:
+        MutexUnlocker(LockedState<T>* pState) : m_pState(pState) { }
+        ~MutexUnlocker() { m_pState->mutex.unlock(); }
+
+        LockedState<T>& GetState() noexcept { return *m_pState; }
+
+    private:
+        LockedState<T>* m_pState;
+    };
+
+    Writer(LockedState<T>* pState, const bool batched, const bool lock)
+        : m_pState(pState), m_batched(batched)
     {
+        if (lock)
+        {
+            m_pState->mutex.lock();
+        }
 
+        Traits::IBatchable* pBatchable = m_pState->pBatchable;
+        if (pBatchable != nullptr)
+        {
+            pBatchable->SetDirty(true);
+            pBatchable->OnInitWrite();
+        }
     }
 
-    std::shared_ptr<InnerWriter<T>> m_pWriter;
+    LockedState<T>* m_pState;
+    bool m_batched;
 };
 
+//
+// Guards an object with a reader-writer lock. Copies share the object and the lock.
+//
+// Read() and Write() return guards that live on the stack, so taking the lock costs no allocations or
+// reference counting, only the lock itself.
+//
 template<class T>
 class Locked
 {
@@ -261,7 +278,7 @@ class Locked
 
 public:
     Locked(std::shared_ptr<T> pObject)
-        : m_pObject(pObject), m_pMutex(std::make_shared<std::shared_mutex>())
+        : m_pState(std::make_shared<LockedState<T>>(std::move(pObject)))
     {
 
     }
@@ -270,49 +287,153 @@ public:
 
     Reader<T> Read() const
     {
-        return Reader<T>::Create(m_pObject, m_pMutex, true, true);
+        return Reader<T>(m_pState.get(), true, true);
     }
 
     Reader<T> Read(std::adopt_lock_t) const
     {
-        return Reader<T>::Create(m_pObject, m_pMutex, false, true);
+        return Reader<T>(m_pState.get(), false, true);
+    }
+
+    //
+    // Calls the object's CreateSnapshot() without taking the lock, so readers never wait behind a writer.
+    // Only available for objects whose CreateSnapshot() is safe to call while another thread is writing.
+    //
+    template<typename U = T>
+    auto Snapshot() const -> decltype(std::declval<const U&>().CreateSnapshot())
+    {
+        return m_pState->pObject->CreateSnapshot();
     }
 
     Writer<T> Write()
     {
-        return Writer<T>::Create(false, m_pObject, m_pMutex, true);
+        return Writer<T>(m_pState.get(), false, true);
     }
 
     Writer<T> Write(std::adopt_lock_t)
     {
-        return Writer<T>::Create(false, m_pObject, m_pMutex, false);
+        return Writer<T>(m_pState.get(), false, false);
     }
 
     Writer<T> BatchWrite()
     {
-        Traits::IBatchable* pBatchable = dynamic_cast<Traits::IBatchable*>(m_pObject.get());
-        if (pBatchable == nullptr)
+        if (m_pState->pBatchable == nullptr)
         {
             ThrowUnimplemented("BatchWrite only implemented for batchable objects");
         }
 
-        return Writer<T>::Create(true, m_pObject, m_pMutex, true);
+        return Writer<T>(m_pState.get(), true, true);
     }
 
     Writer<T> BatchWrite(std::adopt_lock_t)
     {
-        Traits::IBatchable* pBatchable = dynamic_cast<Traits::IBatchable*>(m_pObject.get());
-        if (pBatchable == nullptr)
+        if (m_pState->pBatchable == nullptr)
         {
             ThrowUnimplemented("BatchWrite only implemented for batchable objects");
         }
 
-        return Writer<T>::Create(true, m_pObject, m_pMutex, false);
+        return Writer<T>(m_pState.get(), true, false);
     }
 
 private:
-    std::shared_ptr<T> m_pObject;
-    std::shared_ptr<std::shared_mutex> m_pMutex;
+    std::shared_ptr<LockedState<T>> m_pState;
+};
+
+//
+// Guards a small, trivially copyable value that's read far more often than it's written, like a set of stats.
+//
+// Reads are optimistic: they copy the value without locking, then retry if a write happened meanwhile (a seqlock),
+// so readers never block writers, or each other. Writes are serialized by a mutex.
+// The value is stored as atomic words, so a read that races a write is only ever discarded, never undefined.
+//
+template<class T>
+class SeqLocked
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLocked values are copied word by word");
+
+public:
+    SeqLocked(const T& value = T()) : m_sequence(0)
+    {
+        StoreWords(value);
+    }
+
+    SeqLocked(const SeqLocked&) = delete;
+    SeqLocked& operator=(const SeqLocked&) = delete;
+
+    T Load() const noexcept
+    {
+        while (true)
+        {
+            const uint64_t sequence = m_sequence.load(std::memory_order_acquire);
+            if ((sequence & 1) != 0)
+            {
+                // A write is in progress.
+                std::this_thread::yield();
+                continue;
+            }
+
+            const T value = LoadWords();
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                return value;
+            }
+        }
+    }
+
+    void Store(const T& value)
+    {
+        Update([&value](T& current) { current = value; });
+    }
+
+    //
+    // Calls update with a copy of the value, and publishes the result.
+    //
+    template<typename F>
+    void Update(const F& update)
+    {
+        std::unique_lock<std::mutex> lock(m_writeMutex);
+
+        T value = LoadWords();
+        update(value);
+
+        const uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        StoreWords(value);
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+private:
+    static constexpr size_t NUM_WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    T LoadWords() const noexcept
+    {
+        std::array<uint64_t, NUM_WORDS> words;
+        for (size_t i = 0; i < NUM_WORDS; i++)
+        {
+            words[i] = m_words[i].load(std::memory_order_relaxed);
+        }
+
+        T value;
+        std::memcpy(&value, words.data(), sizeof(T));
+        return value;
+    }
+
+    void StoreWords(const T& value) noexcept
+    {
+        std::array<uint64_t, NUM_WORDS> words = { 0 };
+        std::memcpy(words.data(), &value, sizeof(T));
+        for (size_t i = 0; i < NUM_WORDS; i++)
+        {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    std::atomic<uint64_t> m_sequence;
+    std::array<std::atomic<uint64_t>, NUM_WORDS> m_words;
+    std::mutex m_writeMutex;
 };
 
 
@@ -342,7 +463,7 @@ public:
     template <class T1, class T2, class... TN>
     std::tuple<Writer<T1>, Writer<T2>, Writer<TN> ...> Lock(const Locked<T1>& lock1, const Locked<T2>& lock2, const Locked<TN>&... lockN)
     {
-        std::lock(*lock1.m_pMutex, *lock2.m_pMutex, ConvertArg(lockN) ...);
+        std::lock(ConvertArg(lock1), ConvertArg(lock2), ConvertArg(lockN) ...);
         return std::make_tuple(GetWriter(lock1), GetWriter(lock2), GetWriter(lockN) ...);
     }
 
@@ -352,7 +473,7 @@ public:
     template <class T1, class T2, class... TN>
     std::tuple<Writer<T1>, Writer<T2>, Writer<TN> ...> BatchLock(const Locked<T1>& lock1, const Locked<T2>& lock2, const Locked<TN>&... lockN)
     {
-        std::lock(*lock1.m_pMutex, *lock2.m_pMutex, ConvertArg(lockN) ...);
+        std::lock(ConvertArg(lock1), ConvertArg(lock2), ConvertArg(lockN) ...);
         return std::make_tuple(GetBatchWriter(lock1), GetBatchWriter(lock2), GetBatchWriter(lockN) ...);
     }
 
@@ -374,25 +495,31 @@ private:
     }
 
     template<class T>
-    static std::shared_mutex& ConvertArg(Locked<T> lock)
+    static std::shared_mutex& ConvertArg(const Locked<T>& lock)
+    {
+        return lock.m_pState->mutex;
+    }
+
+    template<class T>
+    static SharedOnlyMutex ConvertArgShared(const Locked<T>& lock)
     {
-        return *lock.m_pMutex;
+        return SharedOnlyMutex(lock.m_pState->mutex);
     }
 
     template<class T>
-    static SharedOnlyMutex ConvertArgShared(Locked<T> lock)
+    static Writer<T> GetWriter(const Locked<T>& lock)
     {
-        return SharedOnlyMutex(*lock.m_pMutex);
+        return Writer<T>(lock.m_pState.get(), false, false);
     }
 
     template<class T>
-    static Writer<T> GetWriter(Locked<T> lock)
+    static Writer<T> GetBatchWriter(const Locked<T>& lock)
     {
-        return lock.BatchWrite(std::adopt_lock);
+        return Writer<T>(lock.m_pState.get(), true, false);
     }
 
     template<class T>
-    static Reader<T> GetReader(Locked<T> lock)
+    static Reader<T> GetReader(const Locked<T>& lock)
     {
         return lock.Read(std::adopt_lock);
     }
@@ -4,12 +4,46 @@
 #include <mw/core/util/StringUtil.h>
 #include <mw/core/file/FilePath.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
 #ifdef MW_COMMON
 #define LOGGER_API EXPORT
 #else
 #define LOGGER_API IMPORT
 #endif
 
+//
+// Statements below this level are compiled out, so they cost nothing at runtime, and their arguments are never evaluated.
+// Release builds keep INFO and above, unless MW_LOG_MIN_LEVEL is given (1 for TRACE through 5 for ERR).
+//
+#ifndef MW_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define MW_LOG_MIN_LEVEL 3
+#else
+#define MW_LOG_MIN_LEVEL 1
+#endif
+#endif
+
+//
+// The module a statement's runtime level is looked up under. Each library defines its own.
+//
+#ifndef MW_LOG_MODULE
+#if defined(MW_DATABASE)
+#define MW_LOG_MODULE "DB"
+#elif defined(MW_CRYPTO)
+#define MW_LOG_MODULE "CRYPTO"
+#elif defined(MW_NET)
+#define MW_LOG_MODULE "NET"
+#elif defined(MW_COMMON)
+#define MW_LOG_MODULE "COMMON"
+#else
+#define MW_LOG_MODULE "CORE"
+#endif
+#endif
+
 namespace LoggerAPI
 {
     enum class LogFile
@@ -28,65 +62,160 @@ namespace LoggerAPI
         ERR = 5
     };
 
-    LOGGER_API void Initialize(const FilePath& logDirectory, const std::string& logLevel);
+    //
+    // What a logging thread does when the async queue is full.
+    // Warnings and errors always BLOCK, whatever the policy.
+    //
+    enum class OverflowPolicy
+    {
+        // Wait for the writer to make space.
+        BLOCK,
+
+        // Drop the message being logged.
+        DROP_NEWEST,
+
+        // Drop the oldest queued message to make space.
+        DROP_OLDEST
+    };
+
+    struct Options
+    {
+        // When true, messages are queued and written by a background thread, so logging never waits on the disk.
+        bool async = true;
+
+        // Number of messages the async queue holds. Rounded up to a power of 2.
+        size_t queueSize = 8192;
+
+        OverflowPolicy overflowPolicy = OverflowPolicy::DROP_NEWEST;
+
+        // How often the writer flushes the files while messages trickle in. Warnings and errors are flushed immediately.
+        std::chrono::milliseconds flushInterval = std::chrono::seconds(1);
+    };
+
+    struct Stats
+    {
+        // Messages dropped because the queue was full.
+        uint64_t numDropped;
+
+        // Messages written to the files.
+        uint64_t numWritten;
+
+        // Messages waiting in the queue, and the most there have ever been.
+        size_t queueDepth;
+        size_t maxQueueDepth;
+    };
+
+    //
+    // logLevel is the level for every module, optionally followed by levels for individual modules,
+    // like "INFO,DB=TRACE,NET=WARN".
+    //
+    LOGGER_API void Initialize(const FilePath& logDirectory, const std::string& logLevel, const Options& options = Options());
+
+    //
+    // Waits for every message logged so far to be written, and flushes the files.
+    //
     LOGGER_API void Flush();
 
+    LOGGER_API Stats GetStats() noexcept;
+
+    //
+    // The level for modules without a level of their own. NONE if logging is off.
+    //
     LOGGER_API LogLevel GetLogLevel(const LogFile file) noexcept;
 
+    //
+    // Changes the level while running. An empty module sets the level for every module without a level of its own.
+    // Setting a module to NONE turns it off.
+    //
+    LOGGER_API void SetLogLevel(const LogFile file, const std::string& module, const LogLevel logLevel);
+
+    //
+    // Removes the module's own level, so it follows the default level again.
+    //
+    LOGGER_API void ClearLogLevel(const LogFile file, const std::string& module);
+
+    //
+    // The lowest level a module logs at, updated whenever its level changes.
+    // The logging macros look this up once per statement, and keep the reference, so checking it is one atomic load.
+    //
+    LOGGER_API const std::atomic<uint8_t>& GetThreshold(const LogFile file, const char* module);
+
+    //
+    // threshold is the logging module's, from GetThreshold(). Messages below it are dropped before anything is allocated.
+    //
     LOGGER_API void Log(
         const LogFile file,
         const LogLevel logLevel,
+        const std::atomic<uint8_t>& threshold,
         const std::string& function,
         const size_t line,
         const std::string& message
     ) noexcept;
 }
 
+//
+// Formats and logs the message. The logging macros only call this once they've checked the level.
+//
 template<typename ... Args>
 static void LOG_F(
     const LoggerAPI::LogFile file,
     const LoggerAPI::LogLevel logLevel,
+    const std::atomic<uint8_t>& threshold,
     const std::string& function,
     const size_t line,
     const char* format,
     const Args& ... args) noexcept
 {
-    if (logLevel >= GetLogLevel(file))
+    try
+    {
+        std::string message = StringUtil::Format(format, args...);
+        Log(file, logLevel, threshold, function, line, message);
+    }
+    catch (std::exception&)
     {
-        try
-        {
-            std::string message = StringUtil::Format(format, args...);
-            Log(file, logLevel, function, line, message);
-        }
-        catch (std::exception&)
-        {
-            // Logger failure should not disrupt program flow
-        }
+        // Logger failure should not disrupt program flow
     }
 }
 
+//
+// Logs through logFn only if the level is compiled in, and enabled for this module,
+// so the arguments aren't evaluated, or the message formatted, unless it will be written.
+//
+#define MW_LOG_IF_ENABLED(file, level, logFn, ...) \
+    do \
+    { \
+        if constexpr ((uint8_t)(level) >= MW_LOG_MIN_LEVEL) \
+        { \
+            static const std::atomic<uint8_t>& mwLogThreshold = LoggerAPI::GetThreshold(file, MW_LOG_MODULE); \
+            if ((uint8_t)(level) >= mwLogThreshold.load(std::memory_order_relaxed)) \
+            { \
+                logFn(file, level, mwLogThreshold, __FUNCTION__, __LINE__, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
 // Node Logger
-#define LOG_TRACE(message) LoggerAPI::Log(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::TRACE, __FUNCTION__, __LINE__, message)
-#define LOG_DEBUG(message) LoggerAPI::Log(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::DEBUG, __FUNCTION__, __LINE__, message)
-#define LOG_INFO(message) LoggerAPI::Log(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::INFO, __FUNCTION__, __LINE__, message)
-#define LOG_WARNING(message) LoggerAPI::Log(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::WARN, __FUNCTION__, __LINE__, message)
-#define LOG_ERROR(message) LoggerAPI::Log(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::ERR, __FUNCTION__, __LINE__, message)
-
-#define LOG_TRACE_F(message, ...) LOG_F(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::TRACE, __FUNCTION__, __LINE__, message, __VA_ARGS__)
-#define LOG_DEBUG_F(message, ...) LOG_F(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::DEBUG, __FUNCTION__, __LINE__, message, __VA_ARGS__)
-#define LOG_INFO_F(message, ...) LOG_F(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::INFO, __FUNCTION__, __LINE__, message, __VA_ARGS__)
-#define LOG_WARNING_F(message, ...) LOG_F(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::WARN, __FUNCTION__, __LINE__, message, __VA_ARGS__)
-#define LOG_ERROR_F(message, ...) LOG_F(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::ERR, __FUNCTION__, __LINE__, message, __VA_ARGS__)
+#define LOG_TRACE(message) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::TRACE, LoggerAPI::Log, message)
+#define LOG_DEBUG(message) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::DEBUG, LoggerAPI::Log, message)
+#define LOG_INFO(message) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::INFO, LoggerAPI::Log, message)
+#define LOG_WARNING(message) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::WARN, LoggerAPI::Log, message)
+#define LOG_ERROR(message) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::ERR, LoggerAPI::Log, message)
+
+#define LOG_TRACE_F(message, ...) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::TRACE, LOG_F, message, __VA_ARGS__)
+#define LOG_DEBUG_F(message, ...) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::DEBUG, LOG_F, message, __VA_ARGS__)
+#define LOG_INFO_F(message, ...) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::INFO, LOG_F, message, __VA_ARGS__)
+#define LOG_WARNING_F(message, ...) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::WARN, LOG_F, message, __VA_ARGS__)
+#define LOG_ERROR_F(message, ...) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::ERR, LOG_F, message, __VA_ARGS__)
 
 // Wallet Logger
-#define WALLET_TRACE(message) LoggerAPI::Log(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::TRACE, __FUNCTION__, __LINE__, message)
-#define WALLET_DEBUG(message) LoggerAPI::Log(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::DEBUG, __FUNCTION__, __LINE__, message)
-#define WALLET_INFO(message) LoggerAPI::Log(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::INFO, __FUNCTION__, __LINE__, message)
-#define WALLET_WARNING(message) LoggerAPI::Log(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::WARN, __FUNCTION__, __LINE__, message)
-#define WALLET_ERROR(message) LoggerAPI::Log(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::ERR, __FUNCTION__, __LINE__, message)
-
-#define WALLET_TRACE_F(message, ...) LOG_F(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::TRACE, __FUNCTION__, __LINE__, message, __VA_ARGS__)
-#define WALLET_DEBUG_F(message, ...) LOG_F(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::DEBUG, __FUNCTION__, __LINE__, message, __VA_ARGS__)
-#define WALLET_INFO_F(message, ...) LOG_F(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::INFO, __FUNCTION__, __LINE__, message, __VA_ARGS__)
-#define WALLET_WARNING_F(message, ...) LOG_F(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::WARN, __FUNCTION__, __LINE__, message, __VA_ARGS__)
-#define WALLET_ERROR_F(message, ...) LOG_F(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::ERR, __FUNCTION__, __LINE__, message, __VA_ARGS__)
\ No newline at end of file
+#define WALLET_TRACE(message) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::TRACE, LoggerAPI::Log, message)
+#define WALLET_DEBUG(message) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::DEBUG, LoggerAPI::Log, message)
+#define WALLET_INFO(message) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::INFO, LoggerAPI::Log, message)
+#define WALLET_WARNING(message) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::WARN, LoggerAPI::Log, message)
+#define WALLET_ERROR(message) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::ERR, LoggerAPI::Log, message)
+
+#define WALLET_TRACE_F(message, ...) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::TRACE, LOG_F, message, __VA_ARGS__)
+#define WALLET_DEBUG_F(message, ...) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::DEBUG, LOG_F, message, __VA_ARGS__)
+#define WALLET_INFO_F(message, ...) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::INFO, LOG_F, message, __VA_ARGS__)
+#define WALLET_WARNING_F(message, ...) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::WARN, LOG_F, message, __VA_ARGS__)
+#define WALLET_ERROR_F(message, ...) MW_LOG_IF_ENABLED(LoggerAPI::LogFile::WALLET, LoggerAPI::LogLevel::ERR, LOG_F, message, __VA_ARGS__)
\ No newline at end of file
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <mw/core/common/ImportExport.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef MW_COMMON
+#define METRICS_API EXPORT
+#else
+#define METRICS_API IMPORT
+#endif
+
+//
+// A monotonically increasing count.
+//
+// The count is split over shards on separate cache lines, and each thread always adds to the same shard,
+// so threads incrementing the same counter don't contend. Reading it sums the shards.
+//
+class Counter
+{
+public:
+    Counter() = default;
+    Counter(const Counter&) = delete;
+    Counter& operator=(const Counter&) = delete;
+
+    void Add(const uint64_t amount = 1) noexcept
+    {
+        m_shards[GetShardIndex()].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    uint64_t GetValue() const noexcept
+    {
+        uint64_t value = 0;
+        for (const Shard& shard : m_shards)
+        {
+            value += shard.value.load(std::memory_order_relaxed);
+        }
+
+        return value;
+    }
+
+private:
+    static constexpr size_t NUM_SHARDS = 16;
+
+    struct alignas(64) Shard
+    {
+        std::atomic<uint64_t> value{ 0 };
+    };
+
+    static size_t GetShardIndex() noexcept
+    {
+        static std::atomic<size_t> nextIndex(0);
+        static thread_local const size_t index = nextIndex.fetch_add(1, std::memory_order_relaxed) % NUM_SHARDS;
+        return index;
+    }
+
+    std::array<Shard, NUM_SHARDS> m_shards;
+};
+
+//
+// A value that can go up and down, such as a size.
+//
+class Gauge
+{
+public:
+    Gauge() : m_value(0) { }
+    Gauge(const Gauge&) = delete;
+    Gauge& operator=(const Gauge&) = delete;
+
+    void Set(const int64_t value) noexcept { m_value.store(value, std::memory_order_relaxed); }
+    void Add(const int64_t amount) noexcept { m_value.fetch_add(amount, std::memory_order_relaxed); }
+    void Sub(const int64_t amount) noexcept { m_value.fetch_sub(amount, std::memory_order_relaxed); }
+
+    int64_t GetValue() const noexcept { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> m_value;
+};
+
+//
+// Distribution of latencies, in nanoseconds.
+//
+// Buckets are laid out like an HDR histogram: each power of 2 is split into 16 linear sub-buckets,
+// so any recorded value is known to within 1/16th (6.25%), from 1ns up to a couple of hours, in 640 buckets.
+// Recording is a few relaxed atomic adds, with no locks.
+//
+class Histogram
+{
+public:
+    static constexpr uint32_t SUB_BUCKET_BITS = 4;
+    static constexpr uint32_t NUM_SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+    // Values of 2^MAX_BITS ns (about 2.4 hours) and above are counted in the last bucket.
+    static constexpr uint32_t MAX_BITS = 43;
+    static constexpr size_t NUM_BUCKETS = NUM_SUB_BUCKETS + (MAX_BITS - SUB_BUCKET_BITS) * NUM_SUB_BUCKETS;
+
+    struct Snapshot
+    {
+        uint64_t count;
+        uint64_t sum;
+        uint64_t max;
+        std::vector<uint64_t> buckets;
+
+        //
+        // The upper bound of the bucket holding the value at the quantile, e.g. 0.99 for p99, capped at the max.
+        //
+        uint64_t GetQuantile(const double quantile) const noexcept
+        {
+            if (count == 0)
+            {
+                return 0;
+            }
+
+            const uint64_t rank = std::max<uint64_t>((uint64_t)std::ceil(quantile * count), 1);
+            uint64_t seen = 0;
+            for (size_t i = 0; i < buckets.size(); i++)
+            {
+                seen += buckets[i];
+                if (seen >= rank)
+                {
+                    return std::min(GetUpperBound(i), max);
+                }
+            }
+
+            return max;
+        }
+    };
+
+    Histogram() : m_sum(0), m_max(0)
+    {
+        for (std::atomic<uint64_t>& bucket : m_buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    void Record(const uint64_t nanoseconds) noexcept
+    {
+        m_buckets[GetBucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+        uint64_t max = m_max.load(std::memory_order_relaxed);
+        while (nanoseconds > max && !m_max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) { }
+    }
+
+    template<typename Rep, typename Period>
+    void Record(const std::chrono::duration<Rep, Period>& duration) noexcept
+    {
+        const int64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        Record((uint64_t)std::max<int64_t>(nanoseconds, 0));
+    }
+
+    //
+    // Buckets are read one at a time while values are recorded, so the count and sum may be a few records apart.
+    //
+    Snapshot GetSnapshot() const
+    {
+        Snapshot snapshot({ 0, m_sum.load(std::memory_order_relaxed), m_max.load(std::memory_order_relaxed), {} });
+        snapshot.buckets.reserve(NUM_BUCKETS);
+        for (const std::atomic<uint64_t>& bucket : m_buckets)
+        {
+            snapshot.buckets.push_back(bucket.load(std::memory_order_relaxed));
+            snapshot.count += snapshot.buckets.back();
+        }
+
+        return snapshot;
+    }
+
+    static size_t GetBucketIndex(const uint64_t value) noexcept
+    {
+        if (value < NUM_SUB_BUCKETS)
+        {
+            return (size_t)value;
+        }
+
+        // Position of the leading one, by binary search.
+        uint32_t msb = 0;
+        uint64_t remaining = value;
+        for (uint32_t shift = 32; shift > 0; shift /= 2)
+        {
+            if ((remaining >> shift) != 0)
+            {
+                remaining >>= shift;
+                msb += shift;
+            }
+        }
+
+        if (msb >= MAX_BITS)
+        {
+            return NUM_BUCKETS - 1;
+        }
+
+        // The SUB_BUCKET_BITS bits after the leading one pick the sub-bucket.
+        const uint64_t subBucket = (value >> (msb - SUB_BUCKET_BITS)) - NUM_SUB_BUCKETS;
+        return (size_t)(NUM_SUB_BUCKETS + (msb - SUB_BUCKET_BITS) * NUM_SUB_BUCKETS + subBucket);
+    }
+
+    static uint64_t GetUpperBound(const size_t index) noexcept
+    {
+        if (index < NUM_SUB_BUCKETS)
+        {
+            return index;
+        }
+
+        const uint32_t shift = (uint32_t)((index - NUM_SUB_BUCKETS) / NUM_SUB_BUCKETS);
+        const uint64_t subBucket = (index - NUM_SUB_BUCKETS) % NUM_SUB_BUCKETS;
+        return ((NUM_SUB_BUCKETS + subBucket + 1) << shift) - 1;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> m_buckets;
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_max;
+};
+
+//
+// Records the time from construction to destruction in the histogram.
+//
+class LatencyTimer
+{
+public:
+    LatencyTimer(Histogram& histogram) noexcept
+        : m_histogram(histogram), m_start(std::chrono::steady_clock::now()) { }
+
+    ~LatencyTimer() { m_histogram.Record(std::chrono::steady_clock::now() - m_start); }
+
+    LatencyTimer(const LatencyTimer&) = delete;
+    LatencyTimer& operator=(const LatencyTimer&) = delete;
+
+private:
+    Histogram& m_histogram;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+//
+// Process-wide registry of named metrics.
+//
+// Metrics are created on first use and never freed, so callers look them up once and keep the reference,
+// usually in a function-local static. Labels are given in exposition form, e.g. mmr="kernels",
+// and every label set of a name is a separate metric.
+//
+namespace MetricsAPI
+{
+    //
+    // Formats a single label, e.g. FormatLabel("mmr", "kernels") returns mmr="kernels".
+    // Backslashes, quotes and newlines in the value are escaped, so any string can be used.
+    //
+    METRICS_API std::string FormatLabel(const std::string& name, const std::string& value);
+
+    METRICS_API Counter& GetCounter(const std::string& name, const std::string& help, const std::string& labels = "");
+    METRICS_API Gauge& GetGauge(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    //
+    // By convention, histogram names end in _seconds, since they're exposed in seconds.
+    //
+    METRICS_API Histogram& GetHistogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    //
+    // Every metric, in the Prometheus text exposition format.
+    // Histograms are exposed as summaries, with their count, sum, and the 0.5, 0.9, 0.99 and 0.999 quantiles.
+    //
+    METRICS_API std::string Render();
+};
\ No newline at end of file
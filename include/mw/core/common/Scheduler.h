@@ -2,16 +2,22 @@
 
 #include <mw/core/util/ThreadUtil.h>
 #include <mw/core/common/Logger.h>
+#include <mw/core/common/Metrics.h>
+#include <mw/core/common/ThreadManager.h>
 #include <tl/optional.hpp>
 
-#include <map>
 #include <mutex>
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <string>
 #include <future>
 #include <memory>
 #include <cstdint>
-#include <unordered_map>
+#include <thread>
+#include <vector>
 
 class Task
 {
@@ -42,19 +48,76 @@ private:
     tl::optional<std::chrono::milliseconds> m_intervalOpt;
 };
 
-class Scheduler
+//
+// Runs tasks on a pool of worker threads, either once or repeatedly at an interval.
+//
+// Pending runs are kept in a min-heap ordered by deadline. One idle worker, the leader, sleeps until the earliest
+// deadline, while the others sleep until there's work for them, so nothing polls and an idle scheduler uses no CPU.
+// When the leader takes a task, it hands the wait for the next deadline to another worker before running it.
+//
+// Each heap entry holds its task, so nothing is looked up when it comes due. Cancelling a task through its Handle
+// only marks it, and its entry is dropped when popped. Once cancelled entries make up most of the heap, it's rebuilt
+// without them, so short-lived timers that are almost always cancelled, like peer timeouts, can't pile up.
+//
+class Scheduler : public std::enable_shared_from_this<Scheduler>
 {
+    struct TimerState;
+
 public:
     using Ptr = std::shared_ptr<Scheduler>;
+    using Clock = std::chrono::steady_clock;
+
+    //
+    // Refers to a scheduled task. Copies refer to the same task.
+    // Dropping a handle doesn't cancel the task.
+    //
+    class Handle
+    {
+    public:
+        Handle() = default;
+
+        //
+        // Stops future runs of the task. A run that has already started isn't interrupted.
+        // Safe to call from any thread, including from the task itself, and after the scheduler is destroyed.
+        // Returns false if the task was already cancelled, or was a one-off task that already started.
+        //
+        bool Cancel()
+        {
+            if (m_pState == nullptr)
+            {
+                return false;
+            }
+
+            auto pScheduler = m_pScheduler.lock();
+            if (pScheduler == nullptr)
+            {
+                // The workers are gone, so nothing can start anymore.
+                const bool wasCancelled = m_pState->cancelled.exchange(true);
+                return !wasCancelled && !(m_pState->started && !m_pState->task.GetInterval().has_value());
+            }
+
+            return pScheduler->Cancel(*m_pState);
+        }
+
+        bool IsCancelled() const noexcept { return m_pState != nullptr && m_pState->cancelled; }
+
+    private:
+        friend class Scheduler;
+
+        Handle(const std::weak_ptr<Scheduler>& pScheduler, const std::shared_ptr<TimerState>& pState)
+            : m_pScheduler(pScheduler), m_pState(pState) { }
+
+        std::weak_ptr<Scheduler> m_pScheduler;
+        std::shared_ptr<TimerState> m_pState;
+    };
 
     static Scheduler::Ptr Create(const uint8_t numThreads)
     {
         auto pScheduler = std::shared_ptr<Scheduler>(new Scheduler());
-        pScheduler->m_scheduler = std::thread(Scheduler::MainThread, pScheduler.get());
 
         for (uint8_t i = 0; i < numThreads; i++)
         {
-            pScheduler->m_workers.push_back(std::thread(Scheduler::Worker, pScheduler.get()));
+            pScheduler->m_workers.push_back(ThreadManagerAPI::CreateThread("SCHEDULER_" + std::to_string(i), Scheduler::Worker, pScheduler.get()));
         }
 
         return pScheduler;
@@ -62,109 +125,253 @@ public:
 
     ~Scheduler()
     {
-        m_stop = true;
-        ThreadUtil::Join(m_scheduler);
+        {
+            std::unique_lock<std::mutex> lock(m_taskMutex);
+            m_stop = true;
+        }
 
+        m_leaderConditional.notify_all();
         m_conditional.notify_all();
         ThreadUtil::JoinAll(m_workers);
+
+        m_metrics.timers.Sub((int64_t)m_timers.size());
     }
 
-    uint32_t RunEvery(std::function<void()>&& task, const std::chrono::milliseconds& interval)
+    //
+    // Runs the task every interval, measured from the end of its previous run.
+    //
+    Handle RunEvery(std::function<void()>&& task, const std::chrono::milliseconds& interval)
     {
-        const uint32_t taskId = m_nextId++;
+        return Add(Task(std::move(task), interval), Clock::now() + interval);
+    }
 
+    Handle RunOnce(std::function<void()>&& task)
+    {
+        return Add(Task(std::move(task)), Clock::now());
+    }
+
+    //
+    // Runs the task once, after the delay.
+    //
+    Handle RunAfter(std::function<void()>&& task, const std::chrono::milliseconds& delay)
+    {
+        return Add(Task(std::move(task)), Clock::now() + delay);
+    }
+
+    //
+    // The number of entries in the heap, including cancelled ones that haven't been dropped yet.
+    //
+    size_t GetNumTimers() const
+    {
         std::unique_lock<std::mutex> lock(m_taskMutex);
-        m_tasksById.insert({ taskId, std::make_shared<Task>(std::move(task), interval) });
-        m_tasks.insert({ std::chrono::system_clock::now() + interval, taskId });
-        return taskId;
+        return m_timers.size();
     }
 
-    uint32_t RunOnce(std::function<void()>&& task)
+private:
+    struct TimerState
+    {
+        TimerState(Task&& task_)
+            : task(std::move(task_)), cancelled(false), started(false), queued(false) { }
+
+        Task task;
+        std::atomic_bool cancelled;
+
+        // Whether the task has started running at least once.
+        std::atomic_bool started;
+
+        // Whether the task has an entry in the heap. Guarded by m_taskMutex.
+        bool queued;
+    };
+
+    struct Timer
+    {
+        Clock::time_point deadline;
+        std::shared_ptr<TimerState> pState;
+
+        // Orders the heap so the earliest deadline is on top.
+        bool operator>(const Timer& rhs) const noexcept { return deadline > rhs.deadline; }
+    };
+
+    //
+    // Shared by every scheduler.
+    //
+    struct Metrics
     {
-        const uint32_t taskId = m_nextId++;
+        Metrics()
+            : tasksRun(MetricsAPI::GetCounter("scheduler_tasks_run_total", "Tasks run by any scheduler.")),
+            timers(MetricsAPI::GetGauge("scheduler_timers", "Entries in the schedulers' heaps, including cancelled ones.")),
+            lateness(MetricsAPI::GetHistogram("scheduler_lateness_seconds", "How long after its deadline a task started.")),
+            runTime(MetricsAPI::GetHistogram("scheduler_task_seconds", "How long a task ran.")) { }
+
+        Counter& tasksRun;
+        Gauge& timers;
+        Histogram& lateness;
+        Histogram& runTime;
+    };
+
+    Scheduler() : m_stop(false), m_hasLeader(false), m_numCancelled(0) { }
+
+    Handle Add(Task&& task, const Clock::time_point& deadline)
+    {
+        auto pState = std::make_shared<TimerState>(std::move(task));
 
         std::unique_lock<std::mutex> lock(m_taskMutex);
-        m_tasksById.insert({ taskId, std::make_shared<Task>(std::move(task)) });
-        m_tasks.insert({ std::chrono::system_clock::now(), taskId });
-        m_conditional.notify_one();
-        return taskId;
+        Schedule(deadline, pState);
+        return Handle(weak_from_this(), pState);
     }
 
-    void RemoveTask(const uint32_t taskId)
+    bool Cancel(TimerState& state)
     {
         std::unique_lock<std::mutex> lock(m_taskMutex);
-        auto iter = m_tasksById.find(taskId);
-        if (iter != m_tasksById.end())
+        if (state.cancelled.exchange(true))
         {
-            m_tasksById.erase(iter);
+            return false;
         }
-    }
 
-private:
-    Scheduler() : m_stop(false) {}
+        if (!state.queued)
+        {
+            // Either running now, in which case it won't be rescheduled, or a one-off task that already ran.
+            return state.task.GetInterval().has_value();
+        }
+
+        m_numCancelled++;
+        if (m_numCancelled >= MIN_COMPACT && m_numCancelled * 2 > m_timers.size())
+        {
+            Compact();
+        }
 
-    static void MainThread(Scheduler* pScheduler)
+        return true;
+    }
+
+    //
+    // Rebuilds the heap without the cancelled entries. Must be called while holding m_taskMutex.
+    // Only called once at least half the heap is cancelled, so the cost is spread over the cancellations.
+    //
+    void Compact()
     {
-        while (!pScheduler->m_stop)
+        for (const Timer& timer : m_timers)
         {
-            std::unique_lock<std::mutex> lock(pScheduler->m_taskMutex);
-            if (!pScheduler->m_tasks.empty() && pScheduler->m_tasks.begin()->first <= std::chrono::system_clock::now())
+            if (timer.pState->cancelled)
             {
-                pScheduler->m_conditional.notify_one();
-                continue;
+                timer.pState->queued = false;
             }
+        }
 
-            lock.unlock();
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const size_t sizeBefore = m_timers.size();
+        m_timers.erase(
+            std::remove_if(m_timers.begin(), m_timers.end(), [](const Timer& timer) { return !timer.pState->queued; }),
+            m_timers.end()
+        );
+        m_metrics.timers.Sub((int64_t)(sizeBefore - m_timers.size()));
+        std::make_heap(m_timers.begin(), m_timers.end(), std::greater<Timer>());
+        m_numCancelled = 0;
+
+        // The earliest deadline may have been cancelled, so the leader has to look again.
+        m_leaderConditional.notify_one();
+    }
+
+    //
+    // Adds a run to the heap. Must be called while holding m_taskMutex.
+    // Only a new earliest deadline needs anyone woken: the leader to shorten its wait, or a worker to become leader.
+    //
+    void Schedule(const Clock::time_point& deadline, const std::shared_ptr<TimerState>& pState)
+    {
+        const bool earliest = m_timers.empty() || deadline < m_timers.front().deadline;
+        pState->queued = true;
+        m_timers.push_back(Timer({ deadline, pState }));
+        std::push_heap(m_timers.begin(), m_timers.end(), std::greater<Timer>());
+        m_metrics.timers.Add(1);
+
+        if (earliest)
+        {
+            if (m_hasLeader)
+            {
+                m_leaderConditional.notify_one();
+            }
+            else
+            {
+                m_conditional.notify_one();
+            }
         }
     }
 
     static void Worker(Scheduler* pScheduler)
     {
+        std::unique_lock<std::mutex> lock(pScheduler->m_taskMutex);
         while (!pScheduler->m_stop)
         {
-            std::unique_lock<std::mutex> lock(pScheduler->m_taskMutex);
-            pScheduler->m_conditional.wait(lock);
-            if (pScheduler->m_stop)
+            if (pScheduler->m_timers.empty() || pScheduler->m_hasLeader)
+            {
+                pScheduler->m_conditional.wait(lock);
+                continue;
+            }
+
+            const Clock::time_point deadline = pScheduler->m_timers.front().deadline;
+            if (deadline > Clock::now())
             {
-                break;
+                pScheduler->m_hasLeader = true;
+                pScheduler->m_leaderConditional.wait_until(lock, deadline);
+                pScheduler->m_hasLeader = false;
+                continue;
             }
 
-            if (pScheduler->m_tasks.empty() || pScheduler->m_tasks.begin()->first > std::chrono::system_clock::now())
+            std::pop_heap(pScheduler->m_timers.begin(), pScheduler->m_timers.end(), std::greater<Timer>());
+            std::shared_ptr<TimerState> pState = std::move(pScheduler->m_timers.back().pState);
+            pScheduler->m_timers.pop_back();
+            pState->queued = false;
+            pScheduler->m_metrics.timers.Sub(1);
+
+            if (pState->cancelled)
             {
+                pScheduler->m_numCancelled--;
                 continue;
             }
 
-            const uint32_t taskId = pScheduler->m_tasks.begin()->second;
-            pScheduler->m_tasks.erase(pScheduler->m_tasks.begin());
+            pState->started = true;
+
+            // Someone else waits for the next deadline while this task runs.
+            if (!pScheduler->m_timers.empty())
+            {
+                pScheduler->m_conditional.notify_one();
+            }
+
             lock.unlock();
+            const Clock::time_point start = Clock::now();
+            pScheduler->m_metrics.lateness.Record(start - deadline);
+            pState->task.Execute();
+            pScheduler->m_metrics.runTime.Record(Clock::now() - start);
+            pScheduler->m_metrics.tasksRun.Add();
+            lock.lock();
 
-            auto taskIter = pScheduler->m_tasksById.find(taskId);
-            if (taskIter != pScheduler->m_tasksById.end())
+            // The task may have been cancelled while it ran.
+            auto intervalOpt = pState->task.GetInterval();
+            if (intervalOpt.has_value() && !pState->cancelled)
             {
-                taskIter->second->Execute();
-                auto intervalOpt = taskIter->second->GetInterval();
-
-                std::unique_lock<std::mutex> taskLock(pScheduler->m_taskMutex);
-                if (intervalOpt.has_value())
-                {
-                    pScheduler->m_tasks.insert({ std::chrono::system_clock::now() + intervalOpt.value(), taskId });
-                }
-                else
-                {
-                    pScheduler->m_tasksById.erase(pScheduler->m_tasksById.find(taskId));
-                }
+                pScheduler->Schedule(Clock::now() + intervalOpt.value(), pState);
             }
         }
     }
 
-    std::atomic_bool m_stop;
-    std::atomic<uint32_t> m_nextId;
-    std::thread m_scheduler;
+    // Cancelled entries are left in a heap smaller than this, since rebuilding it would cost more than skipping them.
+    static constexpr size_t MIN_COMPACT = 64;
+
+    Metrics m_metrics;
+
+    bool m_stop;
     std::vector<std::thread> m_workers;
+
+    // Wakes idle workers when there's a task to run, or no leader waiting for the next one.
     std::condition_variable m_conditional;
-    
-    std::mutex m_taskMutex;
-    std::unordered_map<uint32_t, std::shared_ptr<Task>> m_tasksById;
-    std::multimap<std::chrono::time_point<std::chrono::system_clock>, uint32_t> m_tasks;
+
+    // Wakes the leader when its deadline is no longer the earliest.
+    std::condition_variable m_leaderConditional;
+    bool m_hasLeader;
+
+    mutable std::mutex m_taskMutex;
+
+    // A min-heap of pending runs, kept with std::push_heap and std::pop_heap, so it can be compacted in place.
+    std::vector<Timer> m_timers;
+
+    // Entries in m_timers whose task was cancelled.
+    size_t m_numCancelled;
 };
\ No newline at end of file
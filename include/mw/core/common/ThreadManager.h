@@ -1,8 +1,12 @@
 #pragma once
 
 #include <mw/core/common/ImportExport.h>
+#include <tl/optional.hpp>
+
+#include <functional>
 #include <string>
 #include <thread>
+#include <utility>
 
 #ifdef MW_COMMON
 #define THREAD_MANAGER_API EXPORT
@@ -12,10 +16,17 @@
 
 namespace ThreadManagerAPI
 {
-    // Future: Implement a CreateThread method that takes the name, function, and parameters.
+    struct ThreadOptions
+    {
+        std::string name;
+
+        // The CPU to pin the thread to. Pinning is best effort, so failures are logged, but the thread still runs.
+        tl::optional<size_t> cpuOpt;
+    };
 
     //
     // Retrieves the name of the current thread.
+    // Each thread caches its own name, so this only takes a lock the first time, and after a name changes.
     //
     THREAD_MANAGER_API std::string GetCurrentThreadName();
 
@@ -28,4 +39,33 @@ namespace ThreadManagerAPI
     // Set the name of the current thread.
     //
     THREAD_MANAGER_API void SetCurrentThreadName(const std::string& threadName);
-};
+
+    //
+    // Registers the current thread's name, sets its OS thread name (truncated to 15 characters on linux),
+    // and pins it to options.cpuOpt, if given.
+    //
+    THREAD_MANAGER_API void InitializeCurrentThread(const ThreadOptions& options);
+
+    //
+    // Starts a thread that calls InitializeCurrentThread(options) before func(args...).
+    // Like std::thread, func and args are copied or moved into the thread.
+    //
+    template<typename F, typename... Args>
+    std::thread CreateThread(ThreadOptions options, F&& func, Args&&... args)
+    {
+        return std::thread(
+            [options = std::move(options)](auto&& threadFunc, auto&&... threadArgs) {
+                InitializeCurrentThread(options);
+                std::invoke(std::move(threadFunc), std::move(threadArgs)...);
+            },
+            std::forward<F>(func),
+            std::forward<Args>(args)...
+        );
+    }
+
+    template<typename F, typename... Args>
+    std::thread CreateThread(const std::string& name, F&& func, Args&&... args)
+    {
+        return CreateThread(ThreadOptions({ name, tl::nullopt }), std::forward<F>(func), std::forward<Args>(args)...);
+    }
+};
\ No newline at end of file
@@ -0,0 +1,484 @@
+#pragma once
+
+#include <mw/core/common/ImportExport.h>
+#include <mw/core/common/ThreadManager.h>
+#include <mw/core/util/ThreadUtil.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifdef MW_COMMON
+#define THREAD_POOL_API EXPORT
+#else
+#define THREAD_POOL_API IMPORT
+#endif
+
+enum class ETaskPriority : uint8_t
+{
+    HIGH = 0,
+    NORMAL = 1,
+    LOW = 2
+};
+
+//
+// A Chase-Lev work-stealing deque.
+// Only the owning thread may Push() and Pop(), which work on the bottom, so the owner runs its newest task first.
+// Any thread may Steal() from the top, taking the oldest task.
+// Neither end takes a lock: they only contend, through a compare-and-swap on top, when one task is left.
+//
+template<typename T>
+class WorkStealingDeque
+{
+    static_assert(std::is_pointer_v<T>, "WorkStealingDeque holds pointers");
+
+public:
+    WorkStealingDeque(const int64_t capacity = 256)
+        : m_top(0), m_bottom(0), m_pArray(new Array(capacity)) { }
+
+    ~WorkStealingDeque() { delete m_pArray.load(); }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    //
+    // Owner only.
+    //
+    void Push(T item)
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top = m_top.load(std::memory_order_acquire);
+        Array* pArray = m_pArray.load(std::memory_order_relaxed);
+
+        if (bottom - top > pArray->capacity - 1)
+        {
+            // A thief may still be reading the old array, so it's kept until the deque is destroyed.
+            Array* pGrown = pArray->Grow(top, bottom);
+            m_retired.emplace_back(pArray);
+            m_pArray.store(pGrown, std::memory_order_release);
+            pArray = pGrown;
+        }
+
+        pArray->Put(bottom, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    //
+    // Owner only. Returns nullptr if the deque is empty.
+    //
+    T Pop()
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        Array* pArray = m_pArray.load(std::memory_order_relaxed);
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T item = pArray->Get(bottom);
+        if (top == bottom)
+        {
+            // The last task, so race the thieves for it.
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                item = nullptr;
+            }
+
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return item;
+    }
+
+    //
+    // Any thread. Returns nullptr if the deque is empty, or another thread took the task first.
+    //
+    T Steal()
+    {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+        {
+            return nullptr;
+        }
+
+        T item = m_pArray.load(std::memory_order_acquire)->Get(top);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+
+        return item;
+    }
+
+private:
+    //
+    // A circular array, whose capacity is a power of 2.
+    //
+    struct Array
+    {
+        Array(const int64_t capacity_)
+            : capacity(capacity_), items(new std::atomic<T>[capacity_]) { }
+
+        T Get(const int64_t index) const noexcept { return items[index & (capacity - 1)].load(std::memory_order_relaxed); }
+        void Put(const int64_t index, T item) noexcept { items[index & (capacity - 1)].store(item, std::memory_order_relaxed); }
+
+        Array* Grow(const int64_t top, const int64_t bottom) const
+        {
+            Array* pGrown = new Array(capacity * 2);
+            for (int64_t i = top; i < bottom; i++)
+            {
+                pGrown->Put(i, Get(i));
+            }
+
+            return pGrown;
+        }
+
+        const int64_t capacity;
+        std::unique_ptr<std::atomic<T>[]> items;
+    };
+
+    std::atomic<int64_t> m_top;
+    std::atomic<int64_t> m_bottom;
+    std::atomic<Array*> m_pArray;
+    std::vector<std::unique_ptr<Array>> m_retired;
+};
+
+//
+// Runs short-lived tasks on a fixed set of worker threads, returning their results through futures.
+//
+// Every worker owns one WorkStealingDeque per priority. Tasks submitted from a worker, such as the chunks of a nested
+// ParallelFor, go on the bottom of its own deque without taking a lock. Tasks submitted from other threads go on a
+// shared queue. An idle worker looks for the highest priority task it can find: its own deque first, then the shared
+// queue, then the tops of the other workers' deques. Workers with nothing to do sleep until a task is submitted.
+//
+// Unlike the Scheduler, tasks can't be delayed or repeated, and shouldn't block for long, since that takes a worker
+// away from everyone sharing the pool.
+//
+class ThreadPool
+{
+public:
+    using Ptr = std::shared_ptr<ThreadPool>;
+
+    //
+    // With pin set, worker i is pinned to CPU i, wrapping around if there are more workers than CPUs.
+    //
+    static ThreadPool::Ptr Create(const size_t numThreads, const std::string& name = "POOL", const bool pin = false)
+    {
+        const size_t numCPUs = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+        auto pPool = std::shared_ptr<ThreadPool>(new ThreadPool());
+
+        for (size_t i = 0; i < numThreads; i++)
+        {
+            pPool->m_workers.push_back(std::make_unique<WorkerQueues>());
+        }
+
+        for (size_t i = 0; i < numThreads; i++)
+        {
+            ThreadManagerAPI::ThreadOptions options({ name + "_" + std::to_string(i), tl::nullopt });
+            if (pin)
+            {
+                options.cpuOpt = i % numCPUs;
+            }
+
+            pPool->m_threads.push_back(ThreadManagerAPI::CreateThread(std::move(options), ThreadPool::Worker, pPool.get(), i));
+        }
+
+        return pPool;
+    }
+
+    //
+    // Tasks already submitted are run before the workers exit.
+    //
+    ~ThreadPool()
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_parkMutex);
+            m_stop = true;
+        }
+
+        m_parkConditional.notify_all();
+        ThreadUtil::JoinAll(m_threads);
+
+        // Only a pool without workers leaves anything behind.
+        for (std::deque<Job*>& shared : m_shared)
+        {
+            for (Job* pJob : shared)
+            {
+                delete pJob;
+            }
+        }
+    }
+
+    size_t GetNumThreads() const noexcept { return m_threads.size(); }
+
+    //
+    // Queues the task, and returns a future for its result.
+    // If the task throws, the exception is rethrown by future::get().
+    //
+    template<typename F>
+    std::future<std::invoke_result_t<std::decay_t<F>>> Submit(F&& task, const ETaskPriority priority = ETaskPriority::NORMAL)
+    {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+
+        auto pTask = std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+        std::future<R> future = pTask->get_future();
+        Push(new Job([pTask] { (*pTask)(); }), priority);
+        return future;
+    }
+
+    //
+    // Calls fn(chunkBegin, chunkEnd) for consecutive chunks of [begin, end), each of at most grainSize indices,
+    // and returns once all of them have run.
+    //
+    // The calling thread works through the chunks too, so it's safe to call from inside a task on this pool.
+    // If any chunk throws, the remaining chunks still run, and the first exception is rethrown.
+    //
+    void ParallelFor(
+        const size_t begin,
+        const size_t end,
+        const size_t grainSize,
+        const std::function<void(const size_t, const size_t)>& fn,
+        const ETaskPriority priority = ETaskPriority::NORMAL)
+    {
+        if (end <= begin)
+        {
+            return;
+        }
+
+        const size_t grain = std::max<size_t>(grainSize, 1);
+        const size_t numChunks = (end - begin + grain - 1) / grain;
+        if (numChunks == 1 || m_threads.empty())
+        {
+            fn(begin, end);
+            return;
+        }
+
+        auto pLoop = std::make_shared<Loop>(begin, end, grain, numChunks, &fn);
+
+        // Helpers that start after every chunk is claimed return immediately, without touching fn.
+        const size_t numHelpers = std::min(numChunks - 1, m_threads.size());
+        for (size_t i = 0; i < numHelpers; i++)
+        {
+            Push(new Job([pLoop] { pLoop->Run(); }), priority);
+        }
+
+        pLoop->Run();
+        pLoop->Wait();
+    }
+
+private:
+    using Job = std::function<void()>;
+
+    static constexpr size_t NUM_PRIORITIES = 3;
+
+    struct WorkerQueues
+    {
+        std::array<WorkStealingDeque<Job*>, NUM_PRIORITIES> deques;
+    };
+
+    //
+    // The shared state of one ParallelFor call.
+    //
+    struct Loop
+    {
+        Loop(const size_t begin_, const size_t end_, const size_t grain_, const size_t numChunks_, const std::function<void(const size_t, const size_t)>* pFn_)
+            : begin(begin_), end(end_), grain(grain_), numChunks(numChunks_), pFn(pFn_), nextChunk(0), numDone(0) { }
+
+        void Run()
+        {
+            for (size_t chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++)
+            {
+                const size_t chunkBegin = begin + chunk * grain;
+                try
+                {
+                    (*pFn)(chunkBegin, std::min(chunkBegin + grain, end));
+                }
+                catch (...)
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    if (!pException)
+                    {
+                        pException = std::current_exception();
+                    }
+                }
+
+                if (++numDone == numChunks)
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    doneConditional.notify_all();
+                }
+            }
+        }
+
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            doneConditional.wait(lock, [this] { return numDone == numChunks; });
+
+            if (pException)
+            {
+                std::rethrow_exception(pException);
+            }
+        }
+
+        const size_t begin;
+        const size_t end;
+        const size_t grain;
+        const size_t numChunks;
+        const std::function<void(const size_t, const size_t)>* pFn;
+
+        std::atomic<size_t> nextChunk;
+        std::atomic<size_t> numDone;
+
+        std::mutex mutex;
+        std::condition_variable doneConditional;
+        std::exception_ptr pException;
+    };
+
+    ThreadPool() : m_stop(false), m_numPending(0), m_numSleeping(0), m_numShared(0) { }
+
+    //
+    // The pool and index of the worker running on this thread, if any.
+    //
+    struct CurrentWorker
+    {
+        const ThreadPool* pPool;
+        size_t index;
+    };
+
+    static CurrentWorker& GetCurrentWorker() noexcept
+    {
+        static thread_local CurrentWorker current = { nullptr, 0 };
+        return current;
+    }
+
+    void Push(Job* pJob, const ETaskPriority priority)
+    {
+        // Counted before it's queued, so a worker that sees nothing pending can't miss it.
+        m_numPending++;
+
+        const size_t p = (size_t)priority;
+        const CurrentWorker& current = GetCurrentWorker();
+        if (current.pPool == this)
+        {
+            m_workers[current.index]->deques[p].Push(pJob);
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock(m_sharedMutex);
+            m_shared[p].push_back(pJob);
+            m_numShared++;
+        }
+
+        if (m_numSleeping > 0)
+        {
+            std::unique_lock<std::mutex> lock(m_parkMutex);
+            m_parkConditional.notify_one();
+        }
+    }
+
+    Job* FindJob(const size_t index)
+    {
+        for (size_t p = 0; p < NUM_PRIORITIES; p++)
+        {
+            Job* pJob = m_workers[index]->deques[p].Pop();
+
+            if (pJob == nullptr && m_numShared > 0)
+            {
+                std::unique_lock<std::mutex> lock(m_sharedMutex);
+                if (!m_shared[p].empty())
+                {
+                    pJob = m_shared[p].front();
+                    m_shared[p].pop_front();
+                    m_numShared--;
+                }
+            }
+
+            for (size_t i = 1; pJob == nullptr && i < m_workers.size(); i++)
+            {
+                pJob = m_workers[(index + i) % m_workers.size()]->deques[p].Steal();
+            }
+
+            if (pJob != nullptr)
+            {
+                m_numPending--;
+                return pJob;
+            }
+        }
+
+        return nullptr;
+    }
+
+    static void Worker(ThreadPool* pPool, const size_t index)
+    {
+        GetCurrentWorker() = CurrentWorker({ pPool, index });
+
+        while (true)
+        {
+            std::unique_ptr<Job> pJob(pPool->FindJob(index));
+            if (pJob != nullptr)
+            {
+                (*pJob)();
+                continue;
+            }
+
+            // A task that's counted, but not yet queued or lost to a thief, just sends us around again.
+            std::unique_lock<std::mutex> lock(pPool->m_parkMutex);
+            pPool->m_numSleeping++;
+            pPool->m_parkConditional.wait(lock, [pPool] { return pPool->m_stop || pPool->m_numPending > 0; });
+            pPool->m_numSleeping--;
+
+            if (pPool->m_stop && pPool->m_numPending == 0)
+            {
+                break;
+            }
+        }
+    }
+
+    bool m_stop;
+    std::vector<std::unique_ptr<WorkerQueues>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    // Tasks queued, but not yet taken by a worker.
+    std::atomic<size_t> m_numPending;
+
+    std::mutex m_parkMutex;
+    std::condition_variable m_parkConditional;
+    std::atomic<size_t> m_numSleeping;
+
+    // Tasks submitted from outside the pool.
+    std::mutex m_sharedMutex;
+    std::array<std::deque<Job*>, NUM_PRIORITIES> m_shared;
+    std::atomic<size_t> m_numShared;
+};
+
+namespace ThreadPoolAPI
+{
+    //
+    // The pool shared by the whole process, with a worker per hardware thread.
+    // Crypto verification, MMR batches and database reads should use it, rather than starting threads of their own.
+    //
+    THREAD_POOL_API ThreadPool& GetDefaultPool();
+};
\ No newline at end of file
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <mw/core/common/ImportExport.h>
+#include <mw/core/file/FilePath.h>
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef MW_COMMON
+#define TRACER_API EXPORT
+#else
+#define TRACER_API IMPORT
+#endif
+
+//
+// Hot-path events recorded by the tracer. Ids are written to trace files, so never renumber them.
+//
+enum class ETraceEvent : uint16_t
+{
+    MMR_APPEND = 1,             // leaf index, data size
+    MMR_REWIND = 2,             // nodes before, nodes after
+    VERIFY_RANGE_PROOFS = 3,    // number of proofs
+    VERIFY_KERNEL_SIGS = 4,     // number of signatures
+    DB_GET = 5,                 // table prefix, found
+    DB_MULTI_GET = 6,           // table prefix, number of keys
+    DB_PUT = 7,                 // table prefix, number of entries
+    DB_DELETE = 8,              // table prefix, number of keys
+    DB_GROUP_WRITE = 9,         // bytes, sync
+    DB_COMMIT = 10,             // journal sequence
+    JOURNAL_COMMIT = 11,        // journal sequence, number of files written
+    BLOCK_DB_COMMIT = 12        // number of journaled files
+};
+
+enum class ETracePhase : uint8_t
+{
+    BEGIN = 0,
+    END = 1,
+    INSTANT = 2
+};
+
+//
+// One traced event. Fixed-size, so recording one is a handful of stores, and trace files are plain arrays of them.
+//
+struct TraceRecord
+{
+    // Nanoseconds on the steady clock.
+    uint64_t timestamp;
+    uint64_t payload1;
+    uint64_t payload2;
+    uint32_t threadId;
+    ETraceEvent event;
+    ETracePhase phase;
+    uint8_t reserved;
+};
+
+static_assert(sizeof(TraceRecord) == 32, "TraceRecord is written to trace files as-is");
+
+//
+// The contents of a trace file.
+//
+struct TraceDump
+{
+    // Id and name of every thread that recorded an event.
+    std::vector<std::pair<uint32_t, std::string>> threads;
+
+    // Sorted by timestamp.
+    std::vector<TraceRecord> records;
+};
+
+//
+// Records events into a ring buffer per thread, so tracing takes no locks, and never allocates after a thread's first event.
+// Each buffer keeps the most recent events, which are only copied out when Dump() is called.
+// When disabled, which is the default, each event costs one relaxed atomic load.
+//
+namespace TracerAPI
+{
+    TRACER_API void SetEnabled(const bool enabled) noexcept;
+    TRACER_API const std::atomic_bool& GetEnabledFlag() noexcept;
+
+    TRACER_API void Record(const ETraceEvent event, const ETracePhase phase, const uint64_t payload1, const uint64_t payload2) noexcept;
+
+    //
+    // Copies the events currently held by every thread's buffer.
+    // Events recorded while copying may be missed, but are never torn.
+    //
+    TRACER_API TraceDump Collect();
+
+    //
+    // Writes Collect() to a trace file, which can be read back with Load(), and summarized by the TraceDump tool.
+    //
+    TRACER_API void Dump(const FilePath& path);
+
+    TRACER_API TraceDump Load(const FilePath& path);
+
+    TRACER_API std::string GetEventName(const ETraceEvent event) noexcept;
+}
+
+class Tracer
+{
+public:
+    static bool IsEnabled() noexcept
+    {
+        static const std::atomic_bool& enabled = TracerAPI::GetEnabledFlag();
+        return enabled.load(std::memory_order_relaxed);
+    }
+};
+
+//
+// Records BEGIN on construction, and END on destruction, if tracing was enabled at the start.
+// The END record carries the same payloads, unless they're updated with SetPayload2(), e.g. to record a result.
+//
+class TraceScope
+{
+public:
+    TraceScope(const ETraceEvent event, const uint64_t payload1, const uint64_t payload2) noexcept
+        : m_enabled(Tracer::IsEnabled()), m_event(event), m_payload1(payload1), m_payload2(payload2)
+    {
+        if (m_enabled)
+        {
+            TracerAPI::Record(m_event, ETracePhase::BEGIN, m_payload1, m_payload2);
+        }
+    }
+
+    ~TraceScope()
+    {
+        if (m_enabled)
+        {
+            TracerAPI::Record(m_event, ETracePhase::END, m_payload1, m_payload2);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    void SetPayload2(const uint64_t payload2) noexcept { m_payload2 = payload2; }
+
+private:
+    bool m_enabled;
+    ETraceEvent m_event;
+    uint64_t m_payload1;
+    uint64_t m_payload2;
+};
+
+#define MW_TRACE_CONCAT_INNER(a, b) a##b
+#define MW_TRACE_CONCAT(a, b) MW_TRACE_CONCAT_INNER(a, b)
+
+//
+// Traces the rest of the enclosing scope.
+//
+#define MW_TRACE_SCOPE(event, payload1, payload2) TraceScope MW_TRACE_CONCAT(mwTraceScope, __LINE__)(ETraceEvent::event, payload1, payload2)
+
+//
+// Records a single event.
+//
+#define MW_TRACE_EVENT(event, payload1, payload2) \
+    do \
+    { \
+        if (Tracer::IsEnabled()) \
+        { \
+            TracerAPI::Record(ETraceEvent::event, ETracePhase::INSTANT, payload1, payload2); \
+        } \
+    } while (0)
\ No newline at end of file
@@ -9,10 +9,10 @@ public:
     Config(std::unordered_map<std::string, std::string>&& options)
         : m_options(std::move(options)) { }
 
-    std::string Get(const std::string& key, const std::string& default = "") const noexcept
+    std::string Get(const std::string& key, const std::string& defaultValue = "") const noexcept
     {
         auto iter = m_options.find(key);
-        return iter != m_options.end() ? iter->second : default;
+        return iter != m_options.end() ? iter->second : defaultValue;
     }
 
     void Set(const std::string& key, const std::string& value) noexcept { m_options[key] = value; }
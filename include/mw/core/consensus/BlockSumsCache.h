@@ -0,0 +1,40 @@
+#pragma once
+
+#include <caches/Cache.h>
+#include <mw/core/models/block/BlockSums.h>
+#include <mw/core/models/crypto/Hash.h>
+#include <tl/optional.hpp>
+#include <mutex>
+
+//
+// Keeps the running BlockSums of recently validated blocks, keyed by block hash.
+// This lets KernelSumValidator build on block N's totals when validating block N+1.
+//
+class BlockSumsCache
+{
+public:
+    BlockSumsCache(const size_t maxBlocks = 100) : m_blockSumsCache(maxBlocks) { }
+
+    void Add(const Hash& blockHash, const BlockSums& blockSums)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_blockSumsCache.Put(blockHash, blockSums);
+    }
+
+    tl::optional<BlockSums> Get(const Hash& blockHash) const
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if (m_blockSumsCache.Cached(blockHash))
+        {
+            return tl::make_optional(m_blockSumsCache.Get(blockHash));
+        }
+
+        return tl::nullopt;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    mutable LRUCache<Hash, BlockSums> m_blockSumsCache;
+};
\ No newline at end of file
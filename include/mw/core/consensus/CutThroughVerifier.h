@@ -3,30 +3,111 @@
 #include <mw/core/models/tx/Input.h>
 #include <mw/core/models/tx/Output.h>
 #include <mw/core/exceptions/ValidationException.h>
-#include <set>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+#include <vector>
 
 class CutThroughVerifier
 {
 public:
+    //
+    // Throws a ValidationException if any input spends an output from the same set.
+    //
     static void VerifyCutThrough(const std::vector<Input>& inputs, const std::vector<Output>& outputs)
     {
-        // TODO: Is it safe to assume duplicates were removed?
-        // Create set with output commitments
-        std::set<Commitment> commitments;
-        std::transform(
-            outputs.cbegin(), outputs.cend(),
-            std::inserter(commitments, commitments.end()),
-            [](const Output& output) { return output.GetCommitment(); }
-        );
+        if (inputs.empty() || outputs.empty())
+        {
+            return;
+        }
+
+        // Only the outputs are copied and sorted. Inputs are probed in place using binary search.
+        const std::vector<Entry> sortedOutputs = ToSortedEntries(outputs);
 
-        // Verify none of the input commitments are in the commitments set
         const bool invalid = std::any_of(
             inputs.cbegin(), inputs.cend(),
-            [&commitments](const Input& input) { return commitments.find(input.GetCommitment()) != commitments.cend(); }
+            [&sortedOutputs](const Input& input) {
+                return std::binary_search(sortedOutputs.cbegin(), sortedOutputs.cend(), Entry(input.GetCommitment(), 0));
+            }
         );
         if (invalid)
         {
             ThrowValidation(EConsensusError::CUT_THROUGH);
         }
     }
+
+    //
+    // Finds all inputs that spend an output from the same set.
+    // Returns pairs of (input index, output index), ordered by commitment.
+    // Each input and each output appears in at most one pair, so duplicate commitments are matched one-to-one.
+    //
+    static std::vector<std::pair<size_t, size_t>> FindCutThrough(const std::vector<Input>& inputs, const std::vector<Output>& outputs)
+    {
+        std::vector<std::pair<size_t, size_t>> pairs;
+        if (inputs.empty() || outputs.empty())
+        {
+            return pairs;
+        }
+
+        const std::vector<Entry> sortedInputs = ToSortedEntries(inputs);
+        const std::vector<Entry> sortedOutputs = ToSortedEntries(outputs);
+
+        // Sort-merge join of the two sorted arrays.
+        auto inputIter = sortedInputs.cbegin();
+        auto outputIter = sortedOutputs.cbegin();
+        while (inputIter != sortedInputs.cend() && outputIter != sortedOutputs.cend())
+        {
+            const int compare = inputIter->Compare(*outputIter);
+            if (compare < 0)
+            {
+                ++inputIter;
+            }
+            else if (compare > 0)
+            {
+                ++outputIter;
+            }
+            else
+            {
+                pairs.push_back({ inputIter->index, outputIter->index });
+                ++inputIter;
+                ++outputIter;
+            }
+        }
+
+        return pairs;
+    }
+
+private:
+    //
+    // Commitment bytes stored inline, along with the position of the item it was taken from.
+    //
+    struct Entry
+    {
+        Entry(const Commitment& commitment, const size_t idx) noexcept
+            : index(idx)
+        {
+            memcpy(bytes.data(), commitment.data(), bytes.size());
+        }
+
+        int Compare(const Entry& rhs) const noexcept { return memcmp(bytes.data(), rhs.bytes.data(), bytes.size()); }
+        bool operator<(const Entry& rhs) const noexcept { return Compare(rhs) < 0; }
+
+        std::array<uint8_t, Commitment::SIZE> bytes;
+        size_t index;
+    };
+
+    template<class T>
+    static std::vector<Entry> ToSortedEntries(const std::vector<T>& committed)
+    {
+        std::vector<Entry> entries;
+        entries.reserve(committed.size());
+        for (size_t i = 0; i < committed.size(); i++)
+        {
+            entries.emplace_back(committed[i].GetCommitment(), i);
+        }
+
+        std::sort(entries.begin(), entries.end());
+        return entries;
+    }
 };
\ No newline at end of file
@@ -1,10 +1,11 @@
 #pragma once
 
-#include <mw/core/exceptions/InvalidException.h>
 #include <mw/core/crypto/Crypto.h>
-//#include <Core/models/BlockSums.h>
+#include <mw/core/models/block/BlockSums.h>
 #include <mw/core/models/tx/TxBody.h>
-#include <Common/Util/FunctionalUtil.h>
+#include <mw/core/consensus/BlockSumsCache.h>
+#include <mw/core/exceptions/MissingBlockSumsException.h>
+#include <mw/core/exceptions/ValidationException.h>
 #include <mw/core/common/Logger.h>
 #include <tl/optional.hpp>
 
@@ -18,71 +19,131 @@ public:
         const BlindingFactor& kernelOffset,
         const tl::optional<BlockSums>& blockSumsOpt)
     {
-        // gather the commitments
-        auto getInputCommitments = [](Input& input) -> Commitment { return input.GetCommitment(); };
-        std::vector<Commitment> inputCommitments = FunctionalUtil::map<std::vector<Commitment>>(transactionBody.GetInputs(), getInputCommitments);
+        // gather the commitments, without copying them
+        const std::vector<Input>& inputs = transactionBody.GetInputs();
+        std::vector<const Commitment*> inputCommitments;
+        inputCommitments.reserve(inputs.size());
+        for (const Input& input : inputs)
+        {
+            inputCommitments.push_back(&input.GetCommitment());
+        }
 
-        auto getOutputCommitments = [](Output& output) -> Commitment { return output.GetCommitment(); };
-        std::vector<Commitment> outputCommitments = FunctionalUtil::map<std::vector<Commitment>>(transactionBody.GetOutputs(), getOutputCommitments);
+        const std::vector<Output>& outputs = transactionBody.GetOutputs();
+        std::vector<const Commitment*> outputCommitments;
+        outputCommitments.reserve(outputs.size());
+        for (const Output& output : outputs)
+        {
+            outputCommitments.push_back(&output.GetCommitment());
+        }
 
-        auto getKernelCommitments = [](IKernel& kernel) -> Commitment { return kernel.GetExcess(); };
-        std::vector<Commitment> kernelCommitments = FunctionalUtil::map<std::vector<Commitment>>(transactionBody.GetKernels(), getKernelCommitments);
+        const std::vector<IKernel::CPtr>& kernels = transactionBody.GetKernels();
+        std::vector<const Commitment*> kernelCommitments;
+        kernelCommitments.reserve(kernels.size());
+        for (const IKernel::CPtr& pKernel : kernels)
+        {
+            kernelCommitments.push_back(&pKernel->GetExcess());
+        }
 
         return ValidateKernelSums(inputCommitments, outputCommitments, kernelCommitments, overage, kernelOffset, blockSumsOpt);
     }
 
+    //
+    // Validates the kernel sums of a block, starting from the cached sums of the previous block.
+    // The resulting sums are cached under blockHash, so validating the next block reuses these totals.
+    // The previous block's sums must already be cached, unless previousHash is ZERO_HASH. If they aren't, e.g. after a
+    // restart or once they've been evicted, MissingBlockSumsException is thrown, since the block can't be judged without them.
+    //
+    static BlockSums ValidateKernelSums(
+        const TxBody& transactionBody,
+        const int64_t overage,
+        const BlindingFactor& totalKernelOffset,
+        const Hash& previousHash,
+        const Hash& blockHash,
+        BlockSumsCache& cache)
+    {
+        const tl::optional<BlockSums> previousSumsOpt = previousHash != ZERO_HASH ? cache.Get(previousHash) : tl::nullopt;
+        if (previousHash != ZERO_HASH && !previousSumsOpt.has_value())
+        {
+            ThrowMissingBlockSums(previousHash);
+        }
+
+        BlockSums blockSums = ValidateKernelSums(transactionBody, overage, totalKernelOffset, previousSumsOpt);
+        cache.Add(blockHash, blockSums);
+        return blockSums;
+    }
+
     static BlockSums ValidateKernelSums(
-        const std::vector<Commitment>& inputs,
-        const std::vector<Commitment>& outputs,
-        const std::vector<Commitment>& kernels,
+        const std::vector<const Commitment*>& inputs,
+        const std::vector<const Commitment*>& outputs,
+        const std::vector<const Commitment*>& kernels,
         const int64_t overage,
         const BlindingFactor& kernelOffset,
         const tl::optional<BlockSums>& blockSumsOpt)
     {
-        std::vector<Commitment> inputCommitments = inputs;
-        std::vector<Commitment> outputCommitments = outputs;
+        std::vector<const Commitment*> inputCommitments;
+        inputCommitments.reserve(inputs.size() + 1);
+        inputCommitments.insert(inputCommitments.end(), inputs.cbegin(), inputs.cend());
+
+        std::vector<const Commitment*> outputCommitments;
+        outputCommitments.reserve(outputs.size() + 2);
+        outputCommitments.insert(outputCommitments.end(), outputs.cbegin(), outputs.cend());
+
+        tl::optional<Commitment> overageCommitmentOpt = tl::nullopt;
         if (overage > 0)
         {
-            outputCommitments.push_back(Crypto::CommitTransparent(overage));
+            overageCommitmentOpt = tl::make_optional(Crypto::CommitTransparent((uint64_t)overage));
+            outputCommitments.push_back(&overageCommitmentOpt.value());
         }
         else if (overage < 0)
         {
-            inputCommitments.push_back(Crypto::CommitTransparent(0 - overage));
+            // Negated as unsigned, since -INT64_MIN doesn't fit in an int64_t.
+            overageCommitmentOpt = tl::make_optional(Crypto::CommitTransparent(0 - (uint64_t)overage));
+            inputCommitments.push_back(&overageCommitmentOpt.value());
         }
 
         if (blockSumsOpt.has_value())
         {
-            outputCommitments.push_back(blockSumsOpt.value().GetOutputSum());
+            outputCommitments.push_back(&blockSumsOpt.value().GetOutputSum());
         }
 
         // Sum all input|output|overage commitments.
         Commitment utxoSum = Crypto::AddCommitments(outputCommitments, inputCommitments);
 
         // Sum the kernel excesses accounting for the kernel offset.
-        std::vector<Commitment> kernelCommitments = kernels;
+        std::vector<const Commitment*> kernelCommitments;
+        kernelCommitments.reserve(kernels.size() + 1);
+        kernelCommitments.insert(kernelCommitments.end(), kernels.cbegin(), kernels.cend());
         if (blockSumsOpt.has_value())
         {
-            kernelCommitments.push_back(blockSumsOpt.value().GetKernelSum());
+            kernelCommitments.push_back(&blockSumsOpt.value().GetKernelSum());
         }
 
-        Commitment kernelSum = Crypto::AddCommitments(kernelCommitments, std::vector<Commitment>());
-        Commitment kernelSumPlusOffset = AddKernelOffset(kernelSum, kernelOffset);
+        Commitment kernelSum = Crypto::AddCommitments(kernelCommitments, std::vector<const Commitment*>());
+        const Commitment kernelSumPlusOffset = AddKernelOffset(kernelSum, kernelOffset);
+
+        if (utxoSum != kernelSumPlusOffset)
+        {
+            LOG_ERROR_F("UTXO sum {} does not match kernel sum plus offset {}", utxoSum, kernelSumPlusOffset);
+            ThrowValidation(EConsensusError::KERNEL_SUMS);
+        }
 
-        return BlockSums(utxoSum, kernelSum);
+        return BlockSums(std::move(utxoSum), std::move(kernelSum));
     }
 
 private:
     static Commitment AddKernelOffset(const Commitment& kernelSum, const BlindingFactor& totalKernelOffset)
     {
-        // Add the commitments along with the commit to zero built from the offset
-        std::vector<Commitment> commitments;
-        commitments.push_back(kernelSum);
-
-        if (totalKernelOffset.GetBigInt() != BigInt<32>::ValueOf(0))
+        if (totalKernelOffset.GetBigInt() == BigInt<32>::ValueOf(0))
         {
-            commitments.push_back(Crypto::CommitBlinded((uint64_t)0, totalKernelOffset));
+            return kernelSum;
         }
 
-        return Crypto::AddCommitments(commitments, std::vector<Commitment>());
+        // Add the commitments along with the commit to zero built from the offset
+        const Commitment offsetCommitment = Crypto::CommitBlinded((uint64_t)0, totalKernelOffset);
+
+        return Crypto::AddCommitments(
+            std::vector<const Commitment*>({ &kernelSum, &offsetCommitment }),
+            std::vector<const Commitment*>()
+        );
     }
 };
\ No newline at end of file
@@ -95,6 +95,15 @@ public:
         const std::vector<Commitment>& negative
     );
 
+    //
+    // Adds the homomorphic pedersen commitments together without copying them.
+    // Each commitment is parsed exactly once. Zero commitments are skipped.
+    //
+    static Commitment AddCommitments(
+        const std::vector<const Commitment*>& positive,
+        const std::vector<const Commitment*>& negative
+    );
+
     //
     // Takes a vector of blinding factors and calculates an additional blinding value that adds to zero.
     //
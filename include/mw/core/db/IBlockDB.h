@@ -3,9 +3,44 @@
 #include <mw/core/models/block/IHeader.h>
 #include <mw/core/models/block/IBlock.h>
 #include <mw/core/models/tx/UTXO.h>
+#include <mw/core/models/tx/UTXOInfo.h>
 #include <mw/core/traits/Batchable.h>
+#include <mw/core/traits/Journaled.h>
 #include <mw/core/common/Lock.h>
+#include <mw/core/config/Config.h>
 #include <mw/core/file/FilePath.h>
+#include <future>
+
+//
+// A read-only view of the block database, as of the last commit before it was taken.
+// Reads never wait on a writer, and don't see anything written after the snapshot was taken.
+//
+class IBlockSnapshot
+{
+public:
+	using CPtr = std::shared_ptr<const IBlockSnapshot>;
+
+	virtual ~IBlockSnapshot() = default;
+
+	virtual IHeader::CPtr GetHeaderByHash(const Hash& hash) const noexcept = 0;
+	virtual std::vector<IHeader::CPtr> GetHeadersByHash(const std::vector<Hash>& hashes) const noexcept = 0;
+
+	virtual IBlock::CPtr GetBlockByHash(const Hash& hash) const noexcept = 0;
+	virtual IBlock::CPtr GetBlockByHeight(const uint64_t height) const noexcept = 0;
+
+	//
+	// Number of blocks in the main chain, including the genesis block.
+	//
+	virtual uint64_t GetNumBlocks() const noexcept = 0;
+
+	virtual std::unordered_map<Commitment, UTXO::CPtr> GetUTXOs(
+		const std::vector<Commitment>& commitments
+	) const noexcept = 0;
+
+	virtual std::unordered_map<Commitment, UTXOInfo::CPtr> GetUTXOInfos(
+		const std::vector<Commitment>& commitments
+	) const noexcept = 0;
+};
 
 // TODO: GetHeaderByHeight, GetHeaderByHeightRange, GetBlockByHeightRange, GetBlockByCommitment(if indexed)
 class IBlockDB : public Traits::IBatchable
@@ -21,9 +56,11 @@ public:
 
 	//
 	// Save Headers
+	// Outside of a batch, headers are written by a background group commit, but are readable immediately.
+	// The returned future is satisfied once they are durable.
 	//
-	virtual void AddHeader(const IHeader::CPtr& pHeader) = 0;
-	virtual void AddHeaders(const std::vector<IHeader::CPtr>& headers) = 0;
+	virtual std::shared_future<void> AddHeader(const IHeader::CPtr& pHeader) = 0;
+	virtual std::shared_future<void> AddHeaders(const std::vector<IHeader::CPtr>& headers) = 0;
 
 	//
 	// Retrieve Blocks
@@ -33,32 +70,55 @@ public:
 
 	//
 	// Save Blocks
+	// Like headers, blocks are readable immediately, and the returned future is satisfied once durable.
 	//
-	virtual void AddBlock(const IBlock::CPtr& pBlock) = 0;
+	virtual std::shared_future<void> AddBlock(const IBlock::CPtr& pBlock) = 0;
 
 	//
-	// Removes all blocks before the given height.
+	// Removes all main chain blocks before the given height.
 	// This is most useful when pruning/compacting the chain.
+	// Blocks are deleted and compacted by a rate-limited background job, so this returns immediately.
+	// The removal is not part of the current batch, so it isn't undone by a rollback.
 	//
 	virtual void RemoveOldBlocks(const uint64_t height) = 0;
 
+	//
+	// Makes the header the main chain block at its height, so GetBlockByHeight finds it.
+	// Any main chain blocks at or above its height are replaced, so this also handles reorgs.
+	// DatabaseException thrown if the header's height is past the end of the main chain.
+	//
+	virtual void AddToMainChain(const IHeader::CPtr& pHeader) = 0;
+
+	//
+	// Removes the main chain blocks at and above nextHeight.
+	//
+	virtual void RewindMainChain(const uint64_t nextHeight) = 0;
+
 	//
 	// Retrieve UTXOs for the given commitments.
-	// If there are multiple UTXOs for a commitment, the most recent will be returned.
+	// Commitments are unique within the UTXO set, so there is at most one UTXO per commitment.
 	//
 	virtual std::unordered_map<Commitment, UTXO::CPtr> GetUTXOs(
 		const std::vector<Commitment>& commitments
 	) const noexcept = 0;
 
 	//
-	// Add the UTXOs
+	// Retrieve the height, leaf index and features of the UTXOs for the given commitments, without their range proofs.
+	// Cheaper than GetUTXOs, so prefer it for existence and maturity checks.
+	//
+	virtual std::unordered_map<Commitment, UTXOInfo::CPtr> GetUTXOInfos(
+		const std::vector<Commitment>& commitments
+	) const noexcept = 0;
+
+	//
+	// Add the UTXOs.
+	// A UTXO added for a commitment that is already unspent replaces it.
 	//
 	virtual void AddUTXOs(const std::vector<UTXO::CPtr>& utxos) = 0;
 
 	//
 	// Removes the UTXOs for the given commitments.
-	// If there are multiple UTXOs for a commitment, the most recent will be removed.
-	// DatabaseException thrown if no UTXOs are found fo a commitment.
+	// DatabaseException thrown if no UTXO is found for a commitment.
 	//
 	virtual void RemoveUTXOs(const std::vector<Commitment>& commitment) = 0;
 
@@ -68,11 +128,42 @@ public:
 	//
 	virtual void RemoveAllUTXOs() = 0;
 
+	//
+	// Reopens the database with the "db.*" options in the config, e.g. to switch from the sync profile to the steady profile once initial sync completes.
+	// Must be called while holding the write lock, outside of a batch.
+	// DatabaseException thrown, and the old options kept, if snapshots are still open or the new options can't be applied.
+	// If the database can't even be opened again with the old options, it stays closed until a Reconfigure succeeds.
+	// Until then, writes throw, and the noexcept reads log an error and return nothing, as if nothing was found.
+	//
+	virtual void Reconfigure(const Config& config) = 0;
+
+	//
+	// Takes a snapshot of the committed state, for readers that shouldn't wait behind a long write batch.
+	// Safe to call without holding the lock, even while another thread is writing (see Locked::Snapshot()).
+	// MMR snapshots are taken separately, so they may be from a different commit than this one.
+	//
+	virtual IBlockSnapshot::CPtr CreateSnapshot() const = 0;
+
+	//
+	// Commits the batch and the files (e.g. MMRs) through the commit journal, so a crash can't leave them out of step.
+	// The files must be loaded after the database is opened, since opening it replays an interrupted commit to them.
+	// Writers that committed through here don't commit again when released.
+	//
+	virtual void CommitWith(const std::vector<Traits::IJournaled*>& files) = 0;
 
 };
 
 class BlockDBFactory
 {
 public:
-	static Locked<IBlockDB> Open(const Context::CPtr& pContext, const FilePath& chainPath);
+	//
+	// Opens the block database, fronted by a UTXO cache.
+	// Reads the database options (see DBOptions) and "db.utxo_cache_mb" (default: 128) from the config.
+	// A commit interrupted by a crash is recovered here, using the journal in chainPath.
+	//
+	static Locked<IBlockDB> Open(
+		const Context::CPtr& pContext,
+		const FilePath& chainPath,
+		const Config& config = Config({})
+	);
 };
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <mw/core/exceptions/GrinException.h>
+#include <mw/core/util/StringUtil.h>
+
+#define ThrowMissingBlockSums(hash) throw MissingBlockSumsException(hash, __FUNCTION__)
+
+//
+// Thrown when the running sums of a block weren't available, so a block building on it couldn't be validated.
+// Unlike a ValidationException, it says nothing about whether the block is valid.
+//
+class MissingBlockSumsException : public GrinException
+{
+public:
+    template<class T>
+    MissingBlockSumsException(const T& blockHash, const std::string& function)
+        : GrinException("MissingBlockSumsException", StringUtil::Format("Block sums not available for {}", blockHash), function)
+    {
+
+    }
+};
\ No newline at end of file
@@ -4,20 +4,124 @@
 #include <mw/core/file/FilePath.h>
 #include <mw/core/file/MemMap.h>
 #include <mw/core/common/Logger.h>
-#include <mw/core/traits/Batchable.h>
+#include <mw/core/traits/Journaled.h>
 
-class AppendOnlyFile : public Traits::IBatchable
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+class AppendOnlyFile : public Traits::IJournaled
 {
 public:
     using Ptr = std::shared_ptr<AppendOnlyFile>;
 
-    AppendOnlyFile(const File& file, const size_t fileSize) noexcept
+    //
+    // A mapping of the file as it was when mapped. It's shared by the writer and its snapshots.
+    //
+    // Truncating the file would make reads past the new end fault, so before the writer truncates, it copies the bytes
+    // being cut off out of every mapping still in use. Reads take a shared lock only while copying bytes out, so the
+    // writer never waits on a snapshot for longer than one read.
+    //
+    class Mapping
+    {
+    public:
+        Mapping(const File& file) : m_map(file), m_mappedEnd(0)
+        {
+            m_map.Map();
+            m_mappedEnd = m_map.size();
+        }
+
+        //
+        // Writer only. Copies the mapped bytes at and after size, so the file can be truncated to size.
+        //
+        void Preserve(const uint64_t size)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            if (size >= m_mappedEnd)
+            {
+                return;
+            }
+
+            m_tail.insert(m_tail.begin(), m_map.data() + size, m_map.data() + m_mappedEnd);
+            m_mappedEnd = size;
+        }
+
+        std::vector<uint8_t> Read(const uint64_t position, const uint64_t numBytes) const
+        {
+            std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+            std::vector<uint8_t> bytes;
+            bytes.reserve(numBytes);
+            if (position < m_mappedEnd)
+            {
+                const uint64_t numMapped = std::min(numBytes, m_mappedEnd - position);
+                bytes.insert(bytes.end(), m_map.data() + position, m_map.data() + position + numMapped);
+            }
+
+            if (position + numBytes > m_mappedEnd)
+            {
+                const uint64_t tailBegin = std::max(position, m_mappedEnd) - m_mappedEnd;
+                const uint64_t tailEnd = position + numBytes - m_mappedEnd;
+                bytes.insert(bytes.end(), m_tail.begin() + tailBegin, m_tail.begin() + tailEnd);
+            }
+
+            return bytes;
+        }
+
+        //
+        // Writer only, since only the writer truncates.
+        //
+        const uint8_t* Data(const uint64_t position) const noexcept
+        {
+            assert(position < m_mappedEnd);
+            return m_map.data() + position;
+        }
+
+    private:
+        MemMap m_map;
+
+        mutable std::shared_mutex m_mutex;
+        uint64_t m_mappedEnd;
+        std::vector<uint8_t> m_tail;
+    };
+
+    //
+    // A read-only view of the committed bytes, as of when it was taken.
+    // Holds its own mapping, so it stays valid while the file is appended to, rewound and committed, and can be read from any thread.
+    //
+    class Snapshot
+    {
+    public:
+        Snapshot(const std::shared_ptr<const Mapping>& pMapping, const uint64_t size)
+            : m_pMapping(pMapping), m_size(size) { }
+
+        uint64_t GetSize() const noexcept { return m_size; }
+
+        std::vector<uint8_t> Read(const uint64_t position, const uint64_t numBytes) const
+        {
+            if ((position + numBytes) > m_size)
+            {
+                ThrowFile("Tried to read past end of snapshot");
+            }
+
+            return m_pMapping->Read(position, numBytes);
+        }
+
+    private:
+        std::shared_ptr<const Mapping> m_pMapping;
+        uint64_t m_size;
+    };
+
+    AppendOnlyFile(const File& file, const size_t fileSize)
         : m_file(file),
-        m_mmap(file.GetPath()),
+        m_pMapping(std::make_shared<Mapping>(file)),
         m_fileSize(fileSize),
         m_bufferIndex(fileSize)
     {
-
+        m_mappings.push_back(m_pMapping);
     }
     virtual ~AppendOnlyFile() = default;
 
@@ -26,9 +130,16 @@ public:
         File file(path);
         file.Create();
 
-        auto pAppendOnlyFile = std::make_shared<AppendOnlyFile>(file, file.GetSize());
-        pAppendOnlyFile->m_mmap.Map();
-        return pAppendOnlyFile;
+        return std::make_shared<AppendOnlyFile>(file, file.GetSize());
+    }
+
+    //
+    // Can be called from any thread, even while another thread is writing.
+    //
+    Snapshot GetSnapshot() const
+    {
+        std::unique_lock<std::mutex> lock(m_snapshotMutex);
+        return Snapshot(m_pMapping, m_fileSize);
     }
 
     void Commit() final
@@ -43,14 +154,44 @@ public:
             ThrowFile_F("Buffer index is past the end of {}", m_file);
         }
 
-        m_mmap.Unmap();
+        // Rewound bytes are truncated first, since the buffer is appended to the end of the file.
+        if (m_bufferIndex < m_fileSize)
+        {
+            TruncateMapped(m_bufferIndex);
+        }
 
         m_file.Write(m_bufferIndex, m_buffer, true);
+        m_buffer.clear();
+
+        // Snapshots may still be reading the old mapping, so the file is mapped again rather than remapped in place.
+        auto pMapping = std::make_shared<Mapping>(m_file);
+
+        std::unique_lock<std::mutex> lock(m_snapshotMutex);
+        m_pMapping = pMapping;
         m_fileSize = m_file.GetSize();
         m_bufferIndex = m_fileSize;
-        m_buffer.clear();
 
-        m_mmap.Map();
+        m_mappings.erase(
+            std::remove_if(m_mappings.begin(), m_mappings.end(), [](const std::weak_ptr<Mapping>& pWeak) { return pWeak.expired(); }),
+            m_mappings.end()
+        );
+        m_mappings.push_back(m_pMapping);
+    }
+
+    std::vector<FileWrites> GetPendingWrites() const final
+    {
+        if (m_fileSize == m_bufferIndex && m_buffer.empty())
+        {
+            return {};
+        }
+
+        FileWrites fileWrites({ m_file.GetPath(), tl::make_optional(m_bufferIndex), {} });
+        if (!m_buffer.empty())
+        {
+            fileWrites.writes.push_back({ m_bufferIndex, m_buffer });
+        }
+
+        return { std::move(fileWrites) };
     }
 
     void Rollback() noexcept final
@@ -66,8 +207,6 @@ public:
 
     void Rewind(const uint64_t nextPosition)
     {
-        assert(m_fileSize == m_bufferIndex);
-
         if (nextPosition > (m_bufferIndex + m_buffer.size()))
         {
             ThrowFile_F("Tried to rewind past end of {}", m_file);
@@ -99,7 +238,7 @@ public:
         if (position < m_bufferIndex)
         {
             // TODO: Read from mapped and then from buffer, if necessary
-            return m_mmap.Read(position, numBytes);
+            return m_pMapping->Read(position, numBytes);
         }
         else
         {
@@ -109,11 +248,59 @@ public:
         }
     }
 
+    //
+    // Returns a pointer to the bytes at the position without copying them.
+    // The pointer is only valid until the next Commit(), Rollback(), Append() or Rewind().
+    //
+    const uint8_t* Data(const uint64_t position, const uint64_t numBytes) const
+    {
+        if ((position + numBytes) > (m_bufferIndex + m_buffer.size()))
+        {
+            ThrowFile_F("Tried to read past end of {}", m_file);
+        }
+
+        if (position + numBytes <= m_bufferIndex)
+        {
+            return m_pMapping->Data(position);
+        }
+        else if (position >= m_bufferIndex)
+        {
+            return m_buffer.data() + position - m_bufferIndex;
+        }
+
+        ThrowFile_F("Tried to read across the end of the mapped region of {}", m_file);
+    }
+
 private:
+    //
+    // Reading a mapping past the end of the file faults, so the bytes being truncated are first copied out of every
+    // mapping that's still in use, including the current one, which snapshots may be taken from until the commit ends.
+    //
+    void TruncateMapped(const uint64_t size)
+    {
+        for (const std::weak_ptr<Mapping>& pWeak : m_mappings)
+        {
+            std::shared_ptr<Mapping> pMapping = pWeak.lock();
+            if (pMapping != nullptr)
+            {
+                pMapping->Preserve(size);
+            }
+        }
+
+        m_file.Truncate(size);
+    }
+
     File m_file;
-    MemMap m_mmap;
+
+    // The mapping and size of the committed bytes, which are swapped under m_snapshotMutex.
+    // Only the writer changes them, so it can read them without locking.
+    mutable std::mutex m_snapshotMutex;
+    std::shared_ptr<Mapping> m_pMapping;
     uint64_t m_fileSize;
 
+    // The mappings that may still be in use, so they can be preserved before truncating. Expired ones are dropped on commit.
+    std::vector<std::weak_ptr<Mapping>> m_mappings;
+
     uint64_t m_bufferIndex;
     std::vector<uint8_t> m_buffer;
 };
\ No newline at end of file
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <mw/core/file/MemMap.h>
-#include <mw/core/traits/Batchable.h>
+#include <mw/core/traits/Journaled.h>
 #include <mw/core/util/BitUtil.h>
 #include <fstream>
 #include <functional>
@@ -12,7 +12,7 @@
 
 // NOTE: Uses bit positions numbered from 0-7, starting at the left.
 // For example, 65 (01000001) has bit positions 1 and 7 set.
-class BitmapFile : public Traits::IBatchable
+class BitmapFile : public Traits::IJournaled
 {
 public:
     virtual ~BitmapFile() = default;
@@ -36,6 +36,31 @@ public:
         }
     }
 
+    //
+    // Runs of consecutive modified bytes are merged into one write.
+    //
+    std::vector<FileWrites> GetPendingWrites() const final
+    {
+        if (m_modifiedBytes.empty())
+        {
+            return {};
+        }
+
+        FileWrites fileWrites({ m_file.GetPath(), tl::nullopt, {} });
+        for (const auto& modified : m_modifiedBytes)
+        {
+            auto& writes = fileWrites.writes;
+            if (writes.empty() || writes.back().first + writes.back().second.size() != modified.first)
+            {
+                writes.push_back({ modified.first, {} });
+            }
+
+            writes.back().second.push_back(modified.second);
+        }
+
+        return { std::move(fileWrites) };
+    }
+
     void Rollback() noexcept final
     {
         m_modifiedBytes.clear();
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <mw/core/file/File.h>
+#include <mw/core/file/FilePath.h>
+#include <mw/core/file/FileWrites.h>
+#include <mw/core/common/Logger.h>
+#include <mw/core/common/Tracer.h>
+#include <mw/core/exceptions/FileException.h>
+#include <mw/core/serialization/Deserializer.h>
+#include <mw/core/serialization/Serializer.h>
+#include <mw/core/traits/Journaled.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+//
+// Keeps a set of files consistent with a database across crashes, by committing them together.
+//
+// Each commit is given the next sequence number, and goes through these steps:
+//   1. The pending writes of every file are written to the journal, tagged with the sequence.
+//   2. The database commits its batch, together with the sequence.
+//   3. The files are committed, and synced.
+//   4. The journal is cleared.
+//
+// On startup, Open() compares the journal with the sequence the database last committed.
+// If they match, the crash came after step 2, so the files are brought up to date by replaying the journal.
+// Otherwise the database never saw the commit, and the files were never touched, so the journal is discarded.
+// Either way, recovery only costs as much as the last commit.
+//
+// Open() must be called before any of the journaled files are loaded, since replaying changes them underneath.
+//
+class CommitJournal
+{
+public:
+    using Ptr = std::shared_ptr<CommitJournal>;
+
+    //
+    // Opens the journal, and recovers from an interrupted commit.
+    // committedSequence is the last sequence the database committed, or 0 if it never has.
+    // When sync is false, nothing is synced, which survives a process crash, but not a power loss.
+    //
+    static CommitJournal::Ptr Open(const FilePath& path, const uint64_t committedSequence, const bool sync)
+    {
+        File file(path);
+        file.Create();
+
+        auto pJournal = std::shared_ptr<CommitJournal>(new CommitJournal(file, committedSequence, sync));
+        pJournal->Recover();
+        return pJournal;
+    }
+
+    //
+    // The sequence of the last commit.
+    //
+    uint64_t GetSequence() const noexcept { return m_sequence; }
+
+    void SetSync(const bool sync) noexcept { m_sync = sync; }
+
+    //
+    // Commits the database and the files together.
+    // commitDB must commit the database's batch along with the sequence it's given, and return once the batch is durable.
+    // Files are committed in order, after the database. If nothing is written to the files, nothing is journaled.
+    //
+    void Commit(const std::vector<Traits::IJournaled*>& files, const std::function<void(const uint64_t)>& commitDB)
+    {
+        std::vector<FileWrites> writes;
+        for (const Traits::IJournaled* pFile : files)
+        {
+            for (FileWrites& fileWrites : pFile->GetPendingWrites())
+            {
+                writes.push_back(std::move(fileWrites));
+            }
+        }
+
+        if (writes.empty())
+        {
+            commitDB(m_sequence);
+            return;
+        }
+
+        const uint64_t sequence = m_sequence + 1;
+        MW_TRACE_SCOPE(JOURNAL_COMMIT, sequence, writes.size());
+        WriteRecord(sequence, writes);
+
+        commitDB(sequence);
+        m_sequence = sequence;
+
+        // If a file fails to commit, the journal is left in place, so the files are repaired on the next startup.
+        for (Traits::IJournaled* pFile : files)
+        {
+            pFile->Commit();
+            pFile->SetDirty(false);
+        }
+
+        if (m_sync)
+        {
+            for (const FileWrites& fileWrites : writes)
+            {
+                File(fileWrites.path).Sync();
+            }
+        }
+
+        // Once the files are synced, the record is never needed again, so clearing it doesn't need to be synced.
+        m_file.Truncate(0);
+    }
+
+private:
+    CommitJournal(const File& file, const uint64_t committedSequence, const bool sync)
+        : m_file(file), m_sequence(committedSequence), m_sync(sync) { }
+
+    struct Record
+    {
+        uint64_t sequence;
+        std::vector<FileWrites> writes;
+    };
+
+    void Recover()
+    {
+        const std::vector<uint8_t> bytes = m_file.ReadBytes();
+        if (bytes.empty())
+        {
+            return;
+        }
+
+        tl::optional<Record> recordOpt = ReadRecord(bytes);
+        if (!recordOpt.has_value())
+        {
+            // The crash came while the record was being written, before the database or files were touched.
+            LOG_WARNING_F("Discarding incomplete commit journal {}", m_file);
+        }
+        else if (recordOpt.value().sequence == m_sequence)
+        {
+            LOG_WARNING_F("Replaying commit {} to {} files", m_sequence, recordOpt.value().writes.size());
+            for (const FileWrites& fileWrites : recordOpt.value().writes)
+            {
+                fileWrites.Apply();
+                if (m_sync)
+                {
+                    File(fileWrites.path).Sync();
+                }
+            }
+        }
+        else
+        {
+            LOG_WARNING_F("Discarding commit {}, since the database only committed {}", recordOpt.value().sequence, m_sequence);
+        }
+
+        m_file.Truncate(0);
+    }
+
+    //
+    // The record is the sequence and the writes, followed by a checksum, so a partially written record is detected.
+    // Paths are stored relative to the journal's directory.
+    //
+    void WriteRecord(const uint64_t sequence, const std::vector<FileWrites>& writes)
+    {
+        const fs::path dir = m_file.GetPath().GetParent().ToPath();
+
+        Serializer serializer;
+        serializer.Append<uint32_t>(MAGIC);
+        serializer.Append<uint64_t>(sequence);
+        serializer.Append<uint32_t>((uint32_t)writes.size());
+        for (const FileWrites& fileWrites : writes)
+        {
+            serializer.Append(fileWrites.path.ToPath().lexically_relative(dir).u8string());
+            serializer.Append<uint8_t>(fileWrites.truncateOpt.has_value() ? 1 : 0);
+            serializer.Append<uint64_t>(fileWrites.truncateOpt.value_or(0));
+            serializer.Append<uint32_t>((uint32_t)fileWrites.writes.size());
+            for (const auto& write : fileWrites.writes)
+            {
+                serializer.Append<uint64_t>(write.first);
+                serializer.Append<uint64_t>(write.second.size());
+                serializer.Append(write.second);
+            }
+        }
+
+        serializer.Append<uint32_t>(CRC32(serializer.data(), serializer.size()));
+
+        m_file.Truncate(0);
+        m_file.Write(serializer.vec());
+        if (m_sync)
+        {
+            m_file.Sync();
+        }
+    }
+
+    tl::optional<Record> ReadRecord(const std::vector<uint8_t>& bytes) const
+    {
+        if (bytes.size() < sizeof(uint32_t))
+        {
+            return tl::nullopt;
+        }
+
+        const size_t length = bytes.size() - sizeof(uint32_t);
+        Deserializer checksumDeserializer(std::vector<uint8_t>(bytes.cbegin() + length, bytes.cend()));
+        if (checksumDeserializer.Read<uint32_t>() != CRC32(bytes.data(), length))
+        {
+            return tl::nullopt;
+        }
+
+        const fs::path dir = m_file.GetPath().GetParent().ToPath();
+
+        Deserializer deserializer(std::vector<uint8_t>(bytes.cbegin(), bytes.cbegin() + length));
+        if (deserializer.Read<uint32_t>() != MAGIC)
+        {
+            ThrowFile_F("{} is not a commit journal", m_file);
+        }
+
+        Record record;
+        record.sequence = deserializer.Read<uint64_t>();
+
+        const uint32_t numFiles = deserializer.Read<uint32_t>();
+        for (uint32_t i = 0; i < numFiles; i++)
+        {
+            FileWrites fileWrites({ FilePath(dir / fs::u8path(deserializer.ReadVarStr())), tl::nullopt, {} });
+
+            const bool truncate = deserializer.Read<uint8_t>() != 0;
+            const uint64_t truncateSize = deserializer.Read<uint64_t>();
+            if (truncate)
+            {
+                fileWrites.truncateOpt = truncateSize;
+            }
+
+            const uint32_t numWrites = deserializer.Read<uint32_t>();
+            for (uint32_t j = 0; j < numWrites; j++)
+            {
+                const uint64_t position = deserializer.Read<uint64_t>();
+                const uint64_t size = deserializer.Read<uint64_t>();
+                fileWrites.writes.push_back({ position, deserializer.ReadVector(size) });
+            }
+
+            record.writes.push_back(std::move(fileWrites));
+        }
+
+        return tl::make_optional(std::move(record));
+    }
+
+    static uint32_t CRC32(const uint8_t* pData, const size_t length) noexcept
+    {
+        static const std::array<uint32_t, 256> table = [] {
+            std::array<uint32_t, 256> t;
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++)
+                {
+                    c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+                }
+
+                t[i] = c;
+            }
+
+            return t;
+        }();
+
+        uint32_t crc = 0xFFFFFFFF;
+        for (size_t i = 0; i < length; i++)
+        {
+            crc = table[(crc ^ pData[i]) & 0xFF] ^ (crc >> 8);
+        }
+
+        return crc ^ 0xFFFFFFFF;
+    }
+
+    static constexpr uint32_t MAGIC = 0x4d574a31; // "MWJ1"
+
+    File m_file;
+    uint64_t m_sequence;
+    bool m_sync;
+};
\ No newline at end of file
@@ -24,6 +24,10 @@ public:
         const bool truncate
     );
     void WriteBytes(const std::map<uint64_t, uint8_t>& bytes);
+
+    // Flushes the file's contents to disk, so they survive a power loss.
+    void Sync() const;
+
     size_t GetSize() const;
 
     const FilePath& GetPath() const noexcept { return m_path; }
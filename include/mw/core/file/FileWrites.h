@@ -0,0 +1,60 @@
+#pragma once
+
+#include <mw/core/file/File.h>
+#include <mw/core/file/FilePath.h>
+#include <mw/core/exceptions/FileException.h>
+#include <tl/optional.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+//
+// The changes a commit will make to a file: an optional truncation, followed by writes at fixed positions.
+// Applying them again gives the same result, so they can be replayed from a CommitJournal after a crash.
+//
+struct FileWrites
+{
+    FilePath path;
+
+    // The size the file is truncated to before writing.
+    tl::optional<uint64_t> truncateOpt;
+
+    // Position and bytes of each write, applied in order.
+    std::vector<std::pair<uint64_t, std::vector<uint8_t>>> writes;
+
+    bool IsEmpty() const noexcept { return !truncateOpt.has_value() && writes.empty(); }
+
+    void Apply() const
+    {
+        File file(path);
+        file.Create();
+
+        if (truncateOpt.has_value())
+        {
+            file.Truncate(truncateOpt.value());
+        }
+
+        if (!writes.empty())
+        {
+            std::fstream stream(path.ToPath(), std::ios::binary | std::ios::in | std::ios::out);
+            if (!stream.is_open())
+            {
+                ThrowFile_F("Failed to write to file: {}", path);
+            }
+
+            for (const auto& write : writes)
+            {
+                stream.seekp(write.first);
+                stream.write((const char*)write.second.data(), write.second.size());
+            }
+
+            stream.close();
+            if (stream.fail())
+            {
+                ThrowFile_F("Failed to write to file: {}", path);
+            }
+        }
+    }
+};
\ No newline at end of file
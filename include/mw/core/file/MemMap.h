@@ -55,6 +55,12 @@ public:
         return *((uint8_t*)(m_mmap.cbegin() + position));
     }
 
+    const uint8_t* data() const noexcept
+    {
+        assert(m_mapped);
+        return (const uint8_t*)m_mmap.data();
+    }
+
     bool empty() const noexcept
     {
         assert(m_mapped);
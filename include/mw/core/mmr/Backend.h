@@ -5,7 +5,7 @@
 // file LICENSE or http://www.opensource.org/licenses/mit-license.php.
 
 #include <mw/core/models/crypto/Hash.h>
-#include <mw/core/traits/Batchable.h>
+#include <mw/core/traits/Journaled.h>
 #include <mw/core/mmr/Index.h>
 #include <mw/core/mmr/LeafIndex.h>
 #include <mw/core/mmr/Leaf.h>
@@ -13,7 +13,7 @@
 
 namespace mmr
 {
-class IBackend : public Traits::IBatchable
+class IBackend : public Traits::IJournaled
 {
 public:
     using Ptr = std::shared_ptr<IBackend>;
@@ -30,5 +30,13 @@ public:
     virtual Leaf GetLeaf(const LeafIndex& idx) const = 0;
 
     virtual LeafIndex GetNextLeaf() const noexcept { return LeafIndex::At(GetNumLeaves()); }
+
+    //
+    // Returns a read-only backend of the committed state, which later writes don't affect.
+    //
+    virtual IBackend::Ptr CreateSnapshot() const = 0;
+
+    // Backends that aren't stored in files have nothing to journal.
+    std::vector<FileWrites> GetPendingWrites() const override { return {}; }
 };
 }
\ No newline at end of file
@@ -5,7 +5,7 @@
 // file LICENSE or http://www.opensource.org/licenses/mit-license.php.
 
 #include <mw/core/models/crypto/Hash.h>
-#include <mw/core/traits/Batchable.h>
+#include <mw/core/traits/Journaled.h>
 #include <mw/core/mmr/Backend.h>
 #include <mw/core/mmr/LeafIndex.h>
 #include <mw/core/mmr/Leaf.h>
@@ -13,7 +13,7 @@
 
 namespace mmr
 {
-class MMR : public Traits::IBatchable
+class MMR : public Traits::IJournaled
 {
 public:
     using Ptr = std::shared_ptr<MMR>;
@@ -35,6 +35,14 @@ public:
     //
     Hash Root() const;
 
+    //
+    // Returns a read-only view of the committed MMR, whose size and root stay fixed while this MMR is written to.
+    // Can be called from any thread, even while another thread is writing.
+    // Snapshots of different MMRs, or of the block DB, are independent, so they may be from different commits.
+    //
+    MMR::CPtr CreateSnapshot() const { return std::make_shared<const MMR>(m_pBackend->CreateSnapshot()); }
+
+    std::vector<FileWrites> GetPendingWrites() const final { return m_pBackend->GetPendingWrites(); }
     void Commit() final { m_pBackend->Commit(); }
     void Rollback() noexcept final { m_pBackend->Rollback(); }
 
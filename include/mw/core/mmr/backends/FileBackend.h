@@ -6,8 +6,10 @@
 
 #include <mw/core/mmr/Backend.h>
 #include <mw/core/mmr/Node.h>
+#include <mw/core/common/Metrics.h>
 #include <mw/core/file/FilePath.h>
 #include <mw/core/file/AppendOnlyFile.h>
+#include <mw/core/exceptions/UnimplementedException.h>
 #include <cassert>
 
 namespace mmr
@@ -30,7 +32,8 @@ public:
         auto pBackend = std::make_shared<FileBackend>(
             AppendOnlyFile::Load(path.GetChild("pmmr_hash.bin")),
             AppendOnlyFile::Load(path.GetChild("pmmr_data.bin")),
-            fixedLengthOpt.value_or(0)
+            fixedLengthOpt.value_or(0),
+            path.ToPath().filename().u8string()
         );
 
         if (!fixedLengthOpt.has_value())
@@ -38,11 +41,20 @@ public:
             pBackend->m_pPositionFile = AppendOnlyFile::Load(path.GetChild("pmmr_pos.bin"));
         }
 
+        pBackend->UpdateNumLeaves();
+
         return pBackend;
     }
 
-    FileBackend(const AppendOnlyFile::Ptr& pHashFile, const AppendOnlyFile::Ptr& pDataFile, const uint16_t fixedLength)
-        : m_pHashFile(pHashFile), m_pDataFile(pDataFile), m_fixedLength(fixedLength) { }
+    //
+    // The name labels the backend's metrics, which are shared by backends with the same name.
+    //
+    FileBackend(const AppendOnlyFile::Ptr& pHashFile, const AppendOnlyFile::Ptr& pDataFile, const uint16_t fixedLength, const std::string& name = "")
+        : m_pHashFile(pHashFile),
+        m_pDataFile(pDataFile),
+        m_fixedLength(fixedLength),
+        m_numLeaves(MetricsAPI::GetGauge("mmr_leaves", "Leaves in the MMR, including uncommitted ones.", FormatLabels(name))),
+        m_commitLatency(MetricsAPI::GetHistogram("mmr_commit_seconds", "Time to commit the MMR's files.", FormatLabels(name))) { }
 
     void AddLeaf(const Leaf& leaf) final
     {
@@ -60,6 +72,8 @@ public:
             rightHash = node.GetHash();
             nextIdx = nextIdx.GetNext();
         }
+
+        UpdateNumLeaves();
     }
 
     void AddHash(const Hash& hash) final { m_pHashFile->Append(hash.vec()); }
@@ -72,45 +86,49 @@ public:
         m_pPositionFile->Rewind(nextLeafIndex.GetLeafIndex());
         m_pDataFile->Rewind(posEntry.position + posEntry.size);
         m_pHashFile->Rewind(nextLeafIndex.GetPosition());
+        UpdateNumLeaves();
     }
 
-    uint64_t GetNumLeaves() const noexcept final
+    uint64_t GetNumLeaves() const noexcept final { return CountLeaves(*m_pDataFile, m_pPositionFile.get(), m_fixedLength); }
+    Hash GetHash(const Index& idx) const final { return ReadHash(*m_pHashFile, idx); }
+    Leaf GetLeaf(const LeafIndex& idx) const final { return ReadLeaf(*m_pDataFile, m_pPositionFile.get(), m_fixedLength, idx); }
+
+    //
+    // The committed leaves and hashes, as of when the snapshot was taken.
+    // Can be called from any thread, even while another thread is writing.
+    //
+    IBackend::Ptr CreateSnapshot() const final
     {
+        tl::optional<AppendOnlyFile::Snapshot> positionOpt;
         if (m_pPositionFile != nullptr)
         {
-            return m_pPositionFile->GetSize() / PosEntry::LENGTH;
+            positionOpt = m_pPositionFile->GetSnapshot();
         }
-        else
-        {
-            return m_pDataFile->GetSize() / m_fixedLength;
-        }
-    }
 
-    Hash GetHash(const Index& idx) const final
-    {
-        return Hash(m_pHashFile->Read(idx.GetPosition() * HASH::LENGTH, HASH::LENGTH));
+        return std::make_shared<Snapshot>(m_pHashFile->GetSnapshot(), m_pDataFile->GetSnapshot(), std::move(positionOpt), m_fixedLength);
     }
 
-    Leaf GetLeaf(const LeafIndex& idx) const final
+    std::vector<FileWrites> GetPendingWrites() const final
     {
-        assert(idx.IsLeaf());
-
-        const uint64_t leafIndex = idx.GetLeafIndex();
-        if (m_pPositionFile != nullptr)
-        {
-            PosEntry posEntry = GetPosEntry(leafIndex);
-            std::vector<uint8_t> data = m_pDataFile->Read(posEntry.position, posEntry.size);
-            return Leaf::Create(idx, std::move(data));
-        }
-        else
+        std::vector<FileWrites> writes;
+        for (const AppendOnlyFile* pFile : { m_pHashFile.get(), m_pDataFile.get(), m_pPositionFile.get() })
         {
-            std::vector<uint8_t> data = m_pDataFile->Read(leafIndex * m_fixedLength, m_fixedLength);
-            return Leaf::Create(idx, std::move(data));
+            if (pFile != nullptr)
+            {
+                for (FileWrites& fileWrites : pFile->GetPendingWrites())
+                {
+                    writes.push_back(std::move(fileWrites));
+                }
+            }
         }
+
+        return writes;
     }
 
     void Commit() final
     {
+        LatencyTimer timer(m_commitLatency);
+
         m_pHashFile->Commit();
         m_pDataFile->Commit();
 
@@ -129,14 +147,97 @@ public:
         {
             m_pPositionFile->Rollback();
         }
+
+        UpdateNumLeaves();
     }
 
 private:
-    PosEntry GetPosEntry(const uint64_t leafIndex) const
+    //
+    // Read-only view of the committed files.
+    // The sizes of the file snapshots are fixed when taken, so the MMR size is too.
+    //
+    class Snapshot : public IBackend
     {
-        assert(m_pPositionFile != nullptr);
+    public:
+        Snapshot(
+            AppendOnlyFile::Snapshot&& hashFile,
+            AppendOnlyFile::Snapshot&& dataFile,
+            tl::optional<AppendOnlyFile::Snapshot>&& positionFileOpt,
+            const uint16_t fixedLength)
+            : m_hashFile(std::move(hashFile)),
+            m_dataFile(std::move(dataFile)),
+            m_positionFileOpt(std::move(positionFileOpt)),
+            m_fixedLength(fixedLength) { }
+
+        void AddLeaf(const Leaf&) final { ThrowUnimplemented("MMR snapshots are read-only"); }
+        void AddHash(const Hash&) final { ThrowUnimplemented("MMR snapshots are read-only"); }
+        void Rewind(const LeafIndex&) final { ThrowUnimplemented("MMR snapshots are read-only"); }
+
+        uint64_t GetNumLeaves() const noexcept final { return CountLeaves(m_dataFile, GetPositionFile(), m_fixedLength); }
+        Hash GetHash(const Index& idx) const final { return ReadHash(m_hashFile, idx); }
+        Leaf GetLeaf(const LeafIndex& idx) const final { return ReadLeaf(m_dataFile, GetPositionFile(), m_fixedLength, idx); }
+        IBackend::Ptr CreateSnapshot() const final { return std::make_shared<Snapshot>(*this); }
+
+        void Commit() final { }
+        void Rollback() noexcept final { }
 
-        std::vector<uint8_t> data = m_pPositionFile->Read(leafIndex * PosEntry::LENGTH, PosEntry::LENGTH);
+    private:
+        const AppendOnlyFile::Snapshot* GetPositionFile() const noexcept
+        {
+            return m_positionFileOpt.has_value() ? &m_positionFileOpt.value() : nullptr;
+        }
+
+        AppendOnlyFile::Snapshot m_hashFile;
+        AppendOnlyFile::Snapshot m_dataFile;
+        tl::optional<AppendOnlyFile::Snapshot> m_positionFileOpt;
+        uint16_t m_fixedLength;
+    };
+
+    //
+    // Reads are shared by the backend and its snapshots, so F is either an AppendOnlyFile or an AppendOnlyFile::Snapshot.
+    //
+    template<typename F>
+    static uint64_t CountLeaves(const F& dataFile, const F* pPositionFile, const uint16_t fixedLength) noexcept
+    {
+        if (pPositionFile != nullptr)
+        {
+            return pPositionFile->GetSize() / PosEntry::LENGTH;
+        }
+        else
+        {
+            return dataFile.GetSize() / fixedLength;
+        }
+    }
+
+    template<typename F>
+    static Hash ReadHash(const F& hashFile, const Index& idx)
+    {
+        return Hash(hashFile.Read(idx.GetPosition() * HASH::LENGTH, HASH::LENGTH));
+    }
+
+    template<typename F>
+    static Leaf ReadLeaf(const F& dataFile, const F* pPositionFile, const uint16_t fixedLength, const LeafIndex& idx)
+    {
+        assert(idx.IsLeaf());
+
+        const uint64_t leafIndex = idx.GetLeafIndex();
+        if (pPositionFile != nullptr)
+        {
+            PosEntry posEntry = ReadPosEntry(*pPositionFile, leafIndex);
+            std::vector<uint8_t> data = dataFile.Read(posEntry.position, posEntry.size);
+            return Leaf::Create(idx, std::move(data));
+        }
+        else
+        {
+            std::vector<uint8_t> data = dataFile.Read(leafIndex * fixedLength, fixedLength);
+            return Leaf::Create(idx, std::move(data));
+        }
+    }
+
+    template<typename F>
+    static PosEntry ReadPosEntry(const F& positionFile, const uint64_t leafIndex)
+    {
+        std::vector<uint8_t> data = positionFile.Read(leafIndex * PosEntry::LENGTH, PosEntry::LENGTH);
 
         Deserializer deserializer(std::move(data));
         const uint64_t position = deserializer.Read<uint64_t>();
@@ -144,6 +245,19 @@ private:
         return PosEntry{ position, size };
     }
 
+    static std::string FormatLabels(const std::string& name)
+    {
+        return name.empty() ? std::string() : MetricsAPI::FormatLabel("mmr", name);
+    }
+
+    void UpdateNumLeaves() noexcept { m_numLeaves.Set((int64_t)GetNumLeaves()); }
+
+    PosEntry GetPosEntry(const uint64_t leafIndex) const
+    {
+        assert(m_pPositionFile != nullptr);
+        return ReadPosEntry(*m_pPositionFile, leafIndex);
+    }
+
     void AppendData(const std::vector<unsigned char>& data)
     {
         if (m_pPositionFile != nullptr)
@@ -163,5 +277,8 @@ private:
     AppendOnlyFile::Ptr m_pPositionFile;
 
     uint16_t m_fixedLength;
+
+    Gauge& m_numLeaves;
+    Histogram& m_commitLatency;
 };
 }
\ No newline at end of file
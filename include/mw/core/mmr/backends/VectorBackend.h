@@ -46,6 +46,9 @@ public:
     Hash GetHash(const Index& idx) const final { return m_nodes[idx.GetPosition()]; }
     Leaf GetLeaf(const LeafIndex& idx) const final { return m_leaves[idx.GetLeafIndex()]; }
 
+    // Changes aren't batched, so the snapshot is a copy of everything.
+    IBackend::Ptr CreateSnapshot() const final { return std::make_shared<VectorBackend>(*this); }
+
     // TODO: Implement
     void Commit() final { }
     void Rollback() noexcept final { }
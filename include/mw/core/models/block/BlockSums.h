@@ -0,0 +1,71 @@
+#pragma once
+
+// Copyright (c) 2018-2019 David Burkett
+// Distributed under the MIT software license, see the accompanying
+// file LICENSE or http://www.opensource.org/licenses/mit-license.php.
+
+#include <mw/core/models/crypto/Commitment.h>
+#include <mw/core/traits/Serializable.h>
+#include <mw/core/serialization/Serializer.h>
+
+#include <memory>
+
+////////////////////////////////////////
+// BLOCK SUMS - The running totals of the output and kernel commitments, as of a given block.
+////////////////////////////////////////
+class BlockSums : public Traits::ISerializable
+{
+public:
+    using CPtr = std::shared_ptr<const BlockSums>;
+
+    //
+    // Constructors
+    //
+    BlockSums(Commitment&& outputSum, Commitment&& kernelSum)
+        : m_outputSum(std::move(outputSum)), m_kernelSum(std::move(kernelSum)) { }
+    BlockSums(const BlockSums& other) = default;
+    BlockSums(BlockSums&& other) noexcept = default;
+    BlockSums() = default;
+
+    //
+    // Destructor
+    //
+    virtual ~BlockSums() = default;
+
+    //
+    // Operators
+    //
+    BlockSums& operator=(const BlockSums& other) = default;
+    BlockSums& operator=(BlockSums&& other) noexcept = default;
+    bool operator==(const BlockSums& rhs) const { return m_outputSum == rhs.m_outputSum && m_kernelSum == rhs.m_kernelSum; }
+
+    //
+    // Getters
+    //
+    const Commitment& GetOutputSum() const noexcept { return m_outputSum; }
+    const Commitment& GetKernelSum() const noexcept { return m_kernelSum; }
+
+    //
+    // Serialization/Deserialization
+    //
+    Serializer& Serialize(Serializer& serializer) const noexcept final
+    {
+        return serializer
+            .Append(m_outputSum)
+            .Append(m_kernelSum);
+    }
+
+    static BlockSums Deserialize(Deserializer& deserializer)
+    {
+        Commitment outputSum = Commitment::Deserialize(deserializer);
+        Commitment kernelSum = Commitment::Deserialize(deserializer);
+        return BlockSums(std::move(outputSum), std::move(kernelSum));
+    }
+
+private:
+    // Sum of all unspent output commitments, minus the overage.
+    Commitment m_outputSum;
+
+    // Sum of all kernel excesses, not including the kernel offset.
+    Commitment m_kernelSum;
+};
\ No newline at end of file
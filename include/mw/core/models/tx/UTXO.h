@@ -27,8 +27,10 @@ public:
 
     static UTXO::CPtr Deserialize(const Context::CPtr& pContext, Deserializer& deserializer)
     {
-        // TODO: Implement
-        throw std::exception();
+        const uint64_t blockHeight = deserializer.Read<uint64_t>();
+        mmr::LeafIndex leafIndex = mmr::LeafIndex::At(deserializer.Read<uint64_t>());
+        Output output = Output::Deserialize(pContext, deserializer);
+        return std::make_shared<const UTXO>(blockHeight, std::move(leafIndex), std::move(output));
     }
 
 private:
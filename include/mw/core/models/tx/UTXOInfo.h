@@ -0,0 +1,55 @@
+#pragma once
+
+#include <mw/core/models/tx/UTXO.h>
+#include <mw/core/models/tx/Features.h>
+#include <mw/core/mmr/LeafIndex.h>
+#include <mw/core/traits/Serializable.h>
+#include <mw/core/serialization/Serializer.h>
+
+//
+// The small, frequently accessed part of a UTXO.
+// Enough for existence, maturity and MMR position checks, without loading the range proof.
+//
+class UTXOInfo : public Traits::ISerializable
+{
+public:
+    using CPtr = std::shared_ptr<const UTXOInfo>;
+
+    UTXOInfo(const uint64_t blockHeight, mmr::LeafIndex&& leafIndex, const EOutputFeatures features)
+        : m_blockHeight(blockHeight), m_leafIndex(std::move(leafIndex)), m_features(features) { }
+
+    static UTXOInfo::CPtr From(const UTXO& utxo)
+    {
+        return std::make_shared<const UTXOInfo>(
+            utxo.GetBlockHeight(),
+            mmr::LeafIndex(utxo.GetLeafIndex()),
+            utxo.GetOutput().GetFeatures()
+        );
+    }
+
+    uint64_t GetBlockHeight() const noexcept { return m_blockHeight; }
+    const mmr::LeafIndex& GetLeafIndex() const noexcept { return m_leafIndex; }
+    EOutputFeatures GetFeatures() const noexcept { return m_features; }
+
+    // Serialized the same as the start of a UTXO, so the two stay compatible.
+    Serializer& Serialize(Serializer& serializer) const noexcept final
+    {
+        return serializer
+            .Append<uint64_t>(m_blockHeight)
+            .Append<uint64_t>(m_leafIndex.GetLeafIndex())
+            .Append<uint8_t>((uint8_t)m_features);
+    }
+
+    static UTXOInfo::CPtr Deserialize(const Context::CPtr&, Deserializer& deserializer)
+    {
+        const uint64_t blockHeight = deserializer.Read<uint64_t>();
+        mmr::LeafIndex leafIndex = mmr::LeafIndex::At(deserializer.Read<uint64_t>());
+        const EOutputFeatures features = (EOutputFeatures)deserializer.Read<uint8_t>();
+        return std::make_shared<const UTXOInfo>(blockHeight, std::move(leafIndex), features);
+    }
+
+private:
+    uint64_t m_blockHeight;
+    mmr::LeafIndex m_leafIndex;
+    EOutputFeatures m_features;
+};
\ No newline at end of file
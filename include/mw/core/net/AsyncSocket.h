@@ -0,0 +1,117 @@
+#pragma once
+
+#include <mw/core/models/net/SocketAddress.h>
+#include <mw/core/net/IOContextPool.h>
+
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+//
+// A TCP socket driven by a shared IOContextPool, so connections no longer need a thread each.
+//
+// Every operation takes a deadline. If it isn't met, the socket is closed, since that's the only portable way to
+// cancel an outstanding operation, and the handler gets asio::error::timed_out. Later operations fail too.
+//
+// One read can be outstanding at a time. A read started while another is pending fails with
+// asio::error::already_started. Reads only pull as much as was asked for, plus whatever arrived alongside it, and a
+// line longer than MAX_LINE_LENGTH fails with asio::error::not_found, so a peer can't make the buffer grow unbounded.
+//
+// Writes are queued and sent in order. AsyncWrite refuses to queue more than maxQueuedBytes, returning false, so a
+// slow peer pushes back on the producer instead of growing the queue. A single write larger than the limit is still
+// accepted when nothing else is queued.
+//
+// All methods may be called from any thread. Handlers run on the socket's pool thread, and must not block.
+//
+class AsyncSocket : public std::enable_shared_from_this<AsyncSocket>
+{
+public:
+    using Ptr = std::shared_ptr<AsyncSocket>;
+    using Duration = std::chrono::steady_clock::duration;
+
+    using ConnectHandler = std::function<void(const asio::error_code&, AsyncSocket::Ptr)>;
+    using ReadHandler = std::function<void(const asio::error_code&, std::vector<uint8_t>&&)>;
+    using ReadLineHandler = std::function<void(const asio::error_code&, std::string&&)>;
+    using WriteHandler = std::function<void(const asio::error_code&)>;
+
+    static constexpr size_t MAX_LINE_LENGTH = 64 * 1024;
+    static constexpr size_t DEFAULT_MAX_QUEUED_BYTES = 4 * 1024 * 1024;
+
+    static void AsyncConnect(
+        IOContextPool& pool,
+        const SocketAddress& address,
+        const Duration& timeout,
+        ConnectHandler handler,
+        const size_t maxQueuedBytes = DEFAULT_MAX_QUEUED_BYTES
+    );
+
+    //
+    // Accepts the next connection onto one of the pool's contexts.
+    // The accept is started from the acceptor's executor, so its own context must be running, and the acceptor
+    // and pool must outlive the accept. To give up, cancel the acceptor from its executor too.
+    //
+    static void AsyncAccept(
+        asio::ip::tcp::acceptor& acceptor,
+        IOContextPool& pool,
+        ConnectHandler handler,
+        const size_t maxQueuedBytes = DEFAULT_MAX_QUEUED_BYTES
+    );
+
+    //
+    // Reads up to and including the next '\n', and returns the line without it.
+    //
+    void AsyncReadLine(const Duration& timeout, ReadLineHandler handler);
+
+    void AsyncRead(const size_t numBytes, const Duration& timeout, ReadHandler handler);
+
+    //
+    // Returns false, without queuing the data, if maxQueuedBytes are already waiting to be sent.
+    // The caller should hold off until the handlers of earlier writes have run.
+    //
+    bool AsyncWrite(std::vector<uint8_t>&& data, const Duration& timeout, WriteHandler handler);
+
+    size_t GetQueuedBytes() const noexcept { return m_queuedBytes.load(std::memory_order_relaxed); }
+
+    //
+    // Outstanding operations complete with an error, usually asio::error::operation_aborted.
+    //
+    void Close();
+
+private:
+    struct WriteRequest
+    {
+        std::vector<uint8_t> data;
+        Duration timeout;
+        WriteHandler handler;
+    };
+
+    AsyncSocket(asio::ip::tcp::socket&& socket, const size_t maxQueuedBytes);
+
+    //
+    // The methods below only run on the socket's executor.
+    //
+    void StartDeadline(asio::steady_timer& timer, const Duration& timeout);
+    static void StopDeadline(asio::steady_timer& timer);
+    asio::error_code ToResult(const asio::error_code& ec) const noexcept;
+    std::vector<uint8_t> TakeBytes(const size_t numBytes);
+    void WriteNext();
+    void CloseSocket() noexcept;
+
+    asio::ip::tcp::socket m_socket;
+    asio::steady_timer m_readTimer;
+    asio::steady_timer m_writeTimer;
+    bool m_timedOut;
+
+    std::string m_readBuffer;
+    bool m_reading;
+
+    std::deque<WriteRequest> m_writeQueue;
+    bool m_writing;
+    const size_t m_maxQueuedBytes;
+    std::atomic<size_t> m_queuedBytes;
+};
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <mw/core/common/Logger.h>
+#include <mw/core/common/ThreadManager.h>
+#include <mw/core/util/ThreadUtil.h>
+
+#include <asio.hpp>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+//
+// A fixed set of io_contexts, each run by a single thread, shared by every socket in the process.
+//
+// Sockets are handed out round-robin, and stay on their context for life. With only one thread per context,
+// a socket's handlers never run concurrently, so sockets don't need strands. Each context is created with a
+// concurrency hint of 1, which only tells the scheduler a single thread runs it. asio still locks internally,
+// since other threads post to the context and start operations on its sockets.
+//
+// Handlers run on the pool's threads, so they must not block. In particular, they must not wait on another socket.
+//
+class IOContextPool
+{
+public:
+    using Ptr = std::shared_ptr<IOContextPool>;
+
+    static IOContextPool::Ptr Create(const size_t numThreads, const std::string& name = "IO")
+    {
+        auto pPool = std::shared_ptr<IOContextPool>(new IOContextPool());
+
+        for (size_t i = 0; i < std::max<size_t>(numThreads, 1); i++)
+        {
+            auto pContext = std::make_unique<asio::io_context>(1);
+            pPool->m_guards.push_back(asio::make_work_guard(*pContext));
+            pPool->m_threads.push_back(ThreadManagerAPI::CreateThread(name + "_" + std::to_string(i), IOContextPool::Run, pContext.get()));
+            pPool->m_contexts.push_back(std::move(pContext));
+        }
+
+        return pPool;
+    }
+
+    //
+    // The process-wide pool, with a few threads. It's never destroyed.
+    //
+    static IOContextPool& GetDefault();
+
+    //
+    // Handlers still queued are dropped, and the threads are joined.
+    //
+    ~IOContextPool()
+    {
+        m_guards.clear();
+        for (auto& pContext : m_contexts)
+        {
+            pContext->stop();
+        }
+
+        ThreadUtil::JoinAll(m_threads);
+    }
+
+    size_t GetNumThreads() const noexcept { return m_threads.size(); }
+
+    asio::io_context& GetContext() noexcept
+    {
+        return *m_contexts[m_next.fetch_add(1, std::memory_order_relaxed) % m_contexts.size()];
+    }
+
+private:
+    IOContextPool() : m_next(0) { }
+
+    static void Run(asio::io_context* pContext)
+    {
+        while (true)
+        {
+            try
+            {
+                // Only returns once the context is stopped.
+                pContext->run();
+                return;
+            }
+            catch (std::exception& e)
+            {
+                LOG_ERROR_F("Handler threw an exception: {}", e.what());
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<asio::io_context>> m_contexts;
+    std::vector<asio::executor_work_guard<asio::io_context::executor_type>> m_guards;
+    std::vector<std::thread> m_threads;
+    std::atomic<size_t> m_next;
+};
\ No newline at end of file
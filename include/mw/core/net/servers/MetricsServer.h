@@ -0,0 +1,44 @@
+#pragma once
+
+#include <mw/core/common/Metrics.h>
+#include <mw/core/net/servers/HttpServer.h>
+#include <civetweb/civetweb.h>
+#include <tl/optional.hpp>
+#include <string>
+#include <memory>
+
+//
+// Serves MetricsAPI::Render() at /metrics, on the loopback interface only, for a local Prometheus agent or curl.
+//
+class MetricsServer
+{
+public:
+    using Ptr = std::shared_ptr<MetricsServer>;
+
+    static MetricsServer::Ptr Create(const tl::optional<uint16_t>& port = tl::nullopt)
+    {
+        HttpServer::Ptr pHttpServer = HttpServer::CreateLocal(port);
+        pHttpServer->AddHandler("/metrics", MetricsServer::HandleMetrics, nullptr);
+        return std::shared_ptr<MetricsServer>(new MetricsServer(pHttpServer));
+    }
+
+    uint16_t GetPortNumber() const noexcept { return m_pHttpServer->GetPortNumber(); }
+
+private:
+    MetricsServer(const HttpServer::Ptr& pHttpServer) : m_pHttpServer(pHttpServer) { }
+
+    static int HandleMetrics(mg_connection* pConnection, void*)
+    {
+        const std::string body = MetricsAPI::Render();
+
+        mg_printf(
+            pConnection,
+            "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+            body.size()
+        );
+        mg_write(pConnection, body.data(), body.size());
+        return 200;
+    }
+
+    HttpServer::Ptr m_pHttpServer;
+};
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <mw/core/models/net/SocketAddress.h>
 #include <mw/core/exceptions/NetworkException.h>
+#include <mw/core/net/IOContextPool.h>
 #include <mw/core/net/Socket.h>
 #include <asio.hpp>
 #include <tl/optional.hpp>
@@ -27,11 +28,9 @@ public:
     
 private:
     Server(
-        std::shared_ptr<asio::io_context> pContext,
         std::shared_ptr<asio::ip::tcp::acceptor> pAcceptor,
         SocketAddress&& address)
-        : m_pContext(pContext),
-        m_pAcceptor(pAcceptor),
+        : m_pAcceptor(pAcceptor),
         m_address(std::move(address))
     {
 
@@ -39,8 +38,7 @@ private:
 
     static Server::Ptr Create(SocketAddress&& address)
     {
-        auto pContext = std::make_shared<asio::io_context>();
-        auto pAcceptor = std::make_shared<asio::ip::tcp::acceptor>(*pContext, address.GetEndpoint());
+        auto pAcceptor = std::make_shared<asio::ip::tcp::acceptor>(IOContextPool::GetDefault().GetContext(), address.GetEndpoint());
 
         asio::error_code errorCode;
         pAcceptor->listen(asio::socket_base::max_listen_connections, errorCode);
@@ -49,7 +47,7 @@ private:
             ThrowNetwork_F("Listener failed with error: {}", errorCode.message());
         }
 
-        Server::Ptr pServer(new Server(pContext, pAcceptor, std::move(address)));
+        return Server::Ptr(new Server(pAcceptor, std::move(address)));
     }
 
     static void Thread_Loop(Server::Ptr pServer)
@@ -58,7 +56,7 @@ private:
         {
             try
             {
-                Socket::Ptr pSocket = Socket::Accept(pServer->m_pContext, *pServer->m_pAcceptor);
+                Socket::Ptr pSocket = Socket::Accept(*pServer->m_pAcceptor, std::chrono::milliseconds(100));
             }
             catch (std::system_error&)
             {
@@ -66,10 +64,13 @@ private:
             }
         }
 
-        pServer->m_pAcceptor->cancel();
+        // The acceptor can only be touched from its own executor.
+        asio::post(pServer->m_pAcceptor->get_executor(), [pAcceptor = pServer->m_pAcceptor]() {
+            asio::error_code ec;
+            pAcceptor->cancel(ec);
+        });
     }
 
-    std::shared_ptr<asio::io_context> m_pContext;
     std::shared_ptr<asio::ip::tcp::acceptor> m_pAcceptor;
     SocketAddress m_address;
 
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <mw/core/file/FileWrites.h>
+#include <mw/core/traits/Batchable.h>
+
+#include <vector>
+
+namespace Traits
+{
+    //
+    // A batchable whose uncommitted changes are file writes, so they can be recorded in a CommitJournal
+    // before they're applied, and replayed if a crash interrupts the commit.
+    //
+    class IJournaled : public IBatchable
+    {
+    public:
+        virtual ~IJournaled() = default;
+
+        //
+        // The writes the next Commit() will make. Empty if there are no uncommitted changes.
+        //
+        virtual std::vector<FileWrites> GetPendingWrites() const = 0;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <mw/core/common/Logger.h>
+#include <tl/optional.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+//
+// The runtime level of every module, per log file.
+//
+// Each module gets one atomic threshold, which the logging macros keep a reference to, so a level change made here
+// is seen by every statement on its next load. Thresholds are never freed, since statements hold on to them.
+//
+class LogLevels
+{
+public:
+    // Above ERR, so nothing passes.
+    static constexpr uint8_t OFF = LoggerAPI::LogLevel::ERR + 1;
+
+    LogLevels() : m_defaults({ OFF, OFF }) { }
+
+    const std::atomic<uint8_t>& GetThreshold(const LoggerAPI::LogFile file, const std::string& module)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return GetEntry(file, Normalize(module)).threshold;
+    }
+
+    //
+    // The threshold for modules without a level of their own.
+    //
+    uint8_t GetDefault(const LoggerAPI::LogFile file) const
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_defaults[(size_t)file];
+    }
+
+    void SetLevel(const LoggerAPI::LogFile file, const std::string& module, const LoggerAPI::LogLevel level)
+    {
+        const uint8_t threshold = ToThreshold(level);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (module.empty())
+        {
+            m_defaults[(size_t)file] = threshold;
+            for (auto& entry : m_entries)
+            {
+                if (entry.first.first == file && !entry.second->overrideOpt.has_value())
+                {
+                    entry.second->threshold.store(threshold, std::memory_order_relaxed);
+                }
+            }
+        }
+        else
+        {
+            Entry& entry = GetEntry(file, Normalize(module));
+            entry.overrideOpt = threshold;
+            entry.threshold.store(threshold, std::memory_order_relaxed);
+        }
+    }
+
+    void ClearLevel(const LoggerAPI::LogFile file, const std::string& module)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        Entry& entry = GetEntry(file, Normalize(module));
+        entry.overrideOpt = tl::nullopt;
+        entry.threshold.store(m_defaults[(size_t)file], std::memory_order_relaxed);
+    }
+
+    static uint8_t ToThreshold(const LoggerAPI::LogLevel level) noexcept
+    {
+        return level == LoggerAPI::LogLevel::NONE ? OFF : (uint8_t)level;
+    }
+
+    static LoggerAPI::LogLevel ToLevel(const uint8_t threshold) noexcept
+    {
+        return threshold >= OFF ? LoggerAPI::LogLevel::NONE : (LoggerAPI::LogLevel)threshold;
+    }
+
+private:
+    struct Entry
+    {
+        Entry(const uint8_t threshold_) : threshold(threshold_) { }
+
+        std::atomic<uint8_t> threshold;
+        tl::optional<uint8_t> overrideOpt;
+    };
+
+    Entry& GetEntry(const LoggerAPI::LogFile file, const std::string& module)
+    {
+        auto key = std::make_pair(file, module);
+        auto iter = m_entries.find(key);
+        if (iter == m_entries.end())
+        {
+            iter = m_entries.insert({ key, std::make_unique<Entry>(m_defaults[(size_t)file]) }).first;
+        }
+
+        return *iter->second;
+    }
+
+    static std::string Normalize(std::string module)
+    {
+        std::transform(module.begin(), module.end(), module.begin(), [](const unsigned char c) { return (char)std::toupper(c); });
+        return module;
+    }
+
+    mutable std::mutex m_mutex;
+    std::array<uint8_t, 2> m_defaults;
+    std::map<std::pair<LoggerAPI::LogFile, std::string>, std::unique_ptr<Entry>> m_entries;
+};
\ No newline at end of file
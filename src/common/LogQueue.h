@@ -0,0 +1,196 @@
+#pragma once
+
+#include <mw/core/common/Logger.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+struct LogMessage
+{
+    LoggerAPI::LogFile file;
+    LoggerAPI::LogLevel level;
+    std::chrono::system_clock::time_point time;
+    std::string threadName;
+    std::string text;
+};
+
+//
+// A bounded, lock-free queue of log messages, for any number of logging threads and one writer thread.
+//
+// Each slot carries a sequence number, which says whether it's free for the next push or holds the next message
+// to pop, so threads only contend through a compare-and-swap on the position they're claiming (Vyukov's bounded queue).
+//
+// When the queue is full, the OverflowPolicy decides what happens. Warnings and errors always wait for space,
+// so only chatty levels are ever dropped.
+//
+class LogQueue
+{
+public:
+    LogQueue(const size_t capacity, const LoggerAPI::OverflowPolicy policy)
+        : m_mask(RoundUp(capacity) - 1),
+        m_pSlots(new Slot[m_mask + 1]),
+        m_policy(policy),
+        m_pushPos(0),
+        m_popPos(0),
+        m_numDropped(0),
+        m_maxDepth(0)
+    {
+        for (size_t i = 0; i <= m_mask; i++)
+        {
+            m_pSlots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    //
+    // Called by the logging threads. Returns false if the message was dropped.
+    // onFull is called each time a push finds the queue full, so the writer can be woken.
+    //
+    template<typename F>
+    bool Push(LogMessage&& message, const F& onFull)
+    {
+        const bool droppable = message.level < LoggerAPI::LogLevel::WARN;
+        const LoggerAPI::OverflowPolicy policy = droppable ? m_policy : LoggerAPI::OverflowPolicy::BLOCK;
+
+        while (!TryPush(message))
+        {
+            onFull();
+
+            if (policy == LoggerAPI::OverflowPolicy::DROP_NEWEST)
+            {
+                m_numDropped++;
+                return false;
+            }
+            else if (policy == LoggerAPI::OverflowPolicy::DROP_OLDEST)
+            {
+                LogMessage oldest;
+                if (TryPop(oldest))
+                {
+                    m_numDropped++;
+                }
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        const size_t depth = GetDepth();
+        size_t maxDepth = m_maxDepth.load(std::memory_order_relaxed);
+        while (depth > maxDepth && !m_maxDepth.compare_exchange_weak(maxDepth, depth, std::memory_order_relaxed)) { }
+
+        return true;
+    }
+
+    //
+    // Returns false if the queue is empty.
+    //
+    bool TryPop(LogMessage& message)
+    {
+        size_t pos = m_popPos.load(std::memory_order_relaxed);
+        Slot* pSlot = nullptr;
+        while (true)
+        {
+            pSlot = &m_pSlots[pos & m_mask];
+            const size_t sequence = pSlot->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+            if (diff == 0)
+            {
+                if (m_popPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_popPos.load(std::memory_order_relaxed);
+            }
+        }
+
+        message = std::move(pSlot->message);
+        pSlot->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t GetCapacity() const noexcept { return m_mask + 1; }
+
+    //
+    // Approximate, since pushes and pops may be in progress.
+    //
+    size_t GetDepth() const noexcept
+    {
+        const size_t popPos = m_popPos.load(std::memory_order_relaxed);
+        const size_t pushPos = m_pushPos.load(std::memory_order_relaxed);
+        return pushPos > popPos ? pushPos - popPos : 0;
+    }
+
+    size_t GetMaxDepth() const noexcept { return m_maxDepth.load(std::memory_order_relaxed); }
+    uint64_t GetNumDropped() const noexcept { return m_numDropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        LogMessage message;
+    };
+
+    bool TryPush(LogMessage& message)
+    {
+        size_t pos = m_pushPos.load(std::memory_order_relaxed);
+        Slot* pSlot = nullptr;
+        while (true)
+        {
+            pSlot = &m_pSlots[pos & m_mask];
+            const size_t sequence = pSlot->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+            if (diff == 0)
+            {
+                if (m_pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_pushPos.load(std::memory_order_relaxed);
+            }
+        }
+
+        pSlot->message = std::move(message);
+        pSlot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    static size_t RoundUp(const size_t capacity) noexcept
+    {
+        size_t rounded = 2;
+        while (rounded < capacity)
+        {
+            rounded *= 2;
+        }
+
+        return rounded;
+    }
+
+    const size_t m_mask;
+    std::unique_ptr<Slot[]> m_pSlots;
+    const LoggerAPI::OverflowPolicy m_policy;
+
+    // Kept on separate cache lines, since logging threads write one, and the writer the other.
+    alignas(64) std::atomic<size_t> m_pushPos;
+    alignas(64) std::atomic<size_t> m_popPos;
+
+    std::atomic<uint64_t> m_numDropped;
+    std::atomic<size_t> m_maxDepth;
+};
\ No newline at end of file
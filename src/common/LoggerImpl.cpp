@@ -1,43 +1,71 @@
 #include "LoggerImpl.h"
 #include "ThreadManagerImpl.h"
 
-#include <spdlog/async.h>
 #include <spdlog/sinks/rotating_file_sink.h>
 
 #include <mw/core/file/FilePath.h>
 
+#include <sstream>
+#include <utility>
+#include <vector>
+
 Logger& Logger::GetInstance()
 {
     static Logger instance;
     return instance;
 }
 
-// TODO: Make asynchronous
-void Logger::StartLogger(const FilePath& logDirectory, const spdlog::level::level_enum& logLevel)
+LogLevels& Logger::GetLevels()
+{
+    static LogLevels* pLevels = new LogLevels();
+    return *pLevels;
+}
+
+Logger::~Logger()
+{
+    if (m_writer.joinable())
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_writerMutex);
+            m_stop = true;
+        }
+
+        m_writerConditional.notify_one();
+        m_writer.join();
+    }
+}
+
+void Logger::StartLogger(const FilePath& logDirectory, const LoggerAPI::Options& options)
 {
     logDirectory.CreateDirIfMissing();
 
     {
         const FilePath logPath = logDirectory.GetChild("Node.log");
         m_pNodeLogger = spdlog::rotating_logger_mt("NODE", logPath.ToString(), 5 * 1024 * 1024, 10);
-        //m_pNodeLogger = spdlog::create_async<spdlog::sinks::rotating_file_sink_mt>("NODE", sink, 32768, spdlog::async_overflow_policy::block, nullptr, std::chrono::seconds(5));
         spdlog::set_pattern("[%D %X.%e%z] [%l] %v");
         if (m_pNodeLogger != nullptr)
         {
-            m_pNodeLogger->set_level(logLevel);
+            m_pNodeLogger->set_level(spdlog::level::trace);
+            m_pNodeLogger->flush_on(spdlog::level::warn);
         }
     }
     {
         const FilePath logPath = logDirectory.GetChild("Wallet.log");
         m_pWalletLogger = spdlog::rotating_logger_mt("WALLET", logPath.ToString(), 5 * 1024 * 1024, 10);
-        //auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(logPath.ToString(), 5 * 1024 * 1024, 10);
-        //m_pWalletLogger = spdlog::create_async("WALLET", sink, 8192, spdlog::async_overflow_policy::block, nullptr, std::chrono::seconds(5));
         spdlog::set_pattern("[%D %X.%e%z] [%l] %v");
         if (m_pWalletLogger != nullptr)
         {
-            m_pWalletLogger->set_level(logLevel);
+            m_pWalletLogger->set_level(spdlog::level::trace);
+            m_pWalletLogger->flush_on(spdlog::level::warn);
         }
     }
+
+    if (options.async)
+    {
+        m_flushInterval = options.flushInterval;
+        m_pQueue = std::make_unique<LogQueue>(options.queueSize, options.overflowPolicy);
+        m_writer = ThreadManagerAPI::CreateThread("LOGGER", Logger::Writer, this);
+    }
 }
 
 spdlog::level::level_enum Logger::Convert(LoggerAPI::LogLevel logLevel) noexcept
@@ -59,34 +87,50 @@ spdlog::level::level_enum Logger::Convert(LoggerAPI::LogLevel logLevel) noexcept
     }
 }
 
-LoggerAPI::LogLevel Logger::Convert(spdlog::level::level_enum logLevel) noexcept
+void Logger::Log(
+    const LoggerAPI::LogFile file,
+    const LoggerAPI::LogLevel logLevel,
+    const std::atomic<uint8_t>& threshold,
+    const std::string& function,
+    const size_t line,
+    const std::string& message) noexcept
 {
-    switch (logLevel)
+    // The level may have been raised since the caller checked it.
+    if ((uint8_t)logLevel < threshold.load(std::memory_order_relaxed) || GetLogger(file) == nullptr)
     {
-        case spdlog::level::trace:
-            return LoggerAPI::LogLevel::TRACE;
-        case spdlog::level::debug:
-            return LoggerAPI::LogLevel::DEBUG;
-        case spdlog::level::info:
-            return LoggerAPI::LogLevel::INFO;
-        case spdlog::level::warn:
-            return LoggerAPI::LogLevel::WARN;
-        case spdlog::level::err:
-            return LoggerAPI::LogLevel::ERR;
-        default:
-            return LoggerAPI::LogLevel::NONE;
+        return;
+    }
+
+    LogMessage logMessage({
+        file,
+        logLevel,
+        std::chrono::system_clock::now(),
+        ThreadManager::GetInstance().GetCurrentThreadName(),
+        function + "(" + std::to_string(line) + ") - " + message
+    });
+
+    if (m_pQueue == nullptr)
+    {
+        Write(logMessage);
+        return;
+    }
+
+    m_pQueue->Push(std::move(logMessage), [this] { WakeWriter(); });
+
+    // Pairs with the fence in Writer(), so either the writer sees the message, or we see it sleeping.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_writerSleeping)
+    {
+        WakeWriter();
     }
 }
 
-void Logger::Log(
-    const LoggerAPI::LogFile file,
-    const LoggerAPI::LogLevel logLevel,
-    const std::string& eventText) noexcept
+void Logger::Write(const LogMessage& message) noexcept
 {
-    auto pLogger = GetLogger(file);
+    auto pLogger = GetLogger(message.file);
     if (pLogger != nullptr)
     {
-        std::string eventTextClean = eventText;
+        std::string eventTextClean = message.text;
         size_t newlinePos = eventTextClean.find("\n");
         while (newlinePos != std::string::npos)
         {
@@ -102,38 +146,146 @@ void Logger::Log(
             newlinePos = eventTextClean.find("\n");
         }
 
-        const std::string threadName = ThreadManager::GetInstance().GetCurrentThreadName();
-        if (!threadName.empty())
+        if (!message.threadName.empty())
         {
-            eventTextClean = threadName + " " + eventTextClean;
+            eventTextClean = message.threadName + " " + eventTextClean;
         }
 
-        pLogger->log(Convert(logLevel), eventTextClean);
+        try
+        {
+            pLogger->log(message.time, spdlog::source_loc(), Convert(message.level), eventTextClean);
+            m_numWritten++;
+        }
+        catch (std::exception&)
+        {
+            // Logger failure should not disrupt program flow
+        }
     }
 }
 
-LoggerAPI::LogLevel Logger::GetLogLevel(const LoggerAPI::LogFile file) const noexcept
+void Logger::WakeWriter()
 {
-    auto pLogger = GetLogger(file);
-    if (pLogger != nullptr)
+    std::unique_lock<std::mutex> lock(m_writerMutex);
+    m_writerConditional.notify_one();
+}
+
+//
+// Drains the queue, then sleeps until more messages arrive, or it's time to flush what it's written.
+//
+void Logger::Writer(Logger* pLogger)
+{
+    bool unflushed = false;
+    auto lastFlush = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(pLogger->m_writerMutex);
+    while (true)
     {
-        return Convert(pLogger->level());
+        // Read before draining, so everything logged before a flush or stop was requested gets written.
+        const uint64_t flushesRequested = pLogger->m_flushesRequested;
+        const bool flushRequested = flushesRequested > pLogger->m_flushesDone;
+        const bool stop = pLogger->m_stop;
+        lock.unlock();
+
+        LogMessage message;
+        while (pLogger->m_pQueue->TryPop(message))
+        {
+            pLogger->Write(message);
+            unflushed = true;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (flushRequested || stop || (unflushed && now - lastFlush >= pLogger->m_flushInterval))
+        {
+            pLogger->FlushLoggers();
+            unflushed = false;
+            lastFlush = now;
+        }
+
+        lock.lock();
+        if (flushRequested)
+        {
+            pLogger->m_flushesDone = flushesRequested;
+            pLogger->m_flushedConditional.notify_all();
+        }
+
+        if (stop)
+        {
+            break;
+        }
+
+        if (pLogger->m_stop || pLogger->m_flushesRequested != flushesRequested)
+        {
+            continue;
+        }
+
+        pLogger->m_writerSleeping = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (pLogger->m_pQueue->GetDepth() == 0)
+        {
+            if (unflushed)
+            {
+                pLogger->m_writerConditional.wait_until(lock, lastFlush + pLogger->m_flushInterval);
+            }
+            else
+            {
+                pLogger->m_writerConditional.wait(lock);
+            }
+        }
+
+        pLogger->m_writerSleeping = false;
     }
+}
 
-    return LoggerAPI::LogLevel::NONE;
+LoggerAPI::LogLevel Logger::GetLogLevel(const LoggerAPI::LogFile file) const noexcept
+{
+    return LogLevels::ToLevel(GetLevels().GetDefault(file));
 }
 
 void Logger::Flush()
 {
-    if (m_pNodeLogger != nullptr)
+    if (m_pQueue != nullptr)
     {
-        m_pNodeLogger->flush();
+        std::unique_lock<std::mutex> lock(m_writerMutex);
+        const uint64_t flush = ++m_flushesRequested;
+        m_writerConditional.notify_one();
+        m_flushedConditional.wait(lock, [this, flush] { return m_flushesDone >= flush; });
+        return;
     }
 
-    if (m_pWalletLogger != nullptr)
+    FlushLoggers();
+}
+
+void Logger::FlushLoggers() noexcept
+{
+    try
     {
-        m_pWalletLogger->flush();
+        if (m_pNodeLogger != nullptr)
+        {
+            m_pNodeLogger->flush();
+        }
+
+        if (m_pWalletLogger != nullptr)
+        {
+            m_pWalletLogger->flush();
+        }
+    }
+    catch (std::exception&)
+    {
+        // Logger failure should not disrupt program flow
+    }
+}
+
+LoggerAPI::Stats Logger::GetStats() const noexcept
+{
+    LoggerAPI::Stats stats({ 0, m_numWritten, 0, 0 });
+    if (m_pQueue != nullptr)
+    {
+        stats.numDropped = m_pQueue->GetNumDropped();
+        stats.queueDepth = m_pQueue->GetDepth();
+        stats.maxQueueDepth = m_pQueue->GetMaxDepth();
     }
+
+    return stats;
 }
 
 std::shared_ptr<spdlog::logger> Logger::GetLogger(const LoggerAPI::LogFile file) noexcept
@@ -162,31 +314,59 @@ std::shared_ptr<const spdlog::logger> Logger::GetLogger(const LoggerAPI::LogFile
 
 namespace LoggerAPI
 {
-    LOGGER_API void Initialize(const std::string& logDirectory, const std::string& logLevel)
+    static LogLevel ParseLogLevel(const std::string& logLevel) noexcept
     {
-        spdlog::level::level_enum logLevelEnum = spdlog::level::level_enum::debug;
         if (logLevel == "TRACE")
         {
-            logLevelEnum = spdlog::level::level_enum::trace;
-        }
-        else if (logLevel == "DEBUG")
-        {
-            logLevelEnum = spdlog::level::level_enum::debug;
+            return LogLevel::TRACE;
         }
         else if (logLevel == "INFO")
         {
-            logLevelEnum = spdlog::level::level_enum::info;
+            return LogLevel::INFO;
         }
         else if (logLevel == "WARN")
         {
-            logLevelEnum = spdlog::level::level_enum::warn;
+            return LogLevel::WARN;
         }
         else if (logLevel == "ERROR")
         {
-            logLevelEnum = spdlog::level::level_enum::err;
+            return LogLevel::ERR;
+        }
+        else if (logLevel == "NONE")
+        {
+            return LogLevel::NONE;
         }
 
-        Logger::GetInstance().StartLogger(logDirectory, logLevelEnum);
+        return LogLevel::DEBUG;
+    }
+
+    LOGGER_API void Initialize(const FilePath& logDirectory, const std::string& logLevel, const Options& options)
+    {
+        Logger::GetInstance().StartLogger(logDirectory, options);
+
+        // "INFO,DB=TRACE" sets every module to INFO, except DB. Without a level for every module, it's DEBUG.
+        std::vector<std::pair<std::string, LogLevel>> moduleLevels({ { "", LogLevel::DEBUG } });
+
+        std::stringstream levels(logLevel);
+        std::string level;
+        while (std::getline(levels, level, ','))
+        {
+            const size_t separator = level.find('=');
+            if (separator == std::string::npos)
+            {
+                moduleLevels.front().second = ParseLogLevel(level);
+            }
+            else
+            {
+                moduleLevels.push_back({ level.substr(0, separator), ParseLogLevel(level.substr(separator + 1)) });
+            }
+        }
+
+        for (const auto& moduleLevel : moduleLevels)
+        {
+            SetLogLevel(LogFile::NODE, moduleLevel.first, moduleLevel.second);
+            SetLogLevel(LogFile::WALLET, moduleLevel.first, moduleLevel.second);
+        }
     }
 
     LOGGER_API void Flush()
@@ -194,19 +374,39 @@ namespace LoggerAPI
         Logger::GetInstance().Flush();
     }
 
+    LOGGER_API Stats GetStats() noexcept
+    {
+        return Logger::GetInstance().GetStats();
+    }
+
     LOGGER_API LogLevel GetLogLevel(const LogFile file) noexcept
     {
         return Logger::GetInstance().GetLogLevel(file);
     }
 
+    LOGGER_API void SetLogLevel(const LogFile file, const std::string& module, const LogLevel logLevel)
+    {
+        Logger::GetLevels().SetLevel(file, module, logLevel);
+    }
+
+    LOGGER_API void ClearLogLevel(const LogFile file, const std::string& module)
+    {
+        Logger::GetLevels().ClearLevel(file, module);
+    }
+
+    LOGGER_API const std::atomic<uint8_t>& GetThreshold(const LogFile file, const char* module)
+    {
+        return Logger::GetLevels().GetThreshold(file, module);
+    }
+
     LOGGER_API void Log(
         const LogFile file,
         const LogLevel logLevel,
+        const std::atomic<uint8_t>& threshold,
         const std::string& function,
         const size_t line,
         const std::string& message) noexcept
     {
-        const std::string formatted = function + "(" + std::to_string(line) + ") - " + message;
-        Logger::GetInstance().Log(file, logLevel, formatted);
+        Logger::GetInstance().Log(file, logLevel, threshold, function, line, message);
     }
 }
\ No newline at end of file
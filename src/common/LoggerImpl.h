@@ -1,36 +1,79 @@
 #pragma once
 
+#include "LogLevels.h"
+#include "LogQueue.h"
+
 #include <spdlog/spdlog.h>
 #include <mw/core/common/Logger.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 class Logger
 {
 public:
     static Logger& GetInstance();
 
+    //
+    // Outlives the logger, since logging statements keep references to their thresholds.
+    //
+    static LogLevels& GetLevels();
+
+    ~Logger();
+
     void StartLogger(
         const FilePath& logDirectory,
-        const spdlog::level::level_enum& logLevel
+        const LoggerAPI::Options& options
     );
 
     void Log(
         const LoggerAPI::LogFile file,
         const LoggerAPI::LogLevel logLevel,
-        const std::string& eventText
+        const std::atomic<uint8_t>& threshold,
+        const std::string& function,
+        const size_t line,
+        const std::string& message
     ) noexcept;
 
     LoggerAPI::LogLevel GetLogLevel(const LoggerAPI::LogFile file) const noexcept;
     void Flush();
+    LoggerAPI::Stats GetStats() const noexcept;
 
 private:
-    Logger() = default;
+    Logger() : m_stop(false), m_writerSleeping(false), m_flushesRequested(0), m_flushesDone(0), m_numWritten(0) { }
+
+    void Write(const LogMessage& message) noexcept;
+    void WakeWriter();
+    void FlushLoggers() noexcept;
+    static void Writer(Logger* pLogger);
 
     std::shared_ptr<spdlog::logger> GetLogger(const LoggerAPI::LogFile file) noexcept;
     std::shared_ptr<const spdlog::logger> GetLogger(const LoggerAPI::LogFile file) const noexcept;
 
     static spdlog::level::level_enum Convert(LoggerAPI::LogLevel logLevel) noexcept;
-    static LoggerAPI::LogLevel Convert(spdlog::level::level_enum  logLevel) noexcept;
 
     std::shared_ptr<spdlog::logger> m_pNodeLogger;
     std::shared_ptr<spdlog::logger> m_pWalletLogger;
+
+    // Only set in async mode.
+    std::unique_ptr<LogQueue> m_pQueue;
+    std::thread m_writer;
+    std::chrono::milliseconds m_flushInterval;
+
+    // Wakes the writer when messages are queued while it sleeps, a flush is requested, or the logger stops.
+    std::mutex m_writerMutex;
+    std::condition_variable m_writerConditional;
+    bool m_stop;
+    std::atomic_bool m_writerSleeping;
+
+    // Flush() waits for the writer to finish a pass that started after it asked.
+    std::condition_variable m_flushedConditional;
+    uint64_t m_flushesRequested;
+    uint64_t m_flushesDone;
+
+    std::atomic<uint64_t> m_numWritten;
 };
\ No newline at end of file
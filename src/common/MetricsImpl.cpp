@@ -0,0 +1,204 @@
+#include <mw/core/common/Metrics.h>
+
+#include <cassert>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <utility>
+
+//
+// Metrics are grouped into families by name, so each name's HELP and TYPE are written once, ahead of its label sets.
+//
+class MetricsRegistry
+{
+public:
+    static MetricsRegistry& GetInstance()
+    {
+        // Never destroyed, since callers keep references to the metrics.
+        static MetricsRegistry* pRegistry = new MetricsRegistry();
+        return *pRegistry;
+    }
+
+    Counter& GetCounter(const std::string& name, const std::string& help, const std::string& labels)
+    {
+        return Get(m_counters, EType::COUNTER, name, help, labels);
+    }
+
+    Gauge& GetGauge(const std::string& name, const std::string& help, const std::string& labels)
+    {
+        return Get(m_gauges, EType::GAUGE, name, help, labels);
+    }
+
+    Histogram& GetHistogram(const std::string& name, const std::string& help, const std::string& labels)
+    {
+        return Get(m_histograms, EType::HISTOGRAM, name, help, labels);
+    }
+
+    std::string Render() const
+    {
+        std::ostringstream stream;
+        stream << std::setprecision(9);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (const auto& family : m_families)
+        {
+            const std::string& name = family.first;
+            stream << "# HELP " << name << " " << family.second.help << "\n";
+
+            switch (family.second.type)
+            {
+                case EType::COUNTER:
+                {
+                    stream << "# TYPE " << name << " counter\n";
+                    for (const auto& counter : m_counters.at(name))
+                    {
+                        stream << name << FormatLabels(counter.first) << " " << counter.second->GetValue() << "\n";
+                    }
+                    break;
+                }
+                case EType::GAUGE:
+                {
+                    stream << "# TYPE " << name << " gauge\n";
+                    for (const auto& gauge : m_gauges.at(name))
+                    {
+                        stream << name << FormatLabels(gauge.first) << " " << gauge.second->GetValue() << "\n";
+                    }
+                    break;
+                }
+                case EType::HISTOGRAM:
+                {
+                    stream << "# TYPE " << name << " summary\n";
+                    for (const auto& histogram : m_histograms.at(name))
+                    {
+                        const std::string& labels = histogram.first;
+                        const Histogram::Snapshot snapshot = histogram.second->GetSnapshot();
+                        for (const auto& quantile : QUANTILES)
+                        {
+                            const std::string quantileLabel = std::string("quantile=\"") + quantile.first + "\"";
+                            stream << name << FormatLabels(labels.empty() ? quantileLabel : labels + "," + quantileLabel) << " "
+                                << ToSeconds(snapshot.GetQuantile(quantile.second)) << "\n";
+                        }
+
+                        stream << name << "_sum" << FormatLabels(labels) << " " << ToSeconds(snapshot.sum) << "\n";
+                        stream << name << "_count" << FormatLabels(labels) << " " << snapshot.count << "\n";
+                    }
+                    break;
+                }
+            }
+        }
+
+        return stream.str();
+    }
+
+private:
+    enum class EType
+    {
+        COUNTER,
+        GAUGE,
+        HISTOGRAM
+    };
+
+    static constexpr std::pair<const char*, double> QUANTILES[] = {
+        { "0.5", 0.5 }, { "0.9", 0.9 }, { "0.99", 0.99 }, { "0.999", 0.999 }
+    };
+
+    struct Family
+    {
+        EType type;
+        std::string help;
+    };
+
+    template<typename T>
+    using Metrics = std::map<std::string, std::map<std::string, std::unique_ptr<T>>>;
+
+    template<typename T>
+    T& Get(Metrics<T>& metrics, const EType type, const std::string& name, const std::string& help, const std::string& labels)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        auto iter = m_families.find(name);
+        if (iter == m_families.end())
+        {
+            m_families.insert({ name, Family({ type, help }) });
+        }
+        else
+        {
+            // A name can only be used for one type of metric.
+            assert(iter->second.type == type);
+        }
+
+        std::unique_ptr<T>& pMetric = metrics[name][labels];
+        if (pMetric == nullptr)
+        {
+            pMetric = std::make_unique<T>();
+        }
+
+        return *pMetric;
+    }
+
+    static std::string FormatLabels(const std::string& labels)
+    {
+        return labels.empty() ? std::string() : "{" + labels + "}";
+    }
+
+    static double ToSeconds(const uint64_t nanoseconds) noexcept
+    {
+        return (double)nanoseconds / 1'000'000'000;
+    }
+
+    mutable std::mutex m_mutex;
+    std::map<std::string, Family> m_families;
+    Metrics<Counter> m_counters;
+    Metrics<Gauge> m_gauges;
+    Metrics<Histogram> m_histograms;
+};
+
+namespace MetricsAPI
+{
+    METRICS_API std::string FormatLabel(const std::string& name, const std::string& value)
+    {
+        std::string label = name + "=\"";
+        for (const char c : value)
+        {
+            switch (c)
+            {
+                case '\\':
+                    label += "\\\\";
+                    break;
+                case '"':
+                    label += "\\\"";
+                    break;
+                case '\n':
+                    label += "\\n";
+                    break;
+                default:
+                    label += c;
+                    break;
+            }
+        }
+
+        return label + "\"";
+    }
+
+    METRICS_API Counter& GetCounter(const std::string& name, const std::string& help, const std::string& labels)
+    {
+        return MetricsRegistry::GetInstance().GetCounter(name, help, labels);
+    }
+
+    METRICS_API Gauge& GetGauge(const std::string& name, const std::string& help, const std::string& labels)
+    {
+        return MetricsRegistry::GetInstance().GetGauge(name, help, labels);
+    }
+
+    METRICS_API Histogram& GetHistogram(const std::string& name, const std::string& help, const std::string& labels)
+    {
+        return MetricsRegistry::GetInstance().GetHistogram(name, help, labels);
+    }
+
+    METRICS_API std::string Render()
+    {
+        return MetricsRegistry::GetInstance().Render();
+    }
+};
\ No newline at end of file
@@ -1,51 +1,137 @@
 #include "ThreadManagerImpl.h"
 
-#include <mw/core/common/ThreadManager.h>
+#include <mw/core/common/Logger.h>
+#include <mw/core/util/StringUtil.h>
 #include <sstream>
 
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
+
 ThreadManager& ThreadManager::GetInstance()
 {
-    static ThreadManager threadManager;
-    return threadManager;
+    // Never destroyed, since threads may still exit, or log, while the process exits.
+    static ThreadManager* pThreadManager = new ThreadManager();
+    return *pThreadManager;
 }
 
-std::string ThreadManager::GetCurrentThreadName() const noexcept
+ThreadManager::CachedName::~CachedName()
 {
-    std::shared_lock<std::shared_mutex> readLock(m_threadNamesMutex);
+    if (generation != 0)
+    {
+        ThreadManager& threadManager = ThreadManager::GetInstance();
+        std::unique_lock<std::shared_mutex> lockGuard(threadManager.m_threadNamesMutex);
+        threadManager.m_threadNamesById.erase(std::this_thread::get_id());
+    }
+}
 
-    std::thread::id threadId = std::this_thread::get_id();
+ThreadManager::CachedName& ThreadManager::GetCachedName() noexcept
+{
+    static thread_local CachedName cachedName;
+    return cachedName;
+}
 
-    if (m_threadNamesById.find(threadId) != m_threadNamesById.end())
+const std::string& ThreadManager::GetCurrentThreadName() const noexcept
+{
+    CachedName& cachedName = GetCachedName();
+
+    const uint64_t generation = m_generation.load(std::memory_order_acquire);
+    if (cachedName.generation != generation)
     {
-        return m_threadNamesById.find(threadId)->second;
+        std::shared_lock<std::shared_mutex> readLock(m_threadNamesMutex);
+
+        std::thread::id threadId = std::this_thread::get_id();
+
+        auto iter = m_threadNamesById.find(threadId);
+        if (iter != m_threadNamesById.end())
+        {
+            cachedName.name = iter->second;
+        }
+        else
+        {
+            std::stringstream ss;
+            ss << "[THREAD:" << threadId << "]";
+            cachedName.name = ss.str();
+        }
+
+        cachedName.generation = generation;
     }
 
-    std::stringstream ss;
-    ss << "[THREAD:" << threadId << "]";
-    return ss.str();
+    return cachedName.name;
 }
 
 void ThreadManager::SetThreadName(const std::thread::id& threadId, const std::string& threadName)
 {
-    std::unique_lock<std::shared_mutex> lockGuard(m_threadNamesMutex);
+    {
+        std::unique_lock<std::shared_mutex> lockGuard(m_threadNamesMutex);
+        m_threadNamesById[threadId] = FormatName(threadName, threadId);
+    }
 
-    std::stringstream ss;
-    ss << "[" << threadName << ":" << threadId << "]";
-    m_threadNamesById[threadId] = ss.str();
+    m_generation.fetch_add(1, std::memory_order_release);
 }
 
 void ThreadManager::SetCurrentThreadName(const std::string& threadName)
 {
-    std::unique_lock<std::shared_mutex> lockGuard(m_threadNamesMutex);
+    // Read first, so a name set for this thread by another thread in the meantime is picked up on the next read.
+    const uint64_t generation = m_generation.load(std::memory_order_acquire);
+    const std::string name = FormatName(threadName, std::this_thread::get_id());
 
+    {
+        std::unique_lock<std::shared_mutex> lockGuard(m_threadNamesMutex);
+        m_threadNamesById[std::this_thread::get_id()] = name;
+    }
+
+    CachedName& cachedName = GetCachedName();
+    cachedName.name = name;
+    cachedName.generation = generation;
+}
+
+void ThreadManager::InitializeCurrentThread(const ThreadManagerAPI::ThreadOptions& options)
+{
+    SetCurrentThreadName(options.name);
+
+#if defined(_WIN32)
+    SetThreadDescription(GetCurrentThread(), StringUtil::ToWide(options.name).c_str());
+
+    if (options.cpuOpt.has_value() && SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << options.cpuOpt.value()) == 0)
+    {
+        LOG_WARNING_F("Failed to pin {} to CPU {}", options.name, options.cpuOpt.value());
+    }
+#elif defined(__APPLE__)
+    pthread_setname_np(options.name.substr(0, 63).c_str());
+
+    // macOS has no way to pin a thread to a CPU.
+    if (options.cpuOpt.has_value())
+    {
+        LOG_DEBUG_F("Not pinning {} to CPU {}", options.name, options.cpuOpt.value());
+    }
+#else
+    pthread_setname_np(pthread_self(), options.name.substr(0, 15).c_str());
+
+    if (options.cpuOpt.has_value())
+    {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(options.cpuOpt.value(), &cpuSet);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) != 0)
+        {
+            LOG_WARNING_F("Failed to pin {} to CPU {}", options.name, options.cpuOpt.value());
+        }
+    }
+#endif
+}
+
+std::string ThreadManager::FormatName(const std::string& threadName, const std::thread::id& threadId)
+{
     std::stringstream ss;
-    ss << "[" << threadName << ":" << std::this_thread::get_id() << "]";
-    m_threadNamesById[std::this_thread::get_id()] = ss.str();
+    ss << "[" << threadName << ":" << threadId << "]";
+    return ss.str();
 }
 
 namespace ThreadManagerAPI
 {
-    // Future: Implement a CreateThread method that takes the name, function, and parameters.
     THREAD_MANAGER_API std::string GetCurrentThreadName()
     {
         return ThreadManager::GetInstance().GetCurrentThreadName();
@@ -60,4 +146,9 @@ namespace ThreadManagerAPI
     {
         ThreadManager::GetInstance().SetCurrentThreadName(threadName);
     }
+
+    THREAD_MANAGER_API void InitializeCurrentThread(const ThreadOptions& options)
+    {
+        ThreadManager::GetInstance().InitializeCurrentThread(options);
+    }
 };
\ No newline at end of file
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <mw/core/common/ThreadManager.h>
+
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -10,12 +14,35 @@ class ThreadManager
 public:
     static ThreadManager& GetInstance();
 
-    // Future: Implement a CreateThread method that takes the name, function, and parameters.
-    std::string GetCurrentThreadName() const noexcept;
+    const std::string& GetCurrentThreadName() const noexcept;
     void SetThreadName(const std::thread::id& threadId, const std::string& threadName);
     void SetCurrentThreadName(const std::string& threadName);
+    void InitializeCurrentThread(const ThreadManagerAPI::ThreadOptions& options);
 
 private:
+    ThreadManager() : m_generation(1) { }
+
+    //
+    // The current thread's copy of its name.
+    // It's refreshed from m_threadNamesById whenever m_generation moves past the generation it was read at.
+    // When the thread exits, its name is removed, since a later thread may be given the same id.
+    //
+    struct CachedName
+    {
+        ~CachedName();
+
+        // 0 until the name is first read.
+        uint64_t generation = 0;
+        std::string name;
+    };
+
+    static CachedName& GetCachedName() noexcept;
+
+    static std::string FormatName(const std::string& threadName, const std::thread::id& threadId);
+
+    // Bumped after every change to m_threadNamesById.
+    std::atomic<uint64_t> m_generation;
+
     mutable std::shared_mutex m_threadNamesMutex;
     std::unordered_map<std::thread::id, std::string> m_threadNamesById;
 };
\ No newline at end of file
@@ -0,0 +1,10 @@
+#include <mw/core/common/ThreadPool.h>
+
+namespace ThreadPoolAPI
+{
+    THREAD_POOL_API ThreadPool& GetDefaultPool()
+    {
+        static ThreadPool::Ptr pPool = ThreadPool::Create(std::max<size_t>(std::thread::hardware_concurrency(), 1));
+        return *pPool;
+    }
+};
\ No newline at end of file
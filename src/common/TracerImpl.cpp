@@ -0,0 +1,293 @@
+#include "TracerImpl.h"
+#include "ThreadManagerImpl.h"
+
+#include <mw/core/exceptions/FileException.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+TraceBuffers& TraceBuffers::GetInstance()
+{
+    // Never destroyed, since threads may still record while the process exits.
+    static TraceBuffers* pInstance = new TraceBuffers();
+    return *pInstance;
+}
+
+TraceBuffers::ThreadBuffer::~ThreadBuffer()
+{
+    if (pBuffer != nullptr)
+    {
+        TraceBuffers& buffers = TraceBuffers::GetInstance();
+        std::unique_lock<std::mutex> lock(buffers.m_mutex);
+        buffers.m_free.push_back(pBuffer);
+    }
+}
+
+TraceBuffers::Buffer& TraceBuffers::GetThreadBuffer()
+{
+    static thread_local ThreadBuffer threadBuffer;
+    if (threadBuffer.pBuffer == nullptr)
+    {
+        const std::string threadName = ThreadManager::GetInstance().GetCurrentThreadName();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_free.empty())
+        {
+            m_buffers.push_back(std::make_unique<Buffer>());
+            m_free.push_back(m_buffers.back().get());
+        }
+
+        Buffer* pBuffer = m_free.back();
+        m_free.pop_back();
+
+        // The buffer is unowned, so its head is stable.
+        const uint64_t head = pBuffer->head.load(std::memory_order_relaxed);
+        pBuffer->threadId = m_nextThreadId++;
+        pBuffer->owners.push_back(Owner({ head, pBuffer->threadId, threadName }));
+
+        // Forget the earlier owners whose events have all been overwritten.
+        while (pBuffer->owners.size() > 1 && pBuffer->owners[1].begin + BUFFER_SIZE <= head)
+        {
+            pBuffer->owners.pop_front();
+        }
+
+        threadBuffer.pBuffer = pBuffer;
+    }
+
+    return *threadBuffer.pBuffer;
+}
+
+void TraceBuffers::Record(const ETraceEvent event, const ETracePhase phase, const uint64_t payload1, const uint64_t payload2) noexcept
+{
+    try
+    {
+        Buffer& buffer = GetThreadBuffer();
+
+        TraceRecord record;
+        record.timestamp = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+        record.payload1 = payload1;
+        record.payload2 = payload2;
+        record.threadId = buffer.threadId;
+        record.event = event;
+        record.phase = phase;
+        record.reserved = 0;
+
+        uint64_t words[WORDS_PER_RECORD];
+        std::memcpy(words, &record, sizeof(TraceRecord));
+
+        // Pairs with the fence in Collect(), so a reader that sees any of these words also sees the head
+        // that was published before the slot was overwritten, and drops the slot.
+        const uint64_t index = buffer.head.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        Slot& slot = buffer.slots[index % BUFFER_SIZE];
+        for (size_t i = 0; i < WORDS_PER_RECORD; i++)
+        {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        buffer.head.store(index + 1, std::memory_order_release);
+    }
+    catch (std::exception&)
+    {
+        // Tracing failure should not disrupt program flow
+    }
+}
+
+TraceDump TraceBuffers::Collect()
+{
+    TraceDump dump;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (const auto& pBuffer : m_buffers)
+    {
+        for (const Owner& owner : pBuffer->owners)
+        {
+            dump.threads.push_back({ owner.threadId, owner.name });
+        }
+
+        const uint64_t head = pBuffer->head.load(std::memory_order_acquire);
+        const uint64_t begin = head > BUFFER_SIZE ? head - BUFFER_SIZE : 0;
+
+        std::vector<TraceRecord> records(head - begin);
+        for (uint64_t i = begin; i < head; i++)
+        {
+            const Slot& slot = pBuffer->slots[i % BUFFER_SIZE];
+
+            uint64_t words[WORDS_PER_RECORD];
+            for (size_t w = 0; w < WORDS_PER_RECORD; w++)
+            {
+                words[w] = slot.words[w].load(std::memory_order_relaxed);
+            }
+
+            std::memcpy(&records[i - begin], words, sizeof(TraceRecord));
+        }
+
+        // The owner keeps recording while we copy. Any slot it reached may have been torn, so those are dropped.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t headAfter = pBuffer->head.load(std::memory_order_relaxed);
+        const uint64_t firstValid = headAfter >= BUFFER_SIZE ? headAfter - BUFFER_SIZE + 1 : 0;
+        for (uint64_t i = std::max(begin, firstValid); i < head; i++)
+        {
+            dump.records.push_back(records[i - begin]);
+        }
+    }
+
+    std::sort(
+        dump.records.begin(), dump.records.end(),
+        [](const TraceRecord& lhs, const TraceRecord& rhs) { return lhs.timestamp < rhs.timestamp; }
+    );
+
+    return dump;
+}
+
+namespace TracerAPI
+{
+    // "MWTR"
+    static constexpr uint32_t TRACE_MAGIC = 0x5254574d;
+    static constexpr uint32_t TRACE_VERSION = 1;
+
+    template<typename T>
+    static void WriteValue(std::ofstream& stream, const T& value)
+    {
+        stream.write((const char*)&value, sizeof(T));
+    }
+
+    template<typename T>
+    static T ReadValue(std::ifstream& stream)
+    {
+        T value;
+        stream.read((char*)&value, sizeof(T));
+        return value;
+    }
+
+    TRACER_API void SetEnabled(const bool enabled) noexcept
+    {
+        TraceBuffers::GetInstance().SetEnabled(enabled);
+    }
+
+    TRACER_API const std::atomic_bool& GetEnabledFlag() noexcept
+    {
+        return TraceBuffers::GetInstance().GetEnabledFlag();
+    }
+
+    TRACER_API void Record(const ETraceEvent event, const ETracePhase phase, const uint64_t payload1, const uint64_t payload2) noexcept
+    {
+        TraceBuffers::GetInstance().Record(event, phase, payload1, payload2);
+    }
+
+    TRACER_API TraceDump Collect()
+    {
+        return TraceBuffers::GetInstance().Collect();
+    }
+
+    //
+    // The file is the magic and version, the thread names, then the records as they are in memory.
+    //
+    TRACER_API void Dump(const FilePath& path)
+    {
+        const TraceDump dump = Collect();
+
+        std::ofstream stream(path.ToPath(), std::ios::binary | std::ios::trunc);
+        if (!stream.is_open())
+        {
+            ThrowFile_F("Failed to open {}", path);
+        }
+
+        WriteValue<uint32_t>(stream, TRACE_MAGIC);
+        WriteValue<uint32_t>(stream, TRACE_VERSION);
+
+        WriteValue<uint32_t>(stream, (uint32_t)dump.threads.size());
+        for (const auto& thread : dump.threads)
+        {
+            WriteValue<uint32_t>(stream, thread.first);
+            WriteValue<uint32_t>(stream, (uint32_t)thread.second.size());
+            stream.write(thread.second.data(), thread.second.size());
+        }
+
+        WriteValue<uint64_t>(stream, dump.records.size());
+        stream.write((const char*)dump.records.data(), dump.records.size() * sizeof(TraceRecord));
+
+        stream.close();
+        if (stream.fail())
+        {
+            ThrowFile_F("Failed to write {}", path);
+        }
+    }
+
+    TRACER_API TraceDump Load(const FilePath& path)
+    {
+        std::ifstream stream(path.ToPath(), std::ios::binary);
+        if (!stream.is_open())
+        {
+            ThrowFile_F("Failed to open {}", path);
+        }
+
+        if (ReadValue<uint32_t>(stream) != TRACE_MAGIC || ReadValue<uint32_t>(stream) != TRACE_VERSION)
+        {
+            ThrowFile_F("{} is not a trace file", path);
+        }
+
+        TraceDump dump;
+        const uint32_t numThreads = ReadValue<uint32_t>(stream);
+        for (uint32_t i = 0; i < numThreads && stream.good(); i++)
+        {
+            const uint32_t threadId = ReadValue<uint32_t>(stream);
+            std::string name(ReadValue<uint32_t>(stream), '\0');
+            stream.read(&name[0], name.size());
+            dump.threads.push_back({ threadId, std::move(name) });
+        }
+
+        const uint64_t numRecords = ReadValue<uint64_t>(stream);
+        if (!stream.good())
+        {
+            ThrowFile_F("{} is truncated", path);
+        }
+
+        dump.records.resize(numRecords);
+        stream.read((char*)dump.records.data(), numRecords * sizeof(TraceRecord));
+        if (stream.gcount() != (std::streamsize)(numRecords * sizeof(TraceRecord)))
+        {
+            ThrowFile_F("{} is truncated", path);
+        }
+
+        return dump;
+    }
+
+    TRACER_API std::string GetEventName(const ETraceEvent event) noexcept
+    {
+        switch (event)
+        {
+            case ETraceEvent::MMR_APPEND:
+                return "MMR_APPEND";
+            case ETraceEvent::MMR_REWIND:
+                return "MMR_REWIND";
+            case ETraceEvent::VERIFY_RANGE_PROOFS:
+                return "VERIFY_RANGE_PROOFS";
+            case ETraceEvent::VERIFY_KERNEL_SIGS:
+                return "VERIFY_KERNEL_SIGS";
+            case ETraceEvent::DB_GET:
+                return "DB_GET";
+            case ETraceEvent::DB_MULTI_GET:
+                return "DB_MULTI_GET";
+            case ETraceEvent::DB_PUT:
+                return "DB_PUT";
+            case ETraceEvent::DB_DELETE:
+                return "DB_DELETE";
+            case ETraceEvent::DB_GROUP_WRITE:
+                return "DB_GROUP_WRITE";
+            case ETraceEvent::DB_COMMIT:
+                return "DB_COMMIT";
+            case ETraceEvent::JOURNAL_COMMIT:
+                return "JOURNAL_COMMIT";
+            case ETraceEvent::BLOCK_DB_COMMIT:
+                return "BLOCK_DB_COMMIT";
+        }
+
+        return "EVENT_" + std::to_string((uint16_t)event);
+    }
+}
\ No newline at end of file
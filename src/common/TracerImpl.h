@@ -0,0 +1,92 @@
+#pragma once
+
+#include <mw/core/common/Tracer.h>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//
+// Owns the per-thread ring buffers.
+//
+// A thread takes a buffer on its first event, and gives it back when it exits, so the next new thread reuses it.
+// The events a finished thread recorded stay in the buffer until they're overwritten, so they still show up in dumps.
+// A thread's name is kept only as long as some of its events are, so threads that come and go don't leak names.
+//
+// The owner writes records while Collect() copies them, so records are stored as relaxed atomic words, like a seqlock:
+// the owner fences before overwriting a slot, and Collect() re-reads the head afterwards to drop any slot it reached.
+//
+class TraceBuffers
+{
+public:
+    // Per thread. 256KB, or about 8 thousand events.
+    static constexpr size_t BUFFER_SIZE = 8192;
+
+    static TraceBuffers& GetInstance();
+
+    const std::atomic_bool& GetEnabledFlag() const noexcept { return m_enabled; }
+    void SetEnabled(const bool enabled) noexcept { m_enabled = enabled; }
+
+    void Record(const ETraceEvent event, const ETracePhase phase, const uint64_t payload1, const uint64_t payload2) noexcept;
+
+    TraceDump Collect();
+
+private:
+    static constexpr size_t WORDS_PER_RECORD = sizeof(TraceRecord) / sizeof(uint64_t);
+
+    struct Slot
+    {
+        std::atomic<uint64_t> words[WORDS_PER_RECORD];
+    };
+
+    //
+    // A thread that has owned the buffer, and whose events may still be in it.
+    //
+    struct Owner
+    {
+        // Index of the owner's first record.
+        uint64_t begin;
+        uint32_t threadId;
+        std::string name;
+    };
+
+    struct Buffer
+    {
+        Buffer() : threadId(0), head(0), slots(new Slot[BUFFER_SIZE]) { }
+
+        // Only changed while no thread owns the buffer.
+        uint32_t threadId;
+
+        // Index of the next record. Only written by the owning thread.
+        std::atomic<uint64_t> head;
+        std::unique_ptr<Slot[]> slots;
+
+        // Oldest first. Guarded by TraceBuffers::m_mutex.
+        std::deque<Owner> owners;
+    };
+
+    //
+    // Returns the buffer to the free list when its thread exits.
+    //
+    struct ThreadBuffer
+    {
+        ~ThreadBuffer();
+
+        Buffer* pBuffer = nullptr;
+    };
+
+    TraceBuffers() : m_enabled(false), m_nextThreadId(1) { }
+
+    Buffer& GetThreadBuffer();
+
+    std::atomic_bool m_enabled;
+
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<Buffer>> m_buffers;
+    std::vector<Buffer*> m_free;
+    uint32_t m_nextThreadId;
+};
\ No newline at end of file
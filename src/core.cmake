@@ -17,4 +17,5 @@ add_subdirectory(${CMAKE_CURRENT_LIST_DIR}/file ${BUILD_DIR}/core/file)
 add_subdirectory(${CMAKE_CURRENT_LIST_DIR}/mmr ${BUILD_DIR}/core/mmr)
 add_subdirectory(${CMAKE_CURRENT_LIST_DIR}/net ${BUILD_DIR}/core/net)
 add_subdirectory(${CMAKE_CURRENT_LIST_DIR}/crypto ${BUILD_DIR}/core/crypto)
-add_subdirectory(${CMAKE_CURRENT_LIST_DIR}/traits ${BUILD_DIR}/core/traits)
\ No newline at end of file
+add_subdirectory(${CMAKE_CURRENT_LIST_DIR}/traits ${BUILD_DIR}/core/traits)
+add_subdirectory(${CMAKE_CURRENT_LIST_DIR}/tools ${BUILD_DIR}/core/tools)
\ No newline at end of file
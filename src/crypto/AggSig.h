@@ -70,5 +70,5 @@ public:
     ) const;
 
 private:
-    Locked<Context> m_context;
+    Locked<Context>& m_context;
 };
\ No newline at end of file
@@ -34,7 +34,7 @@ public:
     ) const;
 
 private:
-    Locked<Context> m_context;
+    Locked<Context>& m_context;
 
     secp256k1_bulletproof_generators* m_pGenerators;
     mutable BulletProofsCache m_cache;
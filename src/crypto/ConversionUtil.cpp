@@ -115,6 +115,23 @@ std::vector<secp256k1_pedersen_commitment> ConversionUtil::ToSecp256k1(const std
     return out;
 }
 
+std::vector<secp256k1_pedersen_commitment> ConversionUtil::ToSecp256k1(const std::vector<const Commitment*>& commitments) const
+{
+    static const Commitment ZERO_COMMITMENT(BigInt<33>::ValueOf(0));
+
+    std::vector<secp256k1_pedersen_commitment> out;
+    out.reserve(commitments.size());
+    for (const Commitment* pCommitment : commitments)
+    {
+        if (*pCommitment != ZERO_COMMITMENT)
+        {
+            out.push_back(ToSecp256k1(*pCommitment));
+        }
+    }
+
+    return out;
+}
+
 secp256k1_ecdsa_signature ConversionUtil::ToSecp256k1(const CompactSignature& signature) const
 {
     secp256k1_ecdsa_signature secpSig;
@@ -22,6 +22,9 @@ public:
     secp256k1_pedersen_commitment ToSecp256k1(const Commitment& commitment) const;
     std::vector<secp256k1_pedersen_commitment> ToSecp256k1(const std::vector<Commitment>& commitments) const;
 
+    // Parses each non-zero commitment. Zero commitments are skipped, since they can't be parsed.
+    std::vector<secp256k1_pedersen_commitment> ToSecp256k1(const std::vector<const Commitment*>& commitments) const;
+
     secp256k1_ecdsa_signature ToSecp256k1(const CompactSignature& signature) const;
     std::vector<secp256k1_ecdsa_signature> ToSecp256k1(const std::vector<CompactSignature>& signatures) const;
 
@@ -29,5 +32,5 @@ public:
     std::vector<secp256k1_schnorrsig> ToSecp256k1(const std::vector<const Signature*>& signatures) const;
 
 private:
-    Locked<Context> m_context;
+    const Locked<Context>& m_context;
 };
\ No newline at end of file
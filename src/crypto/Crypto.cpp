@@ -1,6 +1,9 @@
 #include <mw/core/crypto/Crypto.h>
 #include <mw/core/exceptions/CryptoException.h>
 #include <mw/core/common/Logger.h>
+#include <mw/core/common/Metrics.h>
+#include <mw/core/common/ThreadPool.h>
+#include <mw/core/common/Tracer.h>
 
 #include <Crypto/Blake2.h>
 #include <Crypto/sha256.h>
@@ -10,6 +13,7 @@
 #include <Crypto/aes.h>
 #include <Crypto/siphash.h>
 #include <Crypto/crypto_scrypt.h>
+#include <atomic>
 #include <cassert>
 
 // Secp256k1
@@ -26,6 +30,10 @@
 
 Locked<Context> SECP256K1_CONTEXT(std::make_shared<Context>());
 
+// Larger batches are split into chunks of this size, and verified in parallel on the shared pool.
+// Each chunk is still verified as a batch, so it needs to be big enough for batching to pay off.
+static constexpr size_t VERIFY_CHUNK_SIZE = 64;
+
 BigInt<32> Crypto::Blake2b(const std::vector<uint8_t>& input)
 {
     BigInt<32> result;
@@ -117,32 +125,30 @@ Commitment Crypto::AddCommitments(
     const std::vector<Commitment>& positive,
     const std::vector<Commitment>& negative)
 {
-    const Commitment zeroCommitment(BigInt<33>::ValueOf(0));
-
-    std::vector<Commitment> sanitizedPositive;
-    std::copy_if(
-        positive.cbegin(),
-        positive.cend(),
-        std::back_inserter(sanitizedPositive),
-        [&zeroCommitment](const auto& positiveCommitment) {
-            return positiveCommitment != zeroCommitment;
-        }
+    std::vector<const Commitment*> positivePtrs;
+    positivePtrs.reserve(positive.size());
+    std::transform(
+        positive.cbegin(), positive.cend(),
+        std::back_inserter(positivePtrs),
+        [](const Commitment& commitment) { return &commitment; }
     );
 
-    std::vector<Commitment> sanitizedNegative;
-    std::copy_if(
-        negative.cbegin(),
-        negative.cend(),
-        std::back_inserter(sanitizedNegative),
-        [&zeroCommitment](const auto& negativeCommitment) {
-            return negativeCommitment != zeroCommitment;
-        }
+    std::vector<const Commitment*> negativePtrs;
+    negativePtrs.reserve(negative.size());
+    std::transform(
+        negative.cbegin(), negative.cend(),
+        std::back_inserter(negativePtrs),
+        [](const Commitment& commitment) { return &commitment; }
     );
 
-    return Pedersen(SECP256K1_CONTEXT).PedersenCommitSum(
-        sanitizedPositive,
-        sanitizedNegative
-    );
+    return AddCommitments(positivePtrs, negativePtrs);
+}
+
+Commitment Crypto::AddCommitments(
+    const std::vector<const Commitment*>& positive,
+    const std::vector<const Commitment*>& negative)
+{
+    return Pedersen(SECP256K1_CONTEXT).PedersenCommitSum(positive, negative);
 }
 
 BlindingFactor Crypto::AddBlindingFactors(
@@ -228,7 +234,31 @@ std::unique_ptr<RewoundProof> Crypto::RewindRangeProof(
 bool Crypto::VerifyRangeProofs(
     const std::vector<std::pair<Commitment, RangeProof::CPtr>>& rangeProofs)
 {
-    return Bulletproofs(SECP256K1_CONTEXT).VerifyBulletproofs(rangeProofs);
+    MW_TRACE_SCOPE(VERIFY_RANGE_PROOFS, rangeProofs.size(), 0);
+
+    static Counter& numVerified = MetricsAPI::GetCounter("crypto_range_proofs_verified_total", "Range proofs passed to VerifyRangeProofs.");
+    static Histogram& latency = MetricsAPI::GetHistogram("crypto_verify_range_proofs_seconds", "Time to verify a batch of range proofs.");
+    numVerified.Add(rangeProofs.size());
+    LatencyTimer timer(latency);
+
+    if (rangeProofs.size() <= VERIFY_CHUNK_SIZE)
+    {
+        return Bulletproofs(SECP256K1_CONTEXT).VerifyBulletproofs(rangeProofs);
+    }
+
+    std::atomic_bool valid(true);
+    ThreadPoolAPI::GetDefaultPool().ParallelFor(
+        0, rangeProofs.size(), VERIFY_CHUNK_SIZE,
+        [&rangeProofs, &valid](const size_t begin, const size_t end) {
+            // Once a chunk fails, the rest are skipped.
+            if (valid && !Bulletproofs(SECP256K1_CONTEXT).VerifyBulletproofs({ rangeProofs.cbegin() + begin, rangeProofs.cbegin() + end }))
+            {
+                valid = false;
+            }
+        }
+    );
+
+    return valid;
 }
 
 uint64_t Crypto::SipHash24(
@@ -415,11 +445,38 @@ bool Crypto::VerifyKernelSignatures(
     const std::vector<const Commitment*>& publicKeys,
     const std::vector<const Hash*>& messages)
 {
-    return AggSig(SECP256K1_CONTEXT).VerifyAggregateSignatures(
-        signatures,
-        publicKeys,
-        messages
+    MW_TRACE_SCOPE(VERIFY_KERNEL_SIGS, signatures.size(), 0);
+
+    static Counter& numVerified = MetricsAPI::GetCounter("crypto_kernel_signatures_verified_total", "Signatures passed to VerifyKernelSignatures.");
+    static Histogram& latency = MetricsAPI::GetHistogram("crypto_verify_kernel_signatures_seconds", "Time to verify a batch of kernel signatures.");
+    numVerified.Add(signatures.size());
+    LatencyTimer timer(latency);
+
+    if (signatures.size() <= VERIFY_CHUNK_SIZE)
+    {
+        return AggSig(SECP256K1_CONTEXT).VerifyAggregateSignatures(
+            signatures,
+            publicKeys,
+            messages
+        );
+    }
+
+    std::atomic_bool valid(true);
+    ThreadPoolAPI::GetDefaultPool().ParallelFor(
+        0, signatures.size(), VERIFY_CHUNK_SIZE,
+        [&signatures, &publicKeys, &messages, &valid](const size_t begin, const size_t end) {
+            // Once a chunk fails, the rest are skipped.
+            if (valid && !AggSig(SECP256K1_CONTEXT).VerifyAggregateSignatures(
+                { signatures.cbegin() + begin, signatures.cbegin() + end },
+                { publicKeys.cbegin() + begin, publicKeys.cbegin() + end },
+                { messages.cbegin() + begin, messages.cbegin() + end }))
+            {
+                valid = false;
+            }
+        }
     );
+
+    return valid;
 }
 
 SecretKey Crypto::GenerateSecureNonce()
@@ -24,12 +24,14 @@ Commitment Pedersen::PedersenCommit(const uint64_t value, const BlindingFactor&
     return ConversionUtil(m_context).ToCommitment(commitment);
 }
 
-Commitment Pedersen::PedersenCommitSum(const std::vector<Commitment>& positive, const std::vector<Commitment>& negative) const
+Commitment Pedersen::PedersenCommitSum(const std::vector<const Commitment*>& positive, const std::vector<const Commitment*>& negative) const
 {
-    std::vector<secp256k1_pedersen_commitment> positiveCommitments = ConversionUtil(m_context).ToSecp256k1(positive);
+    ConversionUtil conversionUtil(m_context);
+
+    std::vector<secp256k1_pedersen_commitment> positiveCommitments = conversionUtil.ToSecp256k1(positive);
     std::vector<secp256k1_pedersen_commitment*> positivePtrs = VectorUtil::ToPointerVec(positiveCommitments);
 
-    std::vector<secp256k1_pedersen_commitment> negativeCommitments = ConversionUtil(m_context).ToSecp256k1(negative);
+    std::vector<secp256k1_pedersen_commitment> negativeCommitments = conversionUtil.ToSecp256k1(negative);
     std::vector<secp256k1_pedersen_commitment*> negativePtrs = VectorUtil::ToPointerVec(negativeCommitments);
 
     secp256k1_pedersen_commitment commitment;
@@ -47,7 +49,7 @@ Commitment Pedersen::PedersenCommitSum(const std::vector<Commitment>& positive,
         ThrowCrypto("secp256k1_pedersen_commit_sum error");
     }
 
-    return ConversionUtil(m_context).ToCommitment(commitment);
+    return conversionUtil.ToCommitment(commitment);
 }
 
 BlindingFactor Pedersen::PedersenBlindSum(const std::vector<BlindingFactor>& positive, const std::vector<BlindingFactor>& negative) const
@@ -17,9 +17,12 @@ public:
         const BlindingFactor& blindingFactor
     ) const;
 
+    //
+    // Sums the commitments, ignoring any zero commitments.
+    //
     Commitment PedersenCommitSum(
-        const std::vector<Commitment>& positive,
-        const std::vector<Commitment>& negative
+        const std::vector<const Commitment*>& positive,
+        const std::vector<const Commitment*>& negative
     ) const;
 
     BlindingFactor PedersenBlindSum(
@@ -33,5 +36,5 @@ public:
     ) const;
 
 private:
-    Locked<Context> m_context;
+    Locked<Context>& m_context;
 };
\ No newline at end of file
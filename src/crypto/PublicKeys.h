@@ -15,5 +15,5 @@ public:
     PublicKey PublicKeySum(const std::vector<PublicKey>& publicKeys) const;
 
 private:
-    Locked<Context> m_context;
+    Locked<Context>& m_context;
 };
\ No newline at end of file
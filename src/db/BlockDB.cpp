@@ -1,24 +1,74 @@
 #include "BlockDB.h"
+#include "CachedBlockDB.h"
+#include "BlockSnapshot.h"
 
 #include <mw/core/common/Logger.h>
+#include <mw/core/common/Tracer.h>
 
-static const DBTable HEADER_TABLE = { 'H' };
-static const DBTable BLOCK_TABLE = { 'B' };
-static const DBTable UTXO_TABLE = { 'U', DBTable::Options({ true /* allowDuplicates */ }) };
+// Headers and blocks near the tip are read over and over, so their deserialized objects are cached.
+static const DBTable HEADER_TABLE = { 'H', DBTable::Options({ false, true }) };
+static const DBTable BLOCK_TABLE = { 'B', DBTable::Options({ false, true }) };
+static const DBTable UTXO_TABLE = { 'U' };
+static const DBTable PROOF_TABLE = { 'P' };
+static const DBTable PRUNE_TABLE = { 'R' };
 
-Locked<IBlockDB> BlockDBFactory::Open(const Context::CPtr& pContext, const FilePath& chainPath)
+//
+// The read API is noexcept, so a lookup that fails, because the database couldn't be reopened, LevelDB reported
+// an I/O or corruption error, or a stored object couldn't be deserialized, is logged and returns what a lookup
+// that found nothing would.
+//
+template<typename F>
+static auto ReadOrLog(const char* what, const F& read) noexcept -> decltype(read())
 {
-    auto pDatabase = Database::Open(pContext, chainPath.GetChild("blocks"));
+    try
+    {
+        return read();
+    }
+    catch (std::exception& e)
+    {
+        LOG_ERROR_F("Failed to read {}: {}", what, e.what());
+    }
+
+    return decltype(read())();
+}
+
+Locked<IBlockDB> BlockDBFactory::Open(const Context::CPtr& pContext, const FilePath& chainPath, const Config& config)
+{
+    const DBOptions options = DBOptions::FromConfig(config);
+    LOG_INFO_F("Opening block database with profile {}", options.profile);
+
+    auto pDatabase = Database::Open(pContext, chainPath.GetChild("blocks"), options);
+
+    // The journal may replay writes to the chain store, so it's recovered before the chain store is loaded.
+    auto pJournal = CommitJournal::Open(chainPath.GetChild("journal.bin"), pDatabase->GetCommitSequence(), options.writer.sync);
     auto pChainStore = ChainStore::Load(chainPath.GetChild("chain"));
+    auto pBlockDB = std::make_shared<BlockDB>(pDatabase, pChainStore, pJournal);
 
-    return Locked<IBlockDB>(std::make_shared<BlockDB>(pDatabase, pChainStore));
+    const size_t utxoCacheBytes = DBOptions::GetSize(config, "db.utxo_cache_mb", 128 * 1024 * 1024);
+    return Locked<IBlockDB>(std::make_shared<CachedBlockDB>(pBlockDB, utxoCacheBytes));
+}
+
+BlockDB::BlockDB(
+    const Database::Ptr& pDatabase,
+    const ChainStore::Ptr& pChainStore,
+    const CommitJournal::Ptr& pJournal,
+    const BlockPruner::Options& pruneOptions)
+    : m_pDatabase(pDatabase),
+    m_pChainStore(pChainStore),
+    m_pJournal(pJournal),
+    m_pruneOptions(pruneOptions),
+    m_pPruner(std::make_unique<BlockPruner>(pDatabase, BLOCK_TABLE, PRUNE_TABLE, pruneOptions)),
+    m_utxoFilter(0),
+    m_writing(false)
+{
+    RebuildUTXOFilter(MIN_UTXO_FILTER_CAPACITY);
 }
 
 IHeader::CPtr BlockDB::GetHeaderByHash(const Hash& hash) const noexcept
 {
     LOG_TRACE_F("Loading header {}", hash);
 
-    auto pEntry = m_pDatabase->Get<IHeader>(HEADER_TABLE, hash.ToHex());
+    auto pEntry = ReadOrLog("header", [this, &hash]() { return m_pDatabase->Get<IHeader>(HEADER_TABLE, DBTable::ToItemKey(hash)); });
     if (pEntry != nullptr)
     {
         LOG_DEBUG_F("Header found for hash {}", hash);
@@ -35,20 +85,28 @@ std::vector<IHeader::CPtr> BlockDB::GetHeadersByHash(const std::vector<Hash>& ha
 {
     LOG_TRACE_F("Loading {} headers", hashes.size());
 
+    std::vector<std::string> keys;
+    keys.reserve(hashes.size());
+    std::transform(
+        hashes.cbegin(), hashes.cend(),
+        std::back_inserter(keys),
+        DBTable::ToItemKey<Hash>
+    );
+
+    auto entries = ReadOrLog("headers", [this, &keys]() { return m_pDatabase->MultiGet<IHeader>(HEADER_TABLE, keys); });
+
     std::vector<IHeader::CPtr> headers;
     headers.reserve(hashes.size());
 
-    for (const Hash& hash : hashes)
+    for (size_t i = 0; i < entries.size(); i++)
     {
-        auto pEntry = m_pDatabase->Get<IHeader>(HEADER_TABLE, hash.ToHex());
-        if (pEntry != nullptr)
+        if (entries[i] != nullptr)
         {
-            LOG_TRACE_F("Header found for hash {}", hash);
-            headers.emplace_back(pEntry->item);
+            headers.emplace_back(entries[i]->item);
         }
         else
         {
-            LOG_DEBUG_F("No header found for hash {}", hash);
+            LOG_DEBUG_F("No header found for hash {}", hashes[i]);
         }
     }
 
@@ -56,15 +114,15 @@ std::vector<IHeader::CPtr> BlockDB::GetHeadersByHash(const std::vector<Hash>& ha
     return headers;
 }
 
-void BlockDB::AddHeader(const IHeader::CPtr& pHeader)
+std::shared_future<void> BlockDB::AddHeader(const IHeader::CPtr& pHeader)
 {
     LOG_TRACE_F("Adding header {}", pHeader);
 
     std::vector<DBEntry<IHeader>> entries({ BlockDB::ToHeaderEntry(pHeader) });
-    m_pDatabase->Put(HEADER_TABLE, entries);
+    return m_pDatabase->Put(HEADER_TABLE, entries);
 }
 
-void BlockDB::AddHeaders(const std::vector<IHeader::CPtr>& headers)
+std::shared_future<void> BlockDB::AddHeaders(const std::vector<IHeader::CPtr>& headers)
 {
     LOG_TRACE_F("Adding {} headers", headers.size());
 
@@ -76,14 +134,14 @@ void BlockDB::AddHeaders(const std::vector<IHeader::CPtr>& headers)
         std::back_inserter(entries),
         BlockDB::ToHeaderEntry
     );
-    m_pDatabase->Put(HEADER_TABLE, entries);
+    return m_pDatabase->Put(HEADER_TABLE, entries);
 }
 
 IBlock::CPtr BlockDB::GetBlockByHash(const Hash& hash) const noexcept
 {
     LOG_TRACE_F("Loading block {}", hash);
 
-    auto pEntry = m_pDatabase->Get<IBlock>(BLOCK_TABLE, hash.ToHex());
+    auto pEntry = ReadOrLog("block", [this, &hash]() { return m_pDatabase->Get<IBlock>(BLOCK_TABLE, DBTable::ToItemKey(hash)); });
     if (pEntry != nullptr)
     {
         LOG_DEBUG_F("IBlock found for hash {}", hash);
@@ -113,48 +171,441 @@ IBlock::CPtr BlockDB::GetBlockByHeight(const uint64_t height) const noexcept
     }
 }
 
-void BlockDB::AddBlock(const IBlock::CPtr& pBlock)
+std::shared_future<void> BlockDB::AddBlock(const IBlock::CPtr& pBlock)
 {
     LOG_TRACE_F("Saving block {}", pBlock);
 
     std::vector<DBEntry<IBlock>> entries({ BlockDB::ToBlockEntry(pBlock) });
-    m_pDatabase->Put<IBlock>(BLOCK_TABLE, entries);
+    return m_pDatabase->Put<IBlock>(BLOCK_TABLE, entries);
 }
 
 void BlockDB::RemoveOldBlocks(const uint64_t height)
 {
     LOG_TRACE_F("Removing blocks before height {}", height);
 
-    // TODO: Implement
+    if (m_pPruner == nullptr)
+    {
+        ThrowDatabase("Can't prune, since the database couldn't be reopened");
+    }
+
+    // Blocks are looked up here, since the chain store can't be read from the pruning thread.
+    const uint64_t scheduledHeight = m_pPruner->GetScheduledHeight();
+    const uint64_t pruneHeight = std::min(height, m_pChainStore->GetNumBlocks());
+    if (pruneHeight <= scheduledHeight)
+    {
+        return;
+    }
+
+    std::vector<Hash> hashes;
+    hashes.reserve(pruneHeight - scheduledHeight);
+    for (uint64_t blockHeight = scheduledHeight; blockHeight < pruneHeight; blockHeight++)
+    {
+        hashes.push_back(m_pChainStore->GetHashByHeight(blockHeight).value());
+    }
+
+    LOG_DEBUG_F("Queueing {} blocks for pruning", hashes.size());
+    m_pPruner->Prune(pruneHeight, std::move(hashes));
+}
+
+void BlockDB::AddToMainChain(const IHeader::CPtr& pHeader)
+{
+    LOG_TRACE_F("Adding {} to main chain at height {}", pHeader, pHeader->GetHeight());
+
+    m_pChainStore->AddHash(pHeader->GetHeight(), pHeader->GetHash());
+    if (!m_writing)
+    {
+        m_pChainStore->Commit();
+    }
+}
+
+void BlockDB::RewindMainChain(const uint64_t nextHeight)
+{
+    LOG_TRACE_F("Rewinding main chain to height {}", nextHeight);
+
+    m_pChainStore->Rewind(nextHeight);
+    if (!m_writing)
+    {
+        m_pChainStore->Commit();
+    }
 }
 
 std::unordered_map<Commitment, UTXO::CPtr> BlockDB::GetUTXOs(const std::vector<Commitment>& commitments) const noexcept
 {
-    std::unordered_map<Commitment, UTXO::CPtr> utxos;
+    LOG_TRACE_F("Loading {} UTXOs", commitments.size());
+
+    auto infos = GetUTXOInfos(commitments);
 
+    // Only the proofs of UTXOs found in the index are loaded.
+    std::vector<const Commitment*> found;
+    std::vector<std::string> keys;
+    found.reserve(infos.size());
+    keys.reserve(infos.size());
     for (const Commitment& commitment : commitments)
     {
-        auto pUTXO = m_pDatabase->Get<UTXO>(UTXO_TABLE, commitment.ToHex());
-        if (pUTXO != nullptr)
+        if (infos.find(commitment) != infos.cend())
         {
-            utxos.insert({ commitment, pUTXO->item });
+            found.push_back(&commitment);
+            keys.push_back(DBTable::ToItemKey(commitment));
         }
     }
 
+    auto proofs = ReadOrLog("range proofs", [this, &keys]() { return m_pDatabase->MultiGet<UTXOProof>(PROOF_TABLE, keys); });
+
+    std::unordered_map<Commitment, UTXO::CPtr> utxos;
+    utxos.reserve(found.size());
+
+    for (size_t i = 0; i < proofs.size(); i++)
+    {
+        if (proofs[i] == nullptr)
+        {
+            LOG_ERROR_F("No range proof found for UTXO {}", *found[i]);
+            continue;
+        }
+
+        utxos.insert({ *found[i], ToUTXO(*found[i], *infos[*found[i]], *proofs[i]->item) });
+    }
+
+    LOG_DEBUG_F("Found {}/{} UTXOs", utxos.size(), commitments.size());
     return utxos;
 }
 
+std::unordered_map<Commitment, UTXOInfo::CPtr> BlockDB::GetUTXOInfos(const std::vector<Commitment>& commitments) const noexcept
+{
+    LOG_TRACE_F("Loading {} UTXO infos", commitments.size());
+
+    // Commitments the filter rules out are definitely not in the index, so never reach the database.
+    std::vector<const Commitment*> candidates;
+    std::vector<std::string> keys;
+    for (const Commitment& commitment : commitments)
+    {
+        std::string key = DBTable::ToItemKey(commitment);
+        if (m_utxoFilter.MayContain((const uint8_t*)key.data(), key.size()))
+        {
+            candidates.push_back(&commitment);
+            keys.push_back(std::move(key));
+        }
+    }
+
+    LOG_TRACE_F("{}/{} UTXO lookups passed the filter", keys.size(), commitments.size());
+
+    auto entries = ReadOrLog("UTXOs", [this, &keys]() { return m_pDatabase->MultiGet<UTXOInfo>(UTXO_TABLE, keys); });
+
+    std::unordered_map<Commitment, UTXOInfo::CPtr> infos;
+    infos.reserve(keys.size());
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (entries[i] != nullptr)
+        {
+            infos.insert({ *candidates[i], entries[i]->item });
+        }
+    }
+
+    LOG_DEBUG_F("Found {}/{} UTXO infos", infos.size(), commitments.size());
+    return infos;
+}
+
 void BlockDB::AddUTXOs(const std::vector<UTXO::CPtr>& utxos)
 {
-    // TODO: Implement
+    LOG_TRACE_F("Adding {} UTXOs", utxos.size());
+
+    if (utxos.empty())
+    {
+        return;
+    }
+
+    std::vector<DBEntry<UTXOInfo>> infos;
+    infos.reserve(utxos.size());
+    std::transform(
+        utxos.cbegin(), utxos.cend(),
+        std::back_inserter(infos),
+        BlockDB::ToUTXOInfoEntry
+    );
+
+    std::vector<DBEntry<UTXOProof>> proofs;
+    proofs.reserve(utxos.size());
+    std::transform(
+        utxos.cbegin(), utxos.cend(),
+        std::back_inserter(proofs),
+        BlockDB::ToUTXOProofEntry
+    );
+
+    // Proofs are written first, so an indexed UTXO always has its proof.
+    m_pDatabase->Put(PROOF_TABLE, proofs);
+    m_pDatabase->Put(UTXO_TABLE, infos);
+
+    for (const DBEntry<UTXOInfo>& entry : infos)
+    {
+        m_utxoFilter.Insert((const uint8_t*)entry.key.data(), entry.key.size());
+        if (m_writing)
+        {
+            m_addedUTXOs.push_back(entry.key);
+        }
+    }
 }
 
-void BlockDB::RemoveUTXOs(const std::vector<Commitment>& commitment)
+void BlockDB::RemoveUTXOs(const std::vector<Commitment>& commitments)
 {
-    // TODO: Implement
+    LOG_TRACE_F("Removing {} UTXOs", commitments.size());
+
+    auto infos = GetUTXOInfos(commitments);
+
+    std::vector<std::string> keys;
+    keys.reserve(commitments.size());
+    for (const Commitment& commitment : commitments)
+    {
+        if (infos.find(commitment) == infos.cend())
+        {
+            ThrowDatabase_F("No UTXO found for commitment {}", commitment);
+        }
+
+        keys.push_back(DBTable::ToItemKey(commitment));
+    }
+
+    m_pDatabase->Delete(UTXO_TABLE, keys);
+    m_pDatabase->Delete(PROOF_TABLE, keys);
+
+    if (m_writing)
+    {
+        m_removedUTXOs.insert(m_removedUTXOs.end(), keys.cbegin(), keys.cend());
+    }
+    else
+    {
+        for (const std::string& key : keys)
+        {
+            m_utxoFilter.Erase((const uint8_t*)key.data(), key.size());
+        }
+    }
 }
 
 void BlockDB::RemoveAllUTXOs()
 {
-    // TODO: Implement
+    LOG_TRACE("Removing all UTXOs");
+
+    m_pDatabase->DeleteAll(UTXO_TABLE);
+    m_pDatabase->DeleteAll(PROOF_TABLE);
+
+    if (m_writing)
+    {
+        m_removeAllIndex = m_addedUTXOs.size();
+        m_removedUTXOs.clear();
+    }
+    else
+    {
+        m_utxoFilter.Clear();
+    }
+}
+
+void BlockDB::Reconfigure(const Config& config)
+{
+    // Reopening discards the database's transaction, so everything written so far is committed first.
+    // A closed database has nothing to commit, and committing would throw before it could be reopened.
+    if (m_pDatabase->IsOpen())
+    {
+        Commit();
+    }
+
+    // The pruner holds the database, so it's stopped while the database is reopened, and restarted even if that fails,
+    // unless the database was left closed.
+    m_pPruner.reset();
+    const DBOptions options = DBOptions::FromConfig(config);
+    try
+    {
+        m_pDatabase->Reopen(options);
+    }
+    catch (std::exception&)
+    {
+        if (m_pDatabase->IsOpen())
+        {
+            m_pPruner = std::make_unique<BlockPruner>(m_pDatabase, BLOCK_TABLE, PRUNE_TABLE, m_pruneOptions);
+        }
+
+        throw;
+    }
+
+    m_pJournal->SetSync(options.writer.sync);
+    m_pPruner = std::make_unique<BlockPruner>(m_pDatabase, BLOCK_TABLE, PRUNE_TABLE, m_pruneOptions);
+}
+
+IBlockSnapshot::CPtr BlockDB::CreateSnapshot() const
+{
+    // The database is committed before the chain store, so taking the chain first
+    // guarantees every block in the chain snapshot is in the database snapshot.
+    ChainStore::Snapshot chain = m_pChainStore->GetSnapshot();
+    return std::make_shared<const BlockSnapshot>(m_pDatabase->GetSnapshot(), std::move(chain));
+}
+
+void BlockDB::CommitWith(const std::vector<Traits::IJournaled*>& files)
+{
+    CommitJournaled(files);
+    SetDirty(false);
+}
+
+void BlockDB::Commit()
+{
+    CommitJournaled({});
+}
+
+void BlockDB::Rollback() noexcept
+{
+    m_pDatabase->Rollback();
+    m_pChainStore->Rollback();
+
+    // Nothing was removed from the filter yet, so only the added UTXOs need to be undone.
+    for (const std::string& key : m_addedUTXOs)
+    {
+        m_utxoFilter.Erase((const uint8_t*)key.data(), key.size());
+    }
+
+    m_addedUTXOs.clear();
+    m_removedUTXOs.clear();
+    m_removeAllIndex = tl::nullopt;
+}
+
+void BlockDB::OnInitWrite() noexcept
+{
+    m_writing = true;
+    m_pDatabase->OnInitWrite();
+}
+
+void BlockDB::OnEndWrite() noexcept
+{
+    m_pDatabase->OnEndWrite();
+    m_writing = false;
+}
+
+void BlockDB::CommitJournaled(const std::vector<Traits::IJournaled*>& files)
+{
+    MW_TRACE_SCOPE(BLOCK_DB_COMMIT, files.size(), 0);
+
+    // The journal commits the database first, so the chain store never refers to a block that wasn't written.
+    std::vector<Traits::IJournaled*> journaled({ m_pChainStore.get() });
+    journaled.insert(journaled.end(), files.cbegin(), files.cend());
+
+    m_pJournal->Commit(journaled, [this](const uint64_t sequence) { m_pDatabase->CommitJournaled(sequence); });
+    CommitUTXOFilter();
+}
+
+void BlockDB::CommitUTXOFilter()
+{
+    if (m_removeAllIndex.has_value())
+    {
+        m_utxoFilter.Clear();
+        for (size_t i = m_removeAllIndex.value(); i < m_addedUTXOs.size(); i++)
+        {
+            m_utxoFilter.Insert((const uint8_t*)m_addedUTXOs[i].data(), m_addedUTXOs[i].size());
+        }
+    }
+
+    for (const std::string& key : m_removedUTXOs)
+    {
+        m_utxoFilter.Erase((const uint8_t*)key.data(), key.size());
+    }
+
+    m_addedUTXOs.clear();
+    m_removedUTXOs.clear();
+    m_removeAllIndex = tl::nullopt;
+
+    if (m_utxoFilter.IsOverloaded())
+    {
+        LOG_INFO_F("UTXO filter is overloaded with {} entries. Rebuilding.", m_utxoFilter.Size());
+        RebuildUTXOFilter(m_utxoFilter.GetCapacity() * 2);
+    }
+}
+
+void BlockDB::RebuildUTXOFilter(const size_t capacity)
+{
+    CuckooFilter filter(std::max(capacity, MIN_UTXO_FILTER_CAPACITY));
+    m_pDatabase->ForEachKey(UTXO_TABLE, [&filter](const std::string& key) {
+        filter.Insert((const uint8_t*)key.data(), key.size());
+    });
+
+    // Leave room for the UTXO set to double before the next rebuild.
+    if (filter.IsOverloaded() || filter.Size() * 2 > filter.GetCapacity())
+    {
+        return RebuildUTXOFilter(filter.Size() * 2);
+    }
+
+    LOG_DEBUG_F("Built UTXO filter with {} entries", filter.Size());
+    m_utxoFilter = std::move(filter);
+}
+
+//
+// BlockSnapshot
+//
+IHeader::CPtr BlockSnapshot::GetHeaderByHash(const Hash& hash) const noexcept
+{
+    auto pEntry = ReadOrLog("header", [this, &hash]() { return m_pDatabase->Get<IHeader>(HEADER_TABLE, DBTable::ToItemKey(hash)); });
+    return pEntry != nullptr ? pEntry->item : nullptr;
+}
+
+std::vector<IHeader::CPtr> BlockSnapshot::GetHeadersByHash(const std::vector<Hash>& hashes) const noexcept
+{
+    std::vector<std::string> keys;
+    keys.reserve(hashes.size());
+    std::transform(
+        hashes.cbegin(), hashes.cend(),
+        std::back_inserter(keys),
+        DBTable::ToItemKey<Hash>
+    );
+
+    std::vector<IHeader::CPtr> headers;
+    headers.reserve(hashes.size());
+    for (auto& pEntry : ReadOrLog("headers", [this, &keys]() { return m_pDatabase->MultiGet<IHeader>(HEADER_TABLE, keys); }))
+    {
+        if (pEntry != nullptr)
+        {
+            headers.emplace_back(pEntry->item);
+        }
+    }
+
+    return headers;
+}
+
+IBlock::CPtr BlockSnapshot::GetBlockByHash(const Hash& hash) const noexcept
+{
+    auto pEntry = ReadOrLog("block", [this, &hash]() { return m_pDatabase->Get<IBlock>(BLOCK_TABLE, DBTable::ToItemKey(hash)); });
+    return pEntry != nullptr ? pEntry->item : nullptr;
+}
+
+IBlock::CPtr BlockSnapshot::GetBlockByHeight(const uint64_t height) const noexcept
+{
+    tl::optional<Hash> hashOpt = m_chain.GetHashByHeight(height);
+    return hashOpt.has_value() ? GetBlockByHash(hashOpt.value()) : nullptr;
+}
+
+std::unordered_map<Commitment, UTXO::CPtr> BlockSnapshot::GetUTXOs(const std::vector<Commitment>& commitments) const noexcept
+{
+    auto infos = GetUTXOInfos(commitments);
+
+    std::unordered_map<Commitment, UTXO::CPtr> utxos;
+    utxos.reserve(infos.size());
+    for (const auto& info : infos)
+    {
+        auto pProof = ReadOrLog("range proof", [this, &info]() { return m_pDatabase->Get<UTXOProof>(PROOF_TABLE, DBTable::ToItemKey(info.first)); });
+        if (pProof == nullptr)
+        {
+            LOG_ERROR_F("No range proof found for UTXO {}", info.first);
+            continue;
+        }
+
+        utxos.insert({ info.first, BlockDB::ToUTXO(info.first, *info.second, *pProof->item) });
+    }
+
+    return utxos;
+}
+
+std::unordered_map<Commitment, UTXOInfo::CPtr> BlockSnapshot::GetUTXOInfos(const std::vector<Commitment>& commitments) const noexcept
+{
+    std::unordered_map<Commitment, UTXOInfo::CPtr> infos;
+    for (const Commitment& commitment : commitments)
+    {
+        auto pEntry = ReadOrLog("UTXO", [this, &commitment]() { return m_pDatabase->Get<UTXOInfo>(UTXO_TABLE, DBTable::ToItemKey(commitment)); });
+        if (pEntry != nullptr)
+        {
+            infos.insert({ commitment, pEntry->item });
+        }
+    }
+
+    return infos;
 }
\ No newline at end of file
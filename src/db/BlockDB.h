@@ -3,54 +3,126 @@
 #include <mw/core/db/IBlockDB.h>
 
 #include "common/Database.h"
+#include "common/CuckooFilter.h"
 #include "ChainStore.h"
+#include "BlockPruner.h"
+#include "UTXOProof.h"
 
+#include <mw/core/file/CommitJournal.h>
+
+//
+// UTXOs are split into a hot index of UTXOInfos, and a cold store of range proofs.
+// An in-memory cuckoo filter over the commitments in the index lets lookups of missing UTXOs skip the database.
+//
 class BlockDB : public IBlockDB
 {
+    friend class BlockSnapshot;
+
 public:
-    BlockDB(const Database::Ptr& pDatabase, const ChainStore::Ptr& pChainStore)
-        : m_pDatabase(pDatabase), m_pChainStore(pChainStore) { }
+    BlockDB(
+        const Database::Ptr& pDatabase,
+        const ChainStore::Ptr& pChainStore,
+        const CommitJournal::Ptr& pJournal,
+        const BlockPruner::Options& pruneOptions = BlockPruner::Options::Default()
+    );
 
     //
     // Headers
     //
     IHeader::CPtr GetHeaderByHash(const Hash& hash) const noexcept final;
     std::vector<IHeader::CPtr> GetHeadersByHash(const std::vector<Hash>& hashes) const noexcept final;
-    void AddHeader(const IHeader::CPtr& pHeader) final;
-    void AddHeaders(const std::vector<IHeader::CPtr>& headers) final;
+    std::shared_future<void> AddHeader(const IHeader::CPtr& pHeader) final;
+    std::shared_future<void> AddHeaders(const std::vector<IHeader::CPtr>& headers) final;
 
     //
     // Blocks
     //
     IBlock::CPtr GetBlockByHash(const Hash& hash) const noexcept final;
     IBlock::CPtr GetBlockByHeight(const uint64_t height) const noexcept final;
-    void AddBlock(const IBlock::CPtr& pBlock) final;
+    std::shared_future<void> AddBlock(const IBlock::CPtr& pBlock) final;
     void RemoveOldBlocks(const uint64_t height) final;
+    BlockPruner::Stats GetPruneStats() const noexcept
+    {
+        return m_pPruner != nullptr ? m_pPruner->GetStats() : BlockPruner::Stats({ 0, 0, 0, 0, std::chrono::milliseconds(0) });
+    }
+    ObjectCache::Stats GetCacheStats() const noexcept { return m_pDatabase->GetCacheStats(); }
+    void AddToMainChain(const IHeader::CPtr& pHeader) final;
+    void RewindMainChain(const uint64_t nextHeight) final;
 
     //
     // UTXOs
     //
     std::unordered_map<Commitment, UTXO::CPtr> GetUTXOs(const std::vector<Commitment>& commitments) const noexcept final;
+    std::unordered_map<Commitment, UTXOInfo::CPtr> GetUTXOInfos(const std::vector<Commitment>& commitments) const noexcept final;
     void AddUTXOs(const std::vector<UTXO::CPtr>& utxos) final;
     void RemoveUTXOs(const std::vector<Commitment>& commitment) final;
     void RemoveAllUTXOs() final;
 
-    void Commit() final { return m_pDatabase->Commit(); }
-    void Rollback() noexcept final { return m_pDatabase->Rollback(); }
-    void OnInitWrite() noexcept final { m_pDatabase->OnInitWrite(); }
-    void OnEndWrite() noexcept final { m_pDatabase->OnEndWrite(); }
+    void Reconfigure(const Config& config) final;
+    IBlockSnapshot::CPtr CreateSnapshot() const final;
+    void CommitWith(const std::vector<Traits::IJournaled*>& files) final;
+
+    //
+    // Batchable
+    //
+    void Commit() final;
+    void Rollback() noexcept final;
+    void OnInitWrite() noexcept final;
+    void OnEndWrite() noexcept final;
 
 private:
     static DBEntry<IHeader> ToHeaderEntry(const IHeader::CPtr& pHeader)
     {
-        return DBEntry<IHeader>(pHeader->GetHash().ToHex(), pHeader);
+        return DBEntry<IHeader>(DBTable::ToItemKey(pHeader->GetHash()), pHeader);
     }
 
     static DBEntry<IBlock> ToBlockEntry(const IBlock::CPtr& pBlock)
     {
-        return DBEntry<IBlock>(pBlock->GetHash().ToHex(), pBlock);
+        return DBEntry<IBlock>(DBTable::ToItemKey(pBlock->GetHash()), pBlock);
+    }
+
+    static DBEntry<UTXOInfo> ToUTXOInfoEntry(const UTXO::CPtr& pUTXO)
+    {
+        return DBEntry<UTXOInfo>(DBTable::ToItemKey(pUTXO->GetOutput().GetCommitment()), UTXOInfo::From(*pUTXO));
+    }
+
+    static DBEntry<UTXOProof> ToUTXOProofEntry(const UTXO::CPtr& pUTXO)
+    {
+        return DBEntry<UTXOProof>(
+            DBTable::ToItemKey(pUTXO->GetOutput().GetCommitment()),
+            std::make_shared<const UTXOProof>(pUTXO->GetOutput().GetRangeProof())
+        );
+    }
+
+    static UTXO::CPtr ToUTXO(const Commitment& commitment, const UTXOInfo& info, const UTXOProof& proof)
+    {
+        Output output(info.GetFeatures(), Commitment(commitment), proof.GetRangeProof());
+        return std::make_shared<const UTXO>(info.GetBlockHeight(), mmr::LeafIndex(info.GetLeafIndex()), std::move(output));
     }
 
+    void CommitJournaled(const std::vector<Traits::IJournaled*>& files);
+    void CommitUTXOFilter();
+    void RebuildUTXOFilter(const size_t capacity);
+
+    // Enough for the UTXO set to grow for a long while before the filter needs to be rebuilt.
+    static constexpr size_t MIN_UTXO_FILTER_CAPACITY = 1024 * 1024;
+
     Database::Ptr m_pDatabase;
     ChainStore::Ptr m_pChainStore;
+    CommitJournal::Ptr m_pJournal;
+    BlockPruner::Options m_pruneOptions;
+    std::unique_ptr<BlockPruner> m_pPruner;
+
+    //
+    // The filter is only changed while holding the write lock.
+    // Adds are applied immediately, since a stale fingerprint is only a false positive,
+    // but removals are deferred until the batch is committed.
+    //
+    CuckooFilter m_utxoFilter;
+    bool m_writing;
+    std::vector<std::string> m_addedUTXOs;
+    std::vector<std::string> m_removedUTXOs;
+
+    // When all UTXOs were removed in this batch, the index into m_addedUTXOs of the first UTXO added afterwards.
+    tl::optional<size_t> m_removeAllIndex;
 };
\ No newline at end of file
@@ -0,0 +1,301 @@
+#pragma once
+
+#include "common/Database.h"
+
+#include <mw/core/common/Lock.h>
+#include <mw/core/common/Logger.h>
+#include <mw/core/common/ThreadManager.h>
+#include <mw/core/models/crypto/Hash.h>
+#include <mw/core/util/ThreadUtil.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//
+// The height below which blocks have been pruned, stored so pruning resumes where it left off.
+//
+class PrunedHeight : public Traits::ISerializable
+{
+public:
+    PrunedHeight(const uint64_t height) : m_height(height) { }
+
+    uint64_t GetHeight() const noexcept { return m_height; }
+
+    Serializer& Serialize(Serializer& serializer) const noexcept final
+    {
+        return serializer.Append<uint64_t>(m_height);
+    }
+
+    static std::shared_ptr<const PrunedHeight> Deserialize(const Context::CPtr&, Deserializer& deserializer)
+    {
+        return std::make_shared<const PrunedHeight>(deserializer.Read<uint64_t>());
+    }
+
+private:
+    uint64_t m_height;
+};
+
+//
+// Deletes old blocks on a background thread.
+//
+// Blocks are deleted in small batches through their own transactions, with a pause between batches,
+// so the group commits that foreground writes join never carry more than one batch of deletes.
+// The block table is compacted every blocksPerCompaction blocks, and once the queue drains, to reclaim the space.
+//
+class BlockPruner
+{
+public:
+    struct Options
+    {
+        static Options Default() { return Options({ 100, std::chrono::milliseconds(50), 10000 }); }
+
+        // Number of blocks deleted per transaction.
+        size_t blocksPerBatch;
+
+        // Pause between batches, which bounds the rate at which blocks are deleted.
+        std::chrono::milliseconds batchInterval;
+
+        // Number of deleted blocks between compactions.
+        size_t blocksPerCompaction;
+    };
+
+    struct Stats
+    {
+        uint64_t prunedHeight;
+        uint64_t blocksRemoved;
+        uint64_t bytesReclaimed;
+        uint64_t numCompactions;
+
+        // Time spent deleting and compacting, excluding the pauses between batches.
+        std::chrono::milliseconds timeSpent;
+    };
+
+    BlockPruner(
+        const Database::Ptr& pDatabase,
+        const DBTable& blockTable,
+        const DBTable& stateTable,
+        const Options& options = Options::Default())
+        : m_pDatabase(pDatabase),
+        m_blockTable(blockTable),
+        m_stateTable(stateTable),
+        m_options(options),
+        m_stop(false),
+        m_working(false),
+        m_scheduledHeight(0),
+        m_blocksSinceCompaction(0),
+        m_stats(Stats({ 0, 0, 0, 0, std::chrono::milliseconds(0) })),
+        m_sizeBeforeDeletes(0)
+    {
+        auto pEntry = m_pDatabase->Get<PrunedHeight>(m_stateTable, PRUNED_HEIGHT_KEY);
+        const uint64_t prunedHeight = pEntry != nullptr ? pEntry->item->GetHeight() : 0;
+        m_stats.Update([prunedHeight](Stats& stats) { stats.prunedHeight = prunedHeight; });
+        m_scheduledHeight = prunedHeight;
+
+        m_thread = ThreadManagerAPI::CreateThread("BLOCK_PRUNER", BlockPruner::Thread, this);
+    }
+
+    ~BlockPruner()
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+
+        m_conditional.notify_all();
+        ThreadUtil::Join(m_thread);
+    }
+
+    //
+    // Height up to which blocks have been queued for pruning.
+    // Blocks at and above this height are next to be passed to Prune().
+    //
+    uint64_t GetScheduledHeight() const noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_scheduledHeight;
+    }
+
+    //
+    // Queues the blocks with the given hashes, which must be the blocks at heights [GetScheduledHeight(), height).
+    //
+    void Prune(const uint64_t height, std::vector<Hash>&& hashes)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        assert(height == m_scheduledHeight + hashes.size());
+        m_scheduledHeight = height;
+        m_queue.insert(m_queue.end(), hashes.begin(), hashes.end());
+        m_conditional.notify_all();
+    }
+
+    //
+    // Doesn't take the pruner's lock, so polling it never holds up pruning.
+    //
+    Stats GetStats() const noexcept
+    {
+        return m_stats.Load();
+    }
+
+    //
+    // Blocks until every queued block is deleted, and the block table compacted.
+    //
+    void WaitUntilIdle()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idleConditional.wait(lock, [this] { return m_queue.empty() && !m_working; });
+    }
+
+private:
+    static void Thread(BlockPruner* pPruner)
+    {
+        LOG_TRACE("BEGIN");
+
+        while (pPruner->PruneNextBatch())
+        {
+        }
+
+        LOG_TRACE("END");
+    }
+
+    // Deletes the next batch, then waits out the batch interval. Returns false once stopped.
+    bool PruneNextBatch()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_conditional.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+        if (m_stop)
+        {
+            return false;
+        }
+
+        const size_t batchSize = std::min(m_options.blocksPerBatch, m_queue.size());
+        std::vector<Hash> hashes(m_queue.begin(), m_queue.begin() + batchSize);
+        const uint64_t prunedHeight = m_stats.Load().prunedHeight + batchSize;
+        m_working = true;
+        lock.unlock();
+
+        const auto start = std::chrono::steady_clock::now();
+        try
+        {
+            if (m_blocksSinceCompaction == 0)
+            {
+                m_sizeBeforeDeletes = m_pDatabase->GetApproximateSize(m_blockTable);
+            }
+
+            RemoveBlocks(hashes, prunedHeight);
+        }
+        catch (std::exception& e)
+        {
+            LOG_ERROR_F("Failed to prune blocks: {}", e.what());
+
+            lock.lock();
+            m_working = false;
+            m_idleConditional.notify_all();
+            return !m_conditional.wait_for(lock, m_options.batchInterval, [this] { return m_stop; });
+        }
+
+        lock.lock();
+        m_queue.erase(m_queue.begin(), m_queue.begin() + batchSize);
+        m_stats.Update([prunedHeight, batchSize](Stats& stats) {
+            stats.prunedHeight = prunedHeight;
+            stats.blocksRemoved += batchSize;
+        });
+        m_blocksSinceCompaction += batchSize;
+        const bool compact = m_blocksSinceCompaction >= m_options.blocksPerCompaction || m_queue.empty();
+        lock.unlock();
+
+        uint64_t bytesReclaimed = 0;
+        if (compact)
+        {
+            bytesReclaimed = Compact();
+        }
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+        // Only this thread writes the stats, so they're updated, and logged, without holding up Prune() callers.
+        m_stats.Update([elapsed, compact, bytesReclaimed](Stats& stats) {
+            stats.timeSpent += elapsed;
+            if (compact)
+            {
+                stats.bytesReclaimed += bytesReclaimed;
+                stats.numCompactions++;
+            }
+        });
+
+        if (compact)
+        {
+            const Stats stats = m_stats.Load();
+            LOG_INFO_F(
+                "Pruned blocks below height {}. Removed {} blocks, reclaimed {} bytes in {}ms",
+                stats.prunedHeight, stats.blocksRemoved, stats.bytesReclaimed, stats.timeSpent.count()
+            );
+        }
+
+        lock.lock();
+        if (compact)
+        {
+            m_blocksSinceCompaction = 0;
+        }
+
+        m_working = false;
+        m_idleConditional.notify_all();
+        return !m_conditional.wait_for(lock, m_options.batchInterval, [this] { return m_stop; });
+    }
+
+    void RemoveBlocks(const std::vector<Hash>& hashes, const uint64_t prunedHeight)
+    {
+        DBTransaction transaction = m_pDatabase->CreateTransaction();
+        for (const Hash& hash : hashes)
+        {
+            transaction.Delete(nullptr, m_blockTable, DBTable::ToItemKey(hash));
+        }
+
+        std::vector<DBEntry<PrunedHeight>> entries({
+            DBEntry<PrunedHeight>(PRUNED_HEIGHT_KEY, std::make_shared<const PrunedHeight>(prunedHeight))
+        });
+        transaction.Put(m_stateTable, entries);
+
+        // Waiting for the commit keeps at most one batch of deletes in flight.
+        transaction.Commit();
+    }
+
+    //
+    // Compacts the block table, and returns the number of bytes reclaimed since the first delete after the last compaction.
+    // Blocks written in the meantime count against it, so this is a lower bound.
+    //
+    uint64_t Compact()
+    {
+        m_pDatabase->Compact(m_blockTable);
+        const uint64_t sizeAfter = m_pDatabase->GetApproximateSize(m_blockTable);
+
+        return m_sizeBeforeDeletes > sizeAfter ? m_sizeBeforeDeletes - sizeAfter : 0;
+    }
+
+    static inline const std::string PRUNED_HEIGHT_KEY = "pruned_height";
+
+    Database::Ptr m_pDatabase;
+    DBTable m_blockTable;
+    DBTable m_stateTable;
+    Options m_options;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_conditional;
+    std::condition_variable m_idleConditional;
+    bool m_stop;
+    bool m_working;
+
+    std::deque<Hash> m_queue;
+    uint64_t m_scheduledHeight;
+    uint64_t m_blocksSinceCompaction;
+    SeqLocked<Stats> m_stats;
+
+    // Only used by the pruning thread.
+    uint64_t m_sizeBeforeDeletes;
+
+    std::thread m_thread;
+};
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <mw/core/db/IBlockDB.h>
+
+#include "common/DBSnapshot.h"
+#include "ChainStore.h"
+
+//
+// Snapshot of a BlockDB's database and main chain.
+// UTXO lookups skip the cuckoo filter, since the writer changes it in place.
+//
+class BlockSnapshot : public IBlockSnapshot
+{
+public:
+    BlockSnapshot(const DBSnapshot::CPtr& pDatabase, ChainStore::Snapshot&& chain)
+        : m_pDatabase(pDatabase), m_chain(std::move(chain)) { }
+
+    IHeader::CPtr GetHeaderByHash(const Hash& hash) const noexcept final;
+    std::vector<IHeader::CPtr> GetHeadersByHash(const std::vector<Hash>& hashes) const noexcept final;
+
+    IBlock::CPtr GetBlockByHash(const Hash& hash) const noexcept final;
+    IBlock::CPtr GetBlockByHeight(const uint64_t height) const noexcept final;
+    uint64_t GetNumBlocks() const noexcept final { return m_chain.GetNumBlocks(); }
+
+    std::unordered_map<Commitment, UTXO::CPtr> GetUTXOs(const std::vector<Commitment>& commitments) const noexcept final;
+    std::unordered_map<Commitment, UTXOInfo::CPtr> GetUTXOInfos(const std::vector<Commitment>& commitments) const noexcept final;
+
+private:
+    DBSnapshot::CPtr m_pDatabase;
+    ChainStore::Snapshot m_chain;
+};
\ No newline at end of file
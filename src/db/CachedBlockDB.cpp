@@ -0,0 +1,187 @@
+#include "CachedBlockDB.h"
+
+#include <mw/core/common/Logger.h>
+#include <mw/core/exceptions/DatabaseException.h>
+
+#include <unordered_set>
+
+std::unordered_map<Commitment, UTXO::CPtr> CachedBlockDB::GetUTXOs(const std::vector<Commitment>& commitments) const noexcept
+{
+    std::unordered_map<Commitment, UTXO::CPtr> utxos;
+    std::vector<Commitment> missing;
+
+    for (const Commitment& commitment : commitments)
+    {
+        auto cachedOpt = m_utxoCache.Get(commitment);
+        if (!cachedOpt.has_value())
+        {
+            missing.push_back(commitment);
+        }
+        else if (cachedOpt.value() != nullptr)
+        {
+            utxos.insert({ commitment, cachedOpt.value() });
+        }
+    }
+
+    LOG_TRACE_F("{}/{} UTXO lookups served from cache", commitments.size() - missing.size(), commitments.size());
+
+    if (!missing.empty())
+    {
+        auto found = m_pBlockDB->GetUTXOs(missing);
+        m_utxoCache.Fill(found);
+        utxos.insert(found.cbegin(), found.cend());
+    }
+
+    return utxos;
+}
+
+std::unordered_map<Commitment, UTXOInfo::CPtr> CachedBlockDB::GetUTXOInfos(const std::vector<Commitment>& commitments) const noexcept
+{
+    std::unordered_map<Commitment, UTXOInfo::CPtr> infos;
+    std::vector<Commitment> missing;
+
+    for (const Commitment& commitment : commitments)
+    {
+        auto cachedOpt = m_utxoCache.Get(commitment);
+        if (!cachedOpt.has_value())
+        {
+            missing.push_back(commitment);
+        }
+        else if (cachedOpt.value() != nullptr)
+        {
+            infos.insert({ commitment, UTXOInfo::From(*cachedOpt.value()) });
+        }
+    }
+
+    // The cache holds full UTXOs, so infos read from the database aren't cached.
+    if (!missing.empty())
+    {
+        auto found = m_pBlockDB->GetUTXOInfos(missing);
+        infos.insert(found.cbegin(), found.cend());
+    }
+
+    return infos;
+}
+
+void CachedBlockDB::AddUTXOs(const std::vector<UTXO::CPtr>& utxos)
+{
+    // Outputs the cache doesn't know about are checked against the database, so only the ones it definitely
+    // doesn't have are treated as fresh. The block database's filter rules out most of them without a read.
+    std::vector<Commitment> uncached;
+    for (const UTXO::CPtr& pUTXO : utxos)
+    {
+        const Commitment& commitment = pUTXO->GetOutput().GetCommitment();
+        if (!m_utxoCache.Get(commitment).has_value())
+        {
+            uncached.push_back(commitment);
+        }
+    }
+
+    const auto inDB = uncached.empty() ? std::unordered_map<Commitment, UTXOInfo::CPtr>() : m_pBlockDB->GetUTXOInfos(uncached);
+    std::unordered_set<Commitment> absent;
+    for (const Commitment& commitment : uncached)
+    {
+        if (inDB.find(commitment) == inDB.cend())
+        {
+            absent.insert(commitment);
+        }
+    }
+
+    for (const UTXO::CPtr& pUTXO : utxos)
+    {
+        m_utxoCache.Add(pUTXO, absent.find(pUTXO->GetOutput().GetCommitment()) != absent.cend());
+    }
+
+    CommitIfNotWriting();
+}
+
+void CachedBlockDB::RemoveUTXOs(const std::vector<Commitment>& commitments)
+{
+    // Make sure every UTXO exists before spending any of them.
+    auto utxos = GetUTXOInfos(commitments);
+    for (const Commitment& commitment : commitments)
+    {
+        if (utxos.find(commitment) == utxos.cend())
+        {
+            ThrowDatabase_F("No UTXO found for commitment {}", commitment);
+        }
+    }
+
+    for (const Commitment& commitment : commitments)
+    {
+        m_utxoCache.Spend(commitment);
+    }
+
+    CommitIfNotWriting();
+}
+
+void CachedBlockDB::RemoveAllUTXOs()
+{
+    m_utxoCache.SpendAll();
+
+    CommitIfNotWriting();
+}
+
+void CachedBlockDB::Commit()
+{
+    WriteUTXOs();
+    m_pBlockDB->Commit();
+    m_utxoCache.Commit();
+}
+
+void CachedBlockDB::CommitWith(const std::vector<Traits::IJournaled*>& files)
+{
+    WriteUTXOs();
+    m_pBlockDB->CommitWith(files);
+    m_utxoCache.Commit();
+    SetDirty(false);
+}
+
+void CachedBlockDB::Rollback() noexcept
+{
+    m_utxoCache.Rollback();
+    m_pBlockDB->Rollback();
+}
+
+void CachedBlockDB::OnInitWrite() noexcept
+{
+    m_writing = true;
+    m_pBlockDB->OnInitWrite();
+}
+
+void CachedBlockDB::OnEndWrite() noexcept
+{
+    m_pBlockDB->OnEndWrite();
+    m_writing = false;
+}
+
+void CachedBlockDB::WriteUTXOs()
+{
+    const UTXOCache::Changes changes = m_utxoCache.GetPendingChanges();
+    LOG_DEBUG_F("Writing back {} added and {} removed UTXOs", changes.added.size(), changes.removed.size());
+
+    if (changes.removeAll)
+    {
+        m_pBlockDB->RemoveAllUTXOs();
+    }
+
+    if (!changes.removed.empty())
+    {
+        m_pBlockDB->RemoveUTXOs(changes.removed);
+    }
+
+    if (!changes.added.empty())
+    {
+        m_pBlockDB->AddUTXOs(changes.added);
+    }
+}
+
+void CachedBlockDB::CommitIfNotWriting()
+{
+    // Outside of a write batch, changes are written immediately.
+    if (!m_writing)
+    {
+        WriteUTXOs();
+        m_utxoCache.Commit();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <mw/core/db/IBlockDB.h>
+
+#include "UTXOCache.h"
+
+//
+// Fronts an IBlockDB with an in-memory UTXO cache.
+// UTXO changes are written back to the database in one batch when the block is committed,
+// so outputs created and spent between commits never touch the database.
+//
+class CachedBlockDB : public IBlockDB
+{
+public:
+    CachedBlockDB(const std::shared_ptr<IBlockDB>& pBlockDB, const size_t utxoCacheBytes)
+        : m_pBlockDB(pBlockDB), m_utxoCache(utxoCacheBytes), m_writing(false) { }
+
+    //
+    // Headers
+    //
+    IHeader::CPtr GetHeaderByHash(const Hash& hash) const noexcept final { return m_pBlockDB->GetHeaderByHash(hash); }
+    std::vector<IHeader::CPtr> GetHeadersByHash(const std::vector<Hash>& hashes) const noexcept final { return m_pBlockDB->GetHeadersByHash(hashes); }
+    std::shared_future<void> AddHeader(const IHeader::CPtr& pHeader) final { return m_pBlockDB->AddHeader(pHeader); }
+    std::shared_future<void> AddHeaders(const std::vector<IHeader::CPtr>& headers) final { return m_pBlockDB->AddHeaders(headers); }
+
+    //
+    // Blocks
+    //
+    IBlock::CPtr GetBlockByHash(const Hash& hash) const noexcept final { return m_pBlockDB->GetBlockByHash(hash); }
+    IBlock::CPtr GetBlockByHeight(const uint64_t height) const noexcept final { return m_pBlockDB->GetBlockByHeight(height); }
+    std::shared_future<void> AddBlock(const IBlock::CPtr& pBlock) final { return m_pBlockDB->AddBlock(pBlock); }
+    void RemoveOldBlocks(const uint64_t height) final { m_pBlockDB->RemoveOldBlocks(height); }
+    void AddToMainChain(const IHeader::CPtr& pHeader) final { m_pBlockDB->AddToMainChain(pHeader); }
+    void RewindMainChain(const uint64_t nextHeight) final { m_pBlockDB->RewindMainChain(nextHeight); }
+
+    //
+    // UTXOs
+    //
+    std::unordered_map<Commitment, UTXO::CPtr> GetUTXOs(const std::vector<Commitment>& commitments) const noexcept final;
+    std::unordered_map<Commitment, UTXOInfo::CPtr> GetUTXOInfos(const std::vector<Commitment>& commitments) const noexcept final;
+    void AddUTXOs(const std::vector<UTXO::CPtr>& utxos) final;
+    void RemoveUTXOs(const std::vector<Commitment>& commitments) final;
+    void RemoveAllUTXOs() final;
+
+    void Reconfigure(const Config& config) final { m_pBlockDB->Reconfigure(config); }
+
+    // Cached UTXO changes are written to the block database on commit, so its snapshots already include them.
+    IBlockSnapshot::CPtr CreateSnapshot() const final { return m_pBlockDB->CreateSnapshot(); }
+    void CommitWith(const std::vector<Traits::IJournaled*>& files) final;
+
+    //
+    // Batchable
+    //
+    void Commit() final;
+    void Rollback() noexcept final;
+    void OnInitWrite() noexcept final;
+    void OnEndWrite() noexcept final;
+
+private:
+    void WriteUTXOs();
+    void CommitIfNotWriting();
+
+    std::shared_ptr<IBlockDB> m_pBlockDB;
+    UTXOCache m_utxoCache;
+    bool m_writing;
+};
\ No newline at end of file
@@ -1,13 +1,56 @@
 #include "ChainStore.h"
 
+#include <mw/core/common/Logger.h>
+#include <mw/core/exceptions/DatabaseException.h>
+
 ChainStore::Ptr ChainStore::Load(const FilePath& chainPath)
 {
-    // TODO: Implement
-    return std::make_shared<ChainStore>();
+    auto pHashFile = AppendOnlyFile::Load(chainPath.GetChild("hashes.bin"));
+
+    // A partially written hash can only be left behind by a crash during Commit(), so it's dropped.
+    const uint64_t numHashes = pHashFile->GetSize() / HASH::LENGTH;
+    if (pHashFile->GetSize() != numHashes * HASH::LENGTH)
+    {
+        LOG_WARNING_F("Truncating partial hash at height {}", numHashes);
+        pHashFile->Rewind(numHashes * HASH::LENGTH);
+        pHashFile->Commit();
+    }
+
+    LOG_INFO_F("Loaded chain with {} blocks", numHashes);
+    return std::make_shared<ChainStore>(pHashFile);
 }
 
 tl::optional<Hash> ChainStore::GetHashByHeight(const uint64_t height) const noexcept
 {
-    // TODO: Implement
-    return tl::nullopt;
+    if (height >= GetNumBlocks())
+    {
+        return tl::nullopt;
+    }
+
+    return tl::make_optional(Hash(m_pHashFile->Data(height * HASH::LENGTH, HASH::LENGTH)));
+}
+
+void ChainStore::AddHash(const uint64_t height, const Hash& hash)
+{
+    if (height > GetNumBlocks())
+    {
+        ThrowDatabase_F("Can't add hash at height {} to chain with {} blocks", height, GetNumBlocks());
+    }
+
+    if (height < GetNumBlocks())
+    {
+        m_pHashFile->Rewind(height * HASH::LENGTH);
+    }
+
+    m_pHashFile->Append(hash.vec());
+}
+
+void ChainStore::Rewind(const uint64_t nextHeight)
+{
+    if (nextHeight > GetNumBlocks())
+    {
+        ThrowDatabase_F("Can't rewind chain with {} blocks to height {}", GetNumBlocks(), nextHeight);
+    }
+
+    m_pHashFile->Rewind(nextHeight * HASH::LENGTH);
 }
\ No newline at end of file
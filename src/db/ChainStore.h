@@ -1,15 +1,79 @@
 #pragma once
 
 #include <mw/core/models/block/IHeader.h>
+#include <mw/core/file/AppendOnlyFile.h>
 #include <mw/core/file/FilePath.h>
+#include <mw/core/traits/Journaled.h>
 #include <tl/optional.hpp>
 
-class ChainStore
+//
+// The hashes of the main chain, indexed by height.
+//
+// Stored as a memory-mapped file of 32 byte hashes, so the hash at a height is found at offset height * 32.
+// Changes are buffered until Commit(), and discarded on Rollback().
+//
+class ChainStore : public Traits::IJournaled
 {
 public:
     using Ptr = std::shared_ptr<ChainStore>;
 
+    //
+    // The committed chain, as of when the snapshot was taken.
+    // Unaffected by later writes, so it can be read from any thread without locking.
+    //
+    class Snapshot
+    {
+    public:
+        Snapshot(AppendOnlyFile::Snapshot&& hashFile) : m_hashFile(std::move(hashFile)) { }
+
+        tl::optional<Hash> GetHashByHeight(const uint64_t height) const noexcept
+        {
+            if (height >= GetNumBlocks())
+            {
+                return tl::nullopt;
+            }
+
+            return tl::make_optional(Hash(m_hashFile.Read(height * HASH::LENGTH, HASH::LENGTH)));
+        }
+
+        uint64_t GetNumBlocks() const noexcept { return m_hashFile.GetSize() / HASH::LENGTH; }
+
+    private:
+        AppendOnlyFile::Snapshot m_hashFile;
+    };
+
+    ChainStore(const AppendOnlyFile::Ptr& pHashFile) : m_pHashFile(pHashFile) { }
+
     static ChainStore::Ptr Load(const FilePath& chainPath);
 
     tl::optional<Hash> GetHashByHeight(const uint64_t height) const noexcept;
+
+    //
+    // Number of blocks in the chain, including the genesis block at height 0.
+    //
+    uint64_t GetNumBlocks() const noexcept { return m_pHashFile->GetSize() / HASH::LENGTH; }
+
+    //
+    // Sets the hash at the given height, replacing the hashes at and above it.
+    // DatabaseException thrown if the height is past the end of the chain.
+    //
+    void AddHash(const uint64_t height, const Hash& hash);
+
+    //
+    // Removes the hashes at and above nextHeight, for reorgs.
+    // DatabaseException thrown if nextHeight is past the end of the chain.
+    //
+    void Rewind(const uint64_t nextHeight);
+
+    //
+    // Can be called from any thread, even while another thread is writing.
+    //
+    Snapshot GetSnapshot() const { return Snapshot(m_pHashFile->GetSnapshot()); }
+
+    std::vector<FileWrites> GetPendingWrites() const final { return m_pHashFile->GetPendingWrites(); }
+    void Commit() final { m_pHashFile->Commit(); }
+    void Rollback() noexcept final { m_pHashFile->Rollback(); }
+
+private:
+    AppendOnlyFile::Ptr m_pHashFile;
 };
\ No newline at end of file
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <mw/core/models/tx/UTXO.h>
+#include <tl/optional.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//
+// In-memory UTXO set with write-back to the database.
+//
+// Changes made during a write batch are kept in a pending layer, and are only merged into the cache on Commit().
+// Committed entries always match the database, and are evicted oldest block height first once over the memory budget.
+//
+class UTXOCache
+{
+public:
+    //
+    // The pending changes to write to the database.
+    //
+    struct Changes
+    {
+        bool removeAll;
+        std::vector<UTXO::CPtr> added;
+        std::vector<Commitment> removed;
+    };
+
+    UTXOCache(const size_t maxBytes) : m_maxBytes(maxBytes), m_cachedBytes(0), m_removeAll(false) { }
+
+    //
+    // Returns tl::nullopt if the commitment isn't cached, so the database must be checked.
+    // Returns nullptr if the UTXO is known to be spent.
+    //
+    tl::optional<UTXO::CPtr> Get(const Commitment& commitment) const noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        auto pendingIter = m_pending.find(commitment);
+        if (pendingIter != m_pending.cend())
+        {
+            return tl::make_optional(pendingIter->second.pUTXO);
+        }
+
+        if (m_removeAll)
+        {
+            return tl::make_optional(UTXO::CPtr(nullptr));
+        }
+
+        auto iter = m_entries.find(commitment);
+        if (iter != m_entries.cend())
+        {
+            return tl::make_optional(iter->second.pUTXO);
+        }
+
+        return tl::nullopt;
+    }
+
+    //
+    // Caches UTXOs that were read from the database.
+    //
+    void Fill(const std::unordered_map<Commitment, UTXO::CPtr>& utxos)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if (m_removeAll)
+        {
+            return;
+        }
+
+        for (const auto& utxo : utxos)
+        {
+            if (m_pending.find(utxo.first) == m_pending.cend() && m_entries.find(utxo.first) == m_entries.cend())
+            {
+                m_entries.insert({ utxo.first, Entry({ utxo.second, false }) });
+                m_cachedBytes += EstimateSize(*utxo.second);
+            }
+        }
+
+        Evict();
+    }
+
+    //
+    // absentFromDB must only be true if the database was checked, e.g. with a lookup or a filter that rules it out.
+    //
+    void Add(const UTXO::CPtr& pUTXO, const bool absentFromDB)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        const Commitment& commitment = pUTXO->GetOutput().GetCommitment();
+
+        // A UTXO is fresh if the database doesn't have it, so spending it never has to touch the database.
+        // Anything the database had is removed first after SpendAll(), and a pending entry was already checked when added.
+        bool fresh = absentFromDB || m_removeAll;
+        auto pendingIter = m_pending.find(commitment);
+        if (pendingIter != m_pending.cend())
+        {
+            fresh = pendingIter->second.fresh;
+        }
+
+        m_pending[commitment] = Entry({ pUTXO, fresh });
+    }
+
+    //
+    // Marks the UTXO as spent. The caller must have checked that the UTXO exists.
+    //
+    void Spend(const Commitment& commitment)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        auto pendingIter = m_pending.find(commitment);
+        if (pendingIter != m_pending.end())
+        {
+            if (pendingIter->second.fresh)
+            {
+                // Created and spent without being written, so there's nothing to remove from the database.
+                m_pending.erase(pendingIter);
+            }
+            else
+            {
+                pendingIter->second = Entry({ nullptr, false });
+            }
+        }
+        else
+        {
+            m_pending.insert({ commitment, Entry({ nullptr, false }) });
+        }
+    }
+
+    void SpendAll()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_pending.clear();
+        m_removeAll = true;
+    }
+
+    Changes GetPendingChanges() const
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        Changes changes({ m_removeAll, {}, {} });
+        for (const auto& pending : m_pending)
+        {
+            if (pending.second.pUTXO != nullptr)
+            {
+                changes.added.push_back(pending.second.pUTXO);
+            }
+            else if (!pending.second.fresh)
+            {
+                changes.removed.push_back(pending.first);
+            }
+        }
+
+        return changes;
+    }
+
+    //
+    // Merges the pending changes into the cache, once they've been written to the database.
+    //
+    void Commit()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if (m_removeAll)
+        {
+            m_entries.clear();
+            m_cachedBytes = 0;
+            m_removeAll = false;
+        }
+
+        for (auto& pending : m_pending)
+        {
+            auto iter = m_entries.find(pending.first);
+            if (iter != m_entries.end())
+            {
+                m_cachedBytes -= EstimateSize(*iter->second.pUTXO);
+                m_entries.erase(iter);
+            }
+
+            if (pending.second.pUTXO != nullptr)
+            {
+                m_cachedBytes += EstimateSize(*pending.second.pUTXO);
+                m_entries.insert({ pending.first, Entry({ std::move(pending.second.pUTXO), false }) });
+            }
+        }
+
+        m_pending.clear();
+        Evict();
+    }
+
+    void Rollback() noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_pending.clear();
+        m_removeAll = false;
+    }
+
+    size_t GetCachedBytes() const noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_cachedBytes;
+    }
+
+private:
+    struct Entry
+    {
+        // The UTXO, or nullptr if spent.
+        UTXO::CPtr pUTXO;
+
+        // Whether the database has never seen this UTXO.
+        bool fresh;
+    };
+
+    static size_t EstimateSize(const UTXO& utxo) noexcept
+    {
+        // Hash node, key, entry and UTXO, plus the range proof bytes.
+        return 64 + sizeof(Commitment) + sizeof(Entry) + sizeof(UTXO) + utxo.GetOutput().GetRangeProof()->size();
+    }
+
+    //
+    // Evicts the entries with the lowest block heights until 3/4 of the budget is used, so eviction is amortized.
+    //
+    void Evict()
+    {
+        if (m_cachedBytes <= m_maxBytes)
+        {
+            return;
+        }
+
+        std::vector<std::pair<uint64_t, const Commitment*>> byHeight;
+        byHeight.reserve(m_entries.size());
+        for (const auto& entry : m_entries)
+        {
+            byHeight.push_back({ entry.second.pUTXO->GetBlockHeight(), &entry.first });
+        }
+
+        std::sort(
+            byHeight.begin(), byHeight.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; }
+        );
+
+        const size_t targetBytes = (m_maxBytes / 4) * 3;
+        size_t numEvicted = 0;
+        while (m_cachedBytes > targetBytes && numEvicted < byHeight.size())
+        {
+            auto iter = m_entries.find(*byHeight[numEvicted++].second);
+            m_cachedBytes -= EstimateSize(*iter->second.pUTXO);
+            m_entries.erase(iter);
+        }
+    }
+
+    mutable std::mutex m_mutex;
+    size_t m_maxBytes;
+    size_t m_cachedBytes;
+
+    // Clean entries, matching the database.
+    std::unordered_map<Commitment, Entry> m_entries;
+
+    // Dirty entries, written to the database on commit.
+    std::unordered_map<Commitment, Entry> m_pending;
+    bool m_removeAll;
+};
\ No newline at end of file
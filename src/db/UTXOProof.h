@@ -0,0 +1,32 @@
+#pragma once
+
+#include <mw/core/Context.h>
+#include <mw/core/models/crypto/RangeProof.h>
+#include <mw/core/traits/Serializable.h>
+#include <mw/core/serialization/Serializer.h>
+
+//
+// The cold part of a UTXO, stored apart from the UTXOInfo index since it's only needed to rebuild the full output.
+//
+class UTXOProof : public Traits::ISerializable
+{
+public:
+    using CPtr = std::shared_ptr<const UTXOProof>;
+
+    UTXOProof(const RangeProof::CPtr& pProof) : m_pProof(pProof) { }
+
+    const RangeProof::CPtr& GetRangeProof() const noexcept { return m_pProof; }
+
+    Serializer& Serialize(Serializer& serializer) const noexcept final
+    {
+        return serializer.Append(m_pProof);
+    }
+
+    static UTXOProof::CPtr Deserialize(const Context::CPtr&, Deserializer& deserializer)
+    {
+        return std::make_shared<const UTXOProof>(std::make_shared<const RangeProof>(RangeProof::Deserialize(deserializer)));
+    }
+
+private:
+    RangeProof::CPtr m_pProof;
+};
\ No newline at end of file
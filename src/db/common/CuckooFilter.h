@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+//
+// Approximate set membership with support for deletion.
+// MayContain() never returns false for an inserted key, and returns true for a missing key roughly 0.01% of the time.
+//
+// Each key is stored as a 16 bit fingerprint in one of two buckets of 4 slots.
+// Fingerprints that can't be placed are kept in a small exact stash, so inserts never fail.
+// When the stash grows past STASH_LIMIT, the filter is overloaded and should be rebuilt with a larger capacity.
+//
+class CuckooFilter
+{
+public:
+    CuckooFilter(const size_t capacity)
+        : m_buckets(NumBuckets(capacity)), m_mask(m_buckets.size() - 1), m_size(0) { }
+
+    void Insert(const uint8_t* pKey, const size_t length)
+    {
+        const uint64_t hash = Hash(pKey, length);
+        uint16_t fingerprint = Fingerprint(hash);
+        size_t index = hash & m_mask;
+        ++m_size;
+
+        if (TryInsert(index, fingerprint) || TryInsert(AltIndex(index, fingerprint), fingerprint))
+        {
+            return;
+        }
+
+        // Both buckets are full, so evict fingerprints to their alternate buckets.
+        for (size_t kick = 0; kick < MAX_KICKS; kick++)
+        {
+            std::swap(fingerprint, m_buckets[index][kick % BUCKET_SIZE]);
+            index = AltIndex(index, fingerprint);
+            if (TryInsert(index, fingerprint))
+            {
+                return;
+            }
+        }
+
+        m_stash[StashKey(index, fingerprint)]++;
+    }
+
+    bool MayContain(const uint8_t* pKey, const size_t length) const noexcept
+    {
+        const uint64_t hash = Hash(pKey, length);
+        const uint16_t fingerprint = Fingerprint(hash);
+        const size_t index1 = hash & m_mask;
+        const size_t index2 = AltIndex(index1, fingerprint);
+
+        return Contains(index1, fingerprint)
+            || Contains(index2, fingerprint)
+            || (!m_stash.empty() && m_stash.find(StashKey(index1, fingerprint)) != m_stash.cend());
+    }
+
+    //
+    // Removes one copy of a key. The key must have been inserted, otherwise another key may be removed.
+    //
+    void Erase(const uint8_t* pKey, const size_t length) noexcept
+    {
+        const uint64_t hash = Hash(pKey, length);
+        const uint16_t fingerprint = Fingerprint(hash);
+        const size_t index1 = hash & m_mask;
+
+        if (TryErase(index1, fingerprint) || TryErase(AltIndex(index1, fingerprint), fingerprint))
+        {
+            --m_size;
+            return;
+        }
+
+        auto iter = m_stash.find(StashKey(index1, fingerprint));
+        if (iter != m_stash.end())
+        {
+            --m_size;
+            if (--iter->second == 0)
+            {
+                m_stash.erase(iter);
+            }
+        }
+    }
+
+    void Clear() noexcept
+    {
+        std::fill(m_buckets.begin(), m_buckets.end(), Bucket());
+        m_stash.clear();
+        m_size = 0;
+    }
+
+    size_t Size() const noexcept { return m_size; }
+    size_t GetCapacity() const noexcept { return m_buckets.size() * BUCKET_SIZE; }
+    bool IsOverloaded() const noexcept { return m_stash.size() > STASH_LIMIT; }
+
+private:
+    static constexpr size_t BUCKET_SIZE = 4;
+    static constexpr size_t MAX_KICKS = 500;
+    static constexpr size_t STASH_LIMIT = 1024;
+
+    // 0 marks an empty slot.
+    using Bucket = std::array<uint16_t, BUCKET_SIZE>;
+
+    // Number of buckets for the capacity at a 90% load factor, rounded up to a power of 2.
+    static size_t NumBuckets(const size_t capacity) noexcept
+    {
+        const size_t minBuckets = (capacity * 10) / (BUCKET_SIZE * 9) + 1;
+
+        size_t numBuckets = 1;
+        while (numBuckets < minBuckets)
+        {
+            numBuckets <<= 1;
+        }
+
+        return numBuckets;
+    }
+
+    static uint64_t Hash(const uint8_t* pKey, const size_t length) noexcept
+    {
+        return (uint64_t)std::hash<std::string_view>()(std::string_view((const char*)pKey, length));
+    }
+
+    static uint16_t Fingerprint(const uint64_t hash) noexcept
+    {
+        const uint16_t fingerprint = (uint16_t)(hash >> 48);
+        return fingerprint != 0 ? fingerprint : 1;
+    }
+
+    // Partial-key cuckoo hashing: each bucket index is recoverable from the other and the fingerprint.
+    size_t AltIndex(const size_t index, const uint16_t fingerprint) const noexcept
+    {
+        return (index ^ ((size_t)fingerprint * 0x5bd1e995)) & m_mask;
+    }
+
+    // Stash entries are keyed by the smaller of the two bucket indices, so either index finds them.
+    uint64_t StashKey(const size_t index, const uint16_t fingerprint) const noexcept
+    {
+        const size_t minIndex = std::min(index, AltIndex(index, fingerprint));
+        return ((uint64_t)minIndex << 16) | fingerprint;
+    }
+
+    bool Contains(const size_t index, const uint16_t fingerprint) const noexcept
+    {
+        const Bucket& bucket = m_buckets[index];
+        return bucket[0] == fingerprint || bucket[1] == fingerprint || bucket[2] == fingerprint || bucket[3] == fingerprint;
+    }
+
+    bool TryInsert(const size_t index, const uint16_t fingerprint) noexcept
+    {
+        for (uint16_t& slot : m_buckets[index])
+        {
+            if (slot == 0)
+            {
+                slot = fingerprint;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool TryErase(const size_t index, const uint16_t fingerprint) noexcept
+    {
+        for (uint16_t& slot : m_buckets[index])
+        {
+            if (slot == fingerprint)
+            {
+                slot = 0;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    std::vector<Bucket> m_buckets;
+    size_t m_mask;
+    size_t m_size;
+    std::unordered_map<uint64_t, size_t> m_stash;
+};
\ No newline at end of file
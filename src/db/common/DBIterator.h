@@ -0,0 +1,188 @@
+#pragma once
+
+#include "DBWriter.h"
+
+#include <mw/core/Context.h>
+#include <mw/core/exceptions/DatabaseException.h>
+#include <mw/core/serialization/Deserializer.h>
+#include <mw/core/traits/Serializable.h>
+#include <leveldb/db.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+//
+// Streams the entries of a key range in key order.
+//
+// Entries come from a LevelDB snapshot, with pending writes laid over it, so writes that haven't reached the DB yet
+// are seen without flushing. At most readahead entries are read ahead of the caller,
+// and values are only deserialized when asked for, so a key-only scan never decodes anything.
+//
+// The iterator holds the DB open, so it may outlive the Database it came from, but Database::Reopen() fails until it's released.
+//
+class DBIterator
+{
+public:
+    struct Options
+    {
+        static Options Default() { return Options({ 64, false }); }
+
+        // Maximum number of entries read ahead of the caller.
+        size_t readahead;
+
+        // Whether blocks read by the scan are added to the LevelDB block cache.
+        // Off by default, so a long scan doesn't evict the blocks of hot point lookups.
+        bool fillCache;
+    };
+
+    //
+    // Iterates over [begin, end) of the DB snapshot, with the overlay's writes taking precedence.
+    // The overlay must be sorted by key, and hold at most one write per key. Null items are deletes.
+    //
+    DBIterator(
+        const Context::CPtr& pContext,
+        const std::shared_ptr<leveldb::DB>& pDB,
+        const std::shared_ptr<const leveldb::Snapshot>& pSnapshot,
+        const std::string& begin,
+        std::string&& end,
+        const size_t prefixLength,
+        std::vector<DBWriter::PendingWrite>&& overlay,
+        const Options& options)
+        : m_pContext(pContext),
+        m_pSnapshot(pSnapshot),
+        m_end(std::move(end)),
+        m_prefixLength(prefixLength),
+        m_overlay(std::move(overlay)),
+        m_overlayIndex(0),
+        m_readahead(std::max<size_t>(options.readahead, 1)),
+        m_position(0)
+    {
+        leveldb::ReadOptions readOptions;
+        readOptions.snapshot = m_pSnapshot.get();
+        readOptions.fill_cache = options.fillCache;
+
+        m_pIter.reset(pDB->NewIterator(readOptions));
+        m_pIter->Seek(begin);
+        ReadAhead();
+    }
+
+    DBIterator(DBIterator&&) = default;
+
+    bool Valid() const noexcept { return m_position < m_buffer.size(); }
+
+    void Next()
+    {
+        if (++m_position == m_buffer.size())
+        {
+            ReadAhead();
+        }
+    }
+
+    //
+    // The item key of the current entry, without the table prefix.
+    //
+    std::string GetKey() const { return m_buffer[m_position].key.substr(m_prefixLength); }
+
+    //
+    // The current entry's item, deserialized on first use.
+    // Returns nullptr if the item isn't a T.
+    //
+    template<typename T,
+        typename SFINAE = typename std::enable_if_t<std::is_base_of_v<Traits::ISerializable, T>>>
+    std::shared_ptr<const T> GetItem()
+    {
+        Entry& entry = m_buffer[m_position];
+        if (entry.pItem == nullptr)
+        {
+            Deserializer deserializer(std::vector<uint8_t>(entry.value.cbegin(), entry.value.cend()));
+            entry.pItem = T::Deserialize(m_pContext, deserializer);
+        }
+
+        return std::dynamic_pointer_cast<const T>(entry.pItem);
+    }
+
+private:
+    struct Entry
+    {
+        std::string key;
+
+        // The serialized item read from the DB. Empty for items from the overlay.
+        std::string value;
+
+        // The deserialized item, or nullptr if not deserialized yet.
+        std::shared_ptr<const Traits::ISerializable> pItem;
+    };
+
+    bool IsDBValid() const { return m_pIter->Valid() && m_pIter->key().compare(m_end) < 0; }
+    bool IsOverlayValid() const noexcept { return m_overlayIndex < m_overlay.size() && m_overlay[m_overlayIndex].first < m_end; }
+
+    //
+    // Merges the next readahead entries from the DB and the overlay into the buffer.
+    //
+    void ReadAhead()
+    {
+        m_buffer.clear();
+        m_position = 0;
+
+        while (m_buffer.size() < m_readahead)
+        {
+            const bool dbValid = IsDBValid();
+            const bool overlayValid = IsOverlayValid();
+            if (!dbValid && !overlayValid)
+            {
+                break;
+            }
+
+            int compare = 1;
+            if (dbValid && overlayValid)
+            {
+                compare = m_pIter->key().compare(m_overlay[m_overlayIndex].first);
+            }
+            else if (dbValid)
+            {
+                compare = -1;
+            }
+
+            if (compare < 0)
+            {
+                m_buffer.push_back(Entry({ m_pIter->key().ToString(), m_pIter->value().ToString(), nullptr }));
+                m_pIter->Next();
+                continue;
+            }
+
+            // The overlay is newer than the snapshot, so it wins ties.
+            DBWriter::PendingWrite& write = m_overlay[m_overlayIndex++];
+            if (compare == 0)
+            {
+                m_pIter->Next();
+            }
+
+            if (write.second != nullptr)
+            {
+                m_buffer.push_back(Entry({ std::move(write.first), std::string(), std::move(write.second) }));
+            }
+        }
+
+        if (!m_pIter->status().ok())
+        {
+            ThrowDatabase_F("Iteration failed with status {}", m_pIter->status().ToString());
+        }
+    }
+
+    Context::CPtr m_pContext;
+    // Holds the DB open, and is released after the iterator.
+    std::shared_ptr<const leveldb::Snapshot> m_pSnapshot;
+    std::unique_ptr<leveldb::Iterator> m_pIter;
+    std::string m_end;
+    size_t m_prefixLength;
+
+    std::vector<DBWriter::PendingWrite> m_overlay;
+    size_t m_overlayIndex;
+
+    size_t m_readahead;
+    std::vector<Entry> m_buffer;
+    size_t m_position;
+};
\ No newline at end of file
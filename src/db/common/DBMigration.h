@@ -0,0 +1,195 @@
+#pragma once
+
+#include "DBTable.h"
+
+#include <mw/core/common/Logger.h>
+#include <mw/core/exceptions/DatabaseException.h>
+#include <mw/core/serialization/Deserializer.h>
+#include <mw/core/serialization/Serializer.h>
+#include <mw/core/util/HexUtil.h>
+#include <leveldb/db.h>
+#include <leveldb/write_batch.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+//
+// Upgrades the key encoding of existing databases when they are opened.
+//
+// Version 0: Item keys are hex strings.
+// Version 1: Item keys are raw bytes (see DBTable::BuildKey).
+// Version 2: UTXOs are split into an index of UTXOInfos ('U'), and their range proofs ('P').
+//
+class DBMigration
+{
+public:
+    static constexpr uint32_t CURRENT_VERSION = 2;
+
+    static void Migrate(leveldb::DB* pDB)
+    {
+        const uint32_t version = GetVersion(pDB);
+        if (version == CURRENT_VERSION)
+        {
+            return;
+        }
+
+        if (version > CURRENT_VERSION)
+        {
+            ThrowDatabase_F("Database version {} is newer than supported version {}", version, CURRENT_VERSION);
+        }
+
+        LOG_INFO_F("Migrating database from version {} to {}", version, CURRENT_VERSION);
+
+        leveldb::WriteBatch batch;
+        if (version == 0)
+        {
+            MigrateHexKeys(pDB, batch);
+            Write(pDB, batch, false);
+            batch.Clear();
+        }
+
+        if (version <= 1)
+        {
+            SplitUTXOs(pDB, batch);
+        }
+
+        // The version is written with the last batch, so an interrupted migration is resumed on next open.
+        Serializer serializer;
+        serializer.Append<uint32_t>(CURRENT_VERSION);
+        batch.Put(META_TABLE.BuildKey(VERSION_KEY), leveldb::Slice((const char*)serializer.data(), serializer.size()));
+        Write(pDB, batch, true);
+
+        LOG_INFO("Database migration complete");
+    }
+
+    static uint32_t GetVersion(leveldb::DB* pDB)
+    {
+        std::string versionStr;
+        leveldb::Status status = pDB->Get(leveldb::ReadOptions(), META_TABLE.BuildKey(VERSION_KEY), &versionStr);
+        if (status.IsNotFound())
+        {
+            return 0;
+        }
+        else if (!status.ok())
+        {
+            ThrowDatabase_F("Failed to read database version. Status: {}", status.ToString());
+        }
+
+        Deserializer deserializer(std::vector<uint8_t>(versionStr.cbegin(), versionStr.cend()));
+        return deserializer.Read<uint32_t>();
+    }
+
+private:
+    //
+    // Rewrites every "<prefix><hex>" key as "<prefix><bytes>".
+    // Keys already in binary form are left alone, so a partially migrated database can be migrated again.
+    //
+    static void MigrateHexKeys(leveldb::DB* pDB, leveldb::WriteBatch& batch)
+    {
+        size_t numMigrated = 0;
+
+        std::unique_ptr<leveldb::Iterator> pIter(pDB->NewIterator(leveldb::ReadOptions()));
+        for (pIter->SeekToFirst(); pIter->Valid(); pIter->Next())
+        {
+            const leveldb::Slice key = pIter->key();
+            if (key.size() < 3 || key[0] == META_PREFIX)
+            {
+                continue;
+            }
+
+            const std::string itemKey(key.data() + 1, key.size() - 1);
+            if (itemKey.size() % 2 != 0 || !HexUtil::IsValidHex(itemKey))
+            {
+                continue;
+            }
+
+            const std::vector<uint8_t> bytes = HexUtil::FromHex(itemKey);
+            std::string binaryKey(1, key[0]);
+            binaryKey.append((const char*)bytes.data(), bytes.size());
+
+            batch.Put(binaryKey, pIter->value());
+            batch.Delete(key);
+
+            if (++numMigrated % BATCH_SIZE == 0)
+            {
+                Write(pDB, batch, false);
+                batch.Clear();
+                LOG_DEBUG_F("Migrated {} keys", numMigrated);
+            }
+        }
+
+        if (!pIter->status().ok())
+        {
+            ThrowDatabase_F("Migration failed with status {}", pIter->status().ToString());
+        }
+
+        LOG_INFO_F("Migrated {} hex keys to binary", numMigrated);
+    }
+
+    //
+    // Splits each serialized UTXO (height, leaf index, features, commitment, proof) into
+    // its UTXOInfo (height, leaf index, features) and its proof. The commitment is already the key.
+    // Values already split are left alone, so a partially migrated database can be migrated again.
+    //
+    static void SplitUTXOs(leveldb::DB* pDB, leveldb::WriteBatch& batch)
+    {
+        size_t numMigrated = 0;
+
+        const std::string prefix(1, UTXO_PREFIX);
+        std::unique_ptr<leveldb::Iterator> pIter(pDB->NewIterator(leveldb::ReadOptions()));
+        for (pIter->Seek(prefix); pIter->Valid() && pIter->key().starts_with(prefix); pIter->Next())
+        {
+            const leveldb::Slice value = pIter->value();
+            if (value.size() <= UTXO_PROOF_OFFSET)
+            {
+                continue;
+            }
+
+            std::string proofKey = pIter->key().ToString();
+            proofKey[0] = PROOF_PREFIX;
+
+            batch.Put(proofKey, leveldb::Slice(value.data() + UTXO_PROOF_OFFSET, value.size() - UTXO_PROOF_OFFSET));
+            batch.Put(pIter->key(), leveldb::Slice(value.data(), UTXO_INFO_SIZE));
+
+            if (++numMigrated % BATCH_SIZE == 0)
+            {
+                Write(pDB, batch, false);
+                batch.Clear();
+                LOG_DEBUG_F("Split {} UTXOs", numMigrated);
+            }
+        }
+
+        if (!pIter->status().ok())
+        {
+            ThrowDatabase_F("Migration failed with status {}", pIter->status().ToString());
+        }
+
+        LOG_INFO_F("Split {} UTXOs into index and proof", numMigrated);
+    }
+
+    static void Write(leveldb::DB* pDB, leveldb::WriteBatch& batch, const bool sync)
+    {
+        leveldb::WriteOptions writeOptions;
+        writeOptions.sync = sync;
+
+        leveldb::Status status = pDB->Write(writeOptions, &batch);
+        if (!status.ok())
+        {
+            ThrowDatabase_F("Migration failed with status {}", status.ToString());
+        }
+    }
+
+    static constexpr size_t BATCH_SIZE = 10000;
+    static constexpr char META_PREFIX = 'M';
+    static constexpr char UTXO_PREFIX = 'U';
+    static constexpr char PROOF_PREFIX = 'P';
+
+    // Height, leaf index and features.
+    static constexpr size_t UTXO_INFO_SIZE = 17;
+
+    // The proof follows the UTXOInfo and the 33 byte commitment.
+    static constexpr size_t UTXO_PROOF_OFFSET = UTXO_INFO_SIZE + 33;
+    static inline const DBTable META_TABLE = { META_PREFIX };
+    static inline const std::string VERSION_KEY = "version";
+};
\ No newline at end of file
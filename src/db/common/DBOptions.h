@@ -0,0 +1,115 @@
+#pragma once
+
+#include "DBWriter.h"
+
+#include <mw/core/common/Logger.h>
+#include <mw/core/config/Config.h>
+#include <leveldb/cache.h>
+#include <leveldb/options.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+//
+// Tunable database options, grouped into profiles.
+//
+// "sync" is for initial sync: a large write buffer and relaxed syncing, so bulk ingest isn't bound by flushes and fsyncs.
+// "steady" is for normal operation: every group commit is synced, and memory goes to the read caches instead.
+//
+// Read from Config with FromConfig(). Keys (all optional):
+//   db.profile             "sync" or "steady" (default: steady)
+//   db.block_cache_mb      LevelDB block cache size
+//   db.write_buffer_mb     LevelDB memtable size
+//   db.max_open_files      LevelDB table file handle limit
+//   db.object_cache_mb     Cache of deserialized headers and blocks
+//   db.sync                "true" or "false", whether each group commit is synced
+//   db.flush_latency_ms    How long a write may wait for others to join its group commit
+//
+struct DBOptions
+{
+    static DBOptions Steady()
+    {
+        return DBOptions({ "steady", 64 * MB, 4 * MB, 1000, 32 * MB, DBWriter::Options::Default() });
+    }
+
+    static DBOptions Sync()
+    {
+        // Anything lost to a crash with sync off is downloaded again, so bulk ingest doesn't pay for fsyncs.
+        return DBOptions({ "sync", 16 * MB, 64 * MB, 500, 8 * MB, DBWriter::Options({ std::chrono::milliseconds(50), 16 * MB, false }) });
+    }
+
+    static DBOptions FromConfig(const Config& config)
+    {
+        const std::string profile = config.Get("db.profile", "steady");
+        if (profile != "steady" && profile != "sync")
+        {
+            LOG_WARNING_F("Unknown db.profile {}. Using steady.", profile);
+        }
+
+        DBOptions options = profile == "sync" ? Sync() : Steady();
+        options.blockCacheBytes = GetSize(config, "db.block_cache_mb", options.blockCacheBytes);
+        options.writeBufferBytes = GetSize(config, "db.write_buffer_mb", options.writeBufferBytes);
+        options.maxOpenFiles = (int)GetNumber(config, "db.max_open_files", options.maxOpenFiles);
+        options.objectCacheBytes = GetSize(config, "db.object_cache_mb", options.objectCacheBytes);
+        options.writer.flushLatency = std::chrono::milliseconds(GetNumber(config, "db.flush_latency_ms", options.writer.flushLatency.count()));
+
+        const std::string sync = config.Get("db.sync");
+        if (!sync.empty())
+        {
+            options.writer.sync = sync == "true";
+        }
+
+        return options;
+    }
+
+    //
+    // Applies the LevelDB settings. The caller owns the block cache, and must delete it after closing the DB.
+    //
+    void Apply(leveldb::Options& leveldbOptions) const
+    {
+        leveldbOptions.block_cache = blockCacheBytes > 0 ? leveldb::NewLRUCache(blockCacheBytes) : nullptr;
+        leveldbOptions.write_buffer_size = writeBufferBytes;
+        leveldbOptions.max_open_files = maxOpenFiles;
+    }
+
+    //
+    // Reads an optional numeric key. A missing value means the default, and an invalid one is logged and replaced by it.
+    //
+    static uint64_t GetNumber(const Config& config, const std::string& key, const uint64_t defaultValue)
+    {
+        const std::string value = config.Get(key);
+        if (value.empty())
+        {
+            return defaultValue;
+        }
+
+        try
+        {
+            return std::stoull(value);
+        }
+        catch (std::exception&)
+        {
+            LOG_WARNING_F("Invalid value {} for {}. Using {}.", value, key, defaultValue);
+            return defaultValue;
+        }
+    }
+
+    //
+    // Reads an optional size, configured in MB, and returns it in bytes.
+    //
+    static size_t GetSize(const Config& config, const std::string& key, const size_t defaultBytes)
+    {
+        return (size_t)GetNumber(config, key, defaultBytes / MB) * MB;
+    }
+
+    std::string profile;
+    size_t blockCacheBytes;
+    size_t writeBufferBytes;
+    int maxOpenFiles;
+    size_t objectCacheBytes;
+    DBWriter::Options writer;
+
+private:
+    static constexpr size_t MB = 1024 * 1024;
+};
\ No newline at end of file
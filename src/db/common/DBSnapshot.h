@@ -0,0 +1,125 @@
+#pragma once
+
+#include "DBTable.h"
+#include "DBEntry.h"
+#include "DBIterator.h"
+#include "DBWriter.h"
+
+#include <mw/core/Context.h>
+#include <mw/core/exceptions/DatabaseException.h>
+#include <mw/core/serialization/Deserializer.h>
+#include <leveldb/db.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+//
+// A read-only view of everything committed to the Database before the snapshot was taken.
+//
+// Writes committed afterwards, and writes in a batch that hasn't been committed, are never seen,
+// so a reader sees one consistent state however long it holds the snapshot.
+// Taking and reading a snapshot never waits on a writer, and snapshots can be shared across threads.
+//
+// Reads skip the ObjectCache, since it holds the latest committed objects, which may be newer than the snapshot.
+// The snapshot holds the DB open, so it may outlive the Database it came from, but Database::Reopen() fails until it's released.
+//
+class DBSnapshot
+{
+public:
+    using CPtr = std::shared_ptr<const DBSnapshot>;
+
+    DBSnapshot(
+        const Context::CPtr& pContext,
+        const std::shared_ptr<leveldb::DB>& pDB,
+        const std::shared_ptr<const leveldb::Snapshot>& pSnapshot,
+        DBWriter::PendingMap&& pending)
+        : m_pContext(pContext), m_pDB(pDB), m_pSnapshot(pSnapshot), m_pending(std::move(pending)) { }
+
+    template<typename T,
+        typename SFINAE = typename std::enable_if_t<std::is_base_of_v<Traits::ISerializable, T>>>
+    std::unique_ptr<DBEntry<T>> Get(const DBTable& table, const std::string& key) const
+    {
+        const std::string dbKey = table.BuildKey(key);
+
+        auto iter = m_pending.find(dbKey);
+        if (iter != m_pending.cend())
+        {
+            auto pObject = std::dynamic_pointer_cast<const T>(iter->second);
+            return pObject != nullptr ? std::make_unique<DBEntry<T>>(key, pObject) : nullptr;
+        }
+
+        leveldb::ReadOptions readOptions;
+        readOptions.snapshot = m_pSnapshot.get();
+
+        std::string itemStr;
+        leveldb::Status status = m_pDB->Get(readOptions, dbKey, &itemStr);
+        if (status.ok())
+        {
+            Deserializer deserializer(std::vector<uint8_t>(itemStr.cbegin(), itemStr.cend()));
+            return std::make_unique<DBEntry<T>>(key, T::Deserialize(m_pContext, deserializer));
+        }
+        else if (!status.IsNotFound())
+        {
+            ThrowDatabase_F("Snapshot read failed with status {}", status.ToString());
+        }
+
+        return nullptr;
+    }
+
+    //
+    // Returns an entry per key, in the same order as the keys, with nullptr for keys that weren't found.
+    //
+    template<typename T,
+        typename SFINAE = typename std::enable_if_t<std::is_base_of_v<Traits::ISerializable, T>>>
+    std::vector<std::unique_ptr<DBEntry<T>>> MultiGet(const DBTable& table, const std::vector<std::string>& keys) const
+    {
+        std::vector<std::unique_ptr<DBEntry<T>>> entries;
+        entries.reserve(keys.size());
+        for (const std::string& key : keys)
+        {
+            entries.push_back(Get<T>(table, key));
+        }
+
+        return entries;
+    }
+
+    //
+    // Like Database::Scan, but over the snapshot.
+    //
+    DBIterator Scan(
+        const DBTable& table,
+        const std::string& begin = "",
+        const std::string& end = "",
+        const DBIterator::Options& options = DBIterator::Options::Default()) const
+    {
+        const std::string dbBegin = table.BuildKey(begin);
+        std::string dbEnd = end.empty() ? table.GetEndKey() : table.BuildKey(end);
+
+        std::vector<DBWriter::PendingWrite> overlay;
+        for (const auto& pending : m_pending)
+        {
+            if (pending.first >= dbBegin && pending.first < dbEnd)
+            {
+                overlay.push_back(pending);
+            }
+        }
+
+        std::sort(
+            overlay.begin(), overlay.end(),
+            [](const DBWriter::PendingWrite& lhs, const DBWriter::PendingWrite& rhs) { return lhs.first < rhs.first; }
+        );
+
+        // Item keys start after the 1 byte table prefix.
+        return DBIterator(m_pContext, m_pDB, m_pSnapshot, dbBegin, std::move(dbEnd), 1, std::move(overlay), options);
+    }
+
+private:
+    Context::CPtr m_pContext;
+    std::shared_ptr<leveldb::DB> m_pDB;
+    std::shared_ptr<const leveldb::Snapshot> m_pSnapshot;
+
+    // Committed writes that weren't in the DB yet when the snapshot was taken.
+    DBWriter::PendingMap m_pending;
+};
\ No newline at end of file
@@ -12,24 +12,74 @@ class DBTable
 public:
     struct Options
     {
-        static Options Default() { return Options({ false }); }
+        static Options Default() { return Options({ false, false }); }
 
         // Can there be multiple entries per key?
         bool allowDuplicates;
+
+        // Should deserialized objects be kept in the Database's ObjectCache?
+        bool cached;
     };
 
     DBTable(const char prefix, const Options& options = Options::Default())
         : m_prefix(prefix), m_options(options)
     {
-        assert(!m_prefix.empty());
+        assert(m_prefix != '\0');
+    }
+
+    //
+    // Builds the key for a binary item key, like a hash or commitment.
+    // Keys are the table prefix followed by the raw bytes, so a 32 byte hash takes 33 bytes instead of 65 as hex.
+    //
+    std::string BuildKey(const uint8_t* pItemKey, const size_t length) const noexcept
+    {
+        std::string key;
+        key.reserve(length + 1);
+        key.push_back(m_prefix);
+        key.append((const char*)pItemKey, length);
+        return key;
     }
 
-    std::string BuildKey(const std::string& itemKey) const noexcept { return m_prefix + itemKey; }
+    char GetPrefix() const noexcept { return m_prefix; }
+
+    std::string BuildKey(const std::string& itemKey) const noexcept { return BuildKey((const uint8_t*)itemKey.data(), itemKey.size()); }
 
     template<typename T,
         typename SFINAE = typename std::enable_if_t<std::is_base_of_v<Traits::ISerializable, T>>>
     std::string BuildKey(const DBEntry<T>& item) const noexcept { return BuildKey(item.key); }
 
+    //
+    // Converts fixed-width binary values (Hash, Commitment, etc.) to an item key.
+    //
+    template<typename T>
+    static std::string ToItemKey(const T& value) noexcept { return std::string((const char*)value.data(), value.size()); }
+
+    //
+    // The first key past the end of the table.
+    //
+    std::string GetEndKey() const noexcept { return std::string(1, (char)(m_prefix + 1)); }
+
+    //
+    // The first key past every key starting with the prefix, or an empty string if there is none.
+    //
+    static std::string GetPrefixEnd(const std::string& prefix) noexcept
+    {
+        std::string end = prefix;
+        while (!end.empty() && (uint8_t)end.back() == 0xff)
+        {
+            end.pop_back();
+        }
+
+        if (!end.empty())
+        {
+            end.back() = (char)((uint8_t)end.back() + 1);
+        }
+
+        return end;
+    }
+
+    bool IsCached() const noexcept { return m_options.cached; }
+
 private:
     char m_prefix;
     Options m_options;
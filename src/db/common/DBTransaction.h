@@ -2,24 +2,27 @@
 
 #include "DBTable.h"
 #include "DBEntry.h"
-#include "OrderedMultimap.h"
+#include "DBWriter.h"
+#include "ObjectCache.h"
+#include "WriteSet.h"
 
+#include <mw/core/Context.h>
 #include <mw/core/exceptions/DatabaseException.h>
 #include <mw/core/serialization/Serializer.h>
 #include <mw/core/traits/Serializable.h>
 #include <leveldb/db.h>
 #include <leveldb/write_batch.h>
+#include <future>
 #include <memory>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 
 class DBTransaction
 {
 public:
     using Ptr = std::shared_ptr<DBTransaction>;
 
-    DBTransaction(leveldb::DB* pDB) : m_pDB(pDB) { }
+    DBTransaction(const std::shared_ptr<leveldb::DB>& pDB, const DBWriter::Ptr& pWriter, const ObjectCache::Ptr& pCache = nullptr)
+        : m_pDB(pDB), m_pWriter(pWriter), m_pCache(pCache) { }
 
     template<typename T,
         typename SFINAE = typename std::enable_if_t<std::is_base_of_v<Traits::ISerializable, T>>>
@@ -32,8 +35,7 @@ public:
             Serializer serializer;
             serializer.Append(entry.item);
 
-            m_batch.Put(leveldb::Slice(key), leveldb::Slice((const char*)serializer.data(), serializer.size()));
-            m_added.insert({ key, entry.item });
+            m_writeSet.Put(key, serializer.data(), serializer.size(), entry.item, table.IsCached());
         }
 
         return *this;
@@ -43,14 +45,11 @@ public:
         typename SFINAE = typename std::enable_if_t<std::is_base_of_v<Traits::ISerializable, T>>>
     std::unique_ptr<DBEntry<T>> Get(const Context::CPtr& pContext, const DBTable& table, const std::string& key) const noexcept
     {
-        auto iter = m_added.find_last(table.BuildKey(key));
-        if (iter != nullptr)
+        auto pendingOpt = FindPending(table.BuildKey(key));
+        if (pendingOpt.has_value())
         {
-            auto pObject = std::dynamic_pointer_cast<const T>(iter);
-            if (pObject != nullptr)
-            {
-                return std::make_unique<DBEntry<T>>(key, pObject);
-            }
+            auto pObject = std::dynamic_pointer_cast<const T>(pendingOpt.value());
+            return pObject != nullptr ? std::make_unique<DBEntry<T>>(key, pObject) : nullptr;
         }
 
         std::string itemStr;
@@ -64,24 +63,106 @@ public:
         return nullptr;
     }
 
+    //
+    // Looks up a write made in this transaction, or committed by an earlier one but not yet written to the DB.
+    // Returns tl::nullopt if there is no such write, or nullptr if the key was deleted.
+    //
+    tl::optional<std::shared_ptr<const Traits::ISerializable>> FindPending(const std::string& key) const noexcept
+    {
+        auto localOpt = FindLocal(key);
+        return localOpt.has_value() ? localOpt : m_pWriter->Find(key);
+    }
+
+    //
+    // Looks up a write made in this transaction.
+    // Returns tl::nullopt if there is no such write, or nullptr if the key was deleted.
+    //
+    tl::optional<std::shared_ptr<const Traits::ISerializable>> FindLocal(const std::string& key) const noexcept
+    {
+        const WriteSet::Entry* pEntry = m_writeSet.Find(key);
+        if (pEntry != nullptr)
+        {
+            return tl::make_optional(pEntry->pObject);
+        }
+
+        return tl::nullopt;
+    }
+
+    //
+    // Returns the writes made in this transaction for keys in [begin, end), sorted by key. Deletes have null items.
+    //
+    std::vector<DBWriter::PendingWrite> FindLocalRange(const std::string& begin, const std::string& end) const
+    {
+        std::vector<DBWriter::PendingWrite> writes;
+        m_writeSet.ForEachInRange(begin, end, [&writes](const WriteSet::Entry& entry) {
+            writes.push_back({ std::string(entry.key), entry.pObject });
+        });
+
+        return writes;
+    }
+
     void Delete(const Context::CPtr& pContext, const DBTable& table, const std::string& key)
     {
-        m_batch.Delete(leveldb::Slice(table.BuildKey(key)));
-        m_added.erase(table.BuildKey(key));
+        DeleteKey(table, table.BuildKey(key));
     }
 
-    void Commit()
+    //
+    // Hands the batch to the writer, to be written with the next group commit.
+    // The writes are readable immediately. The returned future is satisfied once they are durable.
+    //
+    std::shared_future<void> CommitAsync()
     {
-        leveldb::Status status = m_pDB->Write(leveldb::WriteOptions(), &m_batch);
-        if (!status.ok())
+        // Only the latest write to each key is written, in key order.
+        leveldb::WriteBatch batch;
+        std::vector<DBWriter::PendingWrite> writes;
+        writes.reserve(m_writeSet.Size());
+        m_writeSet.ForEach([&batch, &writes](const WriteSet::Entry& entry) {
+            const leveldb::Slice key(entry.key.data(), entry.key.size());
+            if (entry.IsDeleted())
+            {
+                batch.Delete(key);
+            }
+            else
+            {
+                batch.Put(key, leveldb::Slice(entry.value.data(), entry.value.size()));
+            }
+
+            writes.push_back({ std::string(entry.key), entry.pObject });
+        });
+
+        std::shared_future<void> future = m_pWriter->Write(std::move(batch), writes);
+
+        // Cached objects are invalidated once the writer has the new values, so any read that misses the cache finds them.
+        // Nothing is cached before commit, so a rollback has nothing to invalidate.
+        if (m_pCache != nullptr)
         {
-            ThrowDatabase_F("Commit failed with status {}", status.ToString());
+            m_writeSet.ForEach([this](const WriteSet::Entry& entry) {
+                if (entry.cached)
+                {
+                    m_pCache->Invalidate(std::string(entry.key));
+                }
+            });
         }
+
+        return future;
+    }
+
+    //
+    // Blocks until the batch is durable.
+    //
+    void Commit()
+    {
+        CommitAsync().get();
     }
 
 private:
-    leveldb::DB* m_pDB;
-    leveldb::WriteBatch m_batch;
-    OrderedMultimap<std::string, Traits::ISerializable> m_added;
-    //std::unordered_map<std::string, std::shared_ptr<const Traits::ISerializable>> m_added;
+    void DeleteKey(const DBTable& table, const std::string& key)
+    {
+        m_writeSet.Delete(key, table.IsCached());
+    }
+
+    std::shared_ptr<leveldb::DB> m_pDB;
+    DBWriter::Ptr m_pWriter;
+    ObjectCache::Ptr m_pCache;
+    WriteSet m_writeSet;
 };
\ No newline at end of file
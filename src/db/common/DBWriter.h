@@ -0,0 +1,326 @@
+#pragma once
+
+#include <mw/core/common/Logger.h>
+#include <mw/core/common/Metrics.h>
+#include <mw/core/common/ThreadManager.h>
+#include <mw/core/common/Tracer.h>
+#include <mw/core/exceptions/DatabaseException.h>
+#include <mw/core/traits/Serializable.h>
+#include <mw/core/util/ThreadUtil.h>
+#include <leveldb/db.h>
+#include <leveldb/write_batch.h>
+#include <tl/optional.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//
+// Background writer that coalesces the WriteBatches of many callers into group commits.
+// A group is written once it reaches maxBatchSize bytes, or once flushLatency has passed since its first write.
+// Every write is readable through Find() as soon as Write() returns, until it has been written to the DB.
+//
+class DBWriter
+{
+public:
+    using Ptr = std::shared_ptr<DBWriter>;
+
+    // A key and its new value. A null value marks the key as deleted.
+    using PendingWrite = std::pair<std::string, std::shared_ptr<const Traits::ISerializable>>;
+    using PendingMap = std::unordered_map<std::string, std::shared_ptr<const Traits::ISerializable>>;
+
+    struct Options
+    {
+        static Options Default() { return Options({ std::chrono::milliseconds(10), 4 * 1024 * 1024, true }); }
+
+        // How long a write may wait for other writes to join its group.
+        std::chrono::milliseconds flushLatency;
+
+        // Approximate number of bytes at which a group is written without waiting for flushLatency.
+        size_t maxBatchSize;
+
+        // Whether each group commit is synced to disk before its futures are satisfied.
+        bool sync;
+    };
+
+    DBWriter(const std::shared_ptr<leveldb::DB>& pDB, const Options& options = Options::Default())
+        : m_pDB(pDB),
+        m_options(options),
+        m_stop(false),
+        m_nextSequence(0),
+        m_pPromise(std::make_shared<std::promise<void>>()),
+        m_future(m_pPromise->get_future().share())
+    {
+        std::promise<void> written;
+        written.set_value();
+        m_writingFuture = written.get_future().share();
+
+        m_thread = ThreadManagerAPI::CreateThread("DB_WRITER", DBWriter::Thread, this);
+    }
+
+    ~DBWriter() { Stop(); }
+
+    //
+    // Writes everything queued so far, and joins the writer thread, so the DB can be closed.
+    // Transactions may still hold the writer, so it outlives this call, but later writes throw a DatabaseException.
+    // Must not be called concurrently with itself.
+    //
+    void Stop()
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+
+        m_conditional.notify_all();
+        ThreadUtil::Join(m_thread);
+    }
+
+    //
+    // Queues the batch to be written with the next group commit.
+    // The returned future is satisfied once the batch is durable, or holds a DatabaseException if the write failed.
+    // DatabaseException thrown if the writer has been stopped.
+    //
+    std::shared_future<void> Write(leveldb::WriteBatch&& batch, const std::vector<PendingWrite>& writes)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_stop)
+        {
+            ThrowDatabase("Tried to write after the writer was stopped");
+        }
+
+        // An empty batch would never be written, so its future would wait on the next group to fill up.
+        if (writes.empty() && batch.ApproximateSize() <= EMPTY_BATCH_SIZE)
+        {
+            return m_writingFuture;
+        }
+
+        const uint64_t sequence = ++m_nextSequence;
+        for (const PendingWrite& write : writes)
+        {
+            m_pending[write.first] = PendingEntry({ sequence, write.second });
+        }
+
+        if (IsBatchEmpty())
+        {
+            m_groupStart = std::chrono::steady_clock::now();
+            m_conditional.notify_all();
+        }
+
+        m_batch.Append(batch);
+        if (m_batch.ApproximateSize() >= m_options.maxBatchSize)
+        {
+            m_conditional.notify_all();
+        }
+
+        return m_future;
+    }
+
+    //
+    // Looks up a write that has been queued, but not yet written to the DB.
+    // Returns tl::nullopt if there is no pending write for the key.
+    // Returns nullptr if the pending write is a delete.
+    //
+    tl::optional<std::shared_ptr<const Traits::ISerializable>> Find(const std::string& key) const noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        auto iter = m_pending.find(key);
+        if (iter != m_pending.cend())
+        {
+            return tl::make_optional(iter->second.item);
+        }
+
+        return tl::nullopt;
+    }
+
+    //
+    // Takes a DB snapshot together with a copy of the writes not yet in it, so every queued write is in one or the other.
+    // Pending writes are always newer than the DB, so they take precedence.
+    //
+    std::pair<std::shared_ptr<const leveldb::Snapshot>, PendingMap> GetSnapshot() const
+    {
+        PendingMap pending;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        pending.reserve(m_pending.size());
+        for (const auto& entry : m_pending)
+        {
+            pending.insert({ entry.first, entry.second.item });
+        }
+
+        return { TakeSnapshot(), std::move(pending) };
+    }
+
+    //
+    // Like GetSnapshot(), but only copies the pending writes for keys in [begin, end), sorted by key.
+    //
+    std::pair<std::shared_ptr<const leveldb::Snapshot>, std::vector<PendingWrite>> GetSnapshot(const std::string& begin, const std::string& end) const
+    {
+        std::vector<PendingWrite> writes;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (const auto& pending : m_pending)
+        {
+            if (pending.first >= begin && pending.first < end)
+            {
+                writes.push_back({ pending.first, pending.second.item });
+            }
+        }
+
+        std::shared_ptr<const leveldb::Snapshot> pSnapshot = TakeSnapshot();
+        lock.unlock();
+
+        std::sort(
+            writes.begin(), writes.end(),
+            [](const PendingWrite& lhs, const PendingWrite& rhs) { return lhs.first < rhs.first; }
+        );
+        return { std::move(pSnapshot), std::move(writes) };
+    }
+
+    //
+    // Writes the current group without waiting for flushLatency.
+    // The returned future is satisfied once everything queued before this call is durable.
+    //
+    std::shared_future<void> Flush()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if (IsBatchEmpty())
+        {
+            return m_writingFuture;
+        }
+
+        m_groupStart = std::chrono::steady_clock::time_point::min();
+        m_conditional.notify_all();
+        return m_future;
+    }
+
+private:
+    struct PendingEntry
+    {
+        uint64_t sequence;
+        std::shared_ptr<const Traits::ISerializable> item;
+    };
+
+    static void Thread(DBWriter* pWriter)
+    {
+        LOG_TRACE("BEGIN");
+
+        while (pWriter->WriteNextGroup())
+        {
+        }
+
+        LOG_TRACE("END");
+    }
+
+    // Waits for a group to fill up or time out, then writes it. Returns false once stopped and drained.
+    bool WriteNextGroup()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_conditional.wait(lock, [this] { return m_stop || !IsBatchEmpty(); });
+
+        if (IsBatchEmpty())
+        {
+            return false;
+        }
+
+        m_conditional.wait_until(lock, m_groupStart + m_options.flushLatency, [this] {
+            return m_stop
+                || m_batch.ApproximateSize() >= m_options.maxBatchSize
+                || std::chrono::steady_clock::now() >= m_groupStart + m_options.flushLatency;
+        });
+
+        // Swap out the group, so callers can start filling the next one while this one is written.
+        leveldb::WriteBatch batch;
+        std::swap(batch, m_batch);
+        auto pPromise = std::exchange(m_pPromise, std::make_shared<std::promise<void>>());
+        m_writingFuture = std::exchange(m_future, m_pPromise->get_future().share());
+        const uint64_t lastSequence = m_nextSequence;
+        lock.unlock();
+
+        leveldb::WriteOptions writeOptions;
+        writeOptions.sync = m_options.sync;
+        static Histogram& latency = MetricsAPI::GetHistogram("db_group_write_seconds", "Time to write one group commit to the DB.");
+        static Counter& bytesWritten = MetricsAPI::GetCounter("db_group_write_bytes_total", "Approximate bytes written by group commits.");
+        bytesWritten.Add(batch.ApproximateSize());
+
+        leveldb::Status status;
+        {
+            MW_TRACE_SCOPE(DB_GROUP_WRITE, batch.ApproximateSize(), m_options.sync ? 1 : 0);
+            LatencyTimer timer(latency);
+            status = m_pDB->Write(writeOptions, &batch);
+        }
+
+        lock.lock();
+        for (auto iter = m_pending.begin(); iter != m_pending.end();)
+        {
+            iter = iter->second.sequence <= lastSequence ? m_pending.erase(iter) : std::next(iter);
+        }
+        lock.unlock();
+
+        if (status.ok())
+        {
+            pPromise->set_value();
+        }
+        else
+        {
+            LOG_ERROR_F("Group commit failed with status {}", status.ToString());
+
+            try
+            {
+                ThrowDatabase_F("Commit failed with status {}", status.ToString());
+            }
+            catch (...)
+            {
+                pPromise->set_exception(std::current_exception());
+            }
+        }
+
+        return true;
+    }
+
+    // Must be called while holding m_mutex. Writes are only removed from m_pending under the lock,
+    // once they're in the DB, so every write is either in the snapshot or still pending.
+    // The snapshot holds the DB, so the DB stays open until the snapshot is released.
+    std::shared_ptr<const leveldb::Snapshot> TakeSnapshot() const
+    {
+        return std::shared_ptr<const leveldb::Snapshot>(
+            m_pDB->GetSnapshot(),
+            [pDB = m_pDB](const leveldb::Snapshot* pSnapshot) { pDB->ReleaseSnapshot(pSnapshot); }
+        );
+    }
+
+    bool IsBatchEmpty() const noexcept { return m_batch.ApproximateSize() <= EMPTY_BATCH_SIZE; }
+
+    // Size of the WriteBatch header, which is all an empty batch contains.
+    static constexpr size_t EMPTY_BATCH_SIZE = 12;
+
+    std::shared_ptr<leveldb::DB> m_pDB;
+    Options m_options;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_conditional;
+    bool m_stop;
+
+    leveldb::WriteBatch m_batch;
+    std::chrono::steady_clock::time_point m_groupStart;
+    uint64_t m_nextSequence;
+    std::unordered_map<std::string, PendingEntry> m_pending;
+    std::shared_ptr<std::promise<void>> m_pPromise;
+    std::shared_future<void> m_future;
+
+    // Future of the group most recently handed to the DB.
+    std::shared_future<void> m_writingFuture;
+
+    std::thread m_thread;
+};
\ No newline at end of file
@@ -2,7 +2,13 @@
 
 #include "DBTable.h"
 #include "DBTransaction.h"
+#include "DBWriter.h"
+#include "ObjectCache.h"
 #include "DBEntry.h"
+#include "DBIterator.h"
+#include "DBSnapshot.h"
+#include "DBMigration.h"
+#include "DBOptions.h"
 #include "DBLogger.h"
 #include "DBFilterPolicy.h"
 
@@ -10,9 +16,18 @@
 #include <mw/core/file/FilePath.h>
 #include <mw/core/traits/Batchable.h>
 #include <mw/core/common/Lock.h>
+#include <mw/core/common/Metrics.h>
+#include <mw/core/common/ThreadPool.h>
+#include <mw/core/common/Tracer.h>
 
 #include <leveldb/db.h>
 #include <leveldb/filter_policy.h>
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <future>
+#include <thread>
 #include <vector>
 #include <cassert>
 #include <memory>
@@ -22,77 +37,443 @@ class Database : public Traits::IBatchable
 public:
     using Ptr = std::shared_ptr<Database>;
 
-    static Database::Ptr Open(const Context::CPtr& pContext, const FilePath& path)
+    static Database::Ptr Open(const Context::CPtr& pContext, const FilePath& path, const DBOptions& options = DBOptions::Steady())
     {
         path.CreateDirIfMissing();
 
-        std::unique_ptr<DBLogger> pLogger = std::make_unique<DBLogger>();
+        std::shared_ptr<leveldb::DB> pDB = OpenDB(path, options);
+        DBMigration::Migrate(pDB.get());
 
-        leveldb::Options options;
-        options.create_if_missing = true;
-        options.info_log = new DBLogger();
-        options.filter_policy = new DBFilterPolicy();
-
-        // Snappy compression is fast, but not useful for pseudorandom data like hashes & commitments.
-        options.compression = leveldb::kNoCompression;
+        return std::shared_ptr<Database>(new Database(pContext, path, options, pDB));
+    }
 
-        leveldb::DB* pDB = nullptr;
-        leveldb::Status status = leveldb::DB::Open(options, path.u8string(), &pDB); // TODO: Add tests for windows unicode paths.
-        if (!status.ok())
+    virtual ~Database()
+    {
+        // Transactions created by CreateTransaction() may still hold the writer, so it's stopped explicitly,
+        // which writes any pending group commit and joins its thread before the DB is closed.
+        // The DB itself is closed once the last snapshot or iterator holding it is released.
+        m_pTx.reset();
+        if (m_pWriter != nullptr)
         {
-            ThrowDatabase_F("Open failed with status {}", status.ToString());
+            m_pWriter->Stop();
         }
-
-        return std::shared_ptr<Database>(new Database(pContext, std::move(options), pDB));
     }
 
-    virtual ~Database()
+    //
+    // Closes and reopens the database with new options, e.g. to switch from the sync profile to the steady profile.
+    // Must be called while holding the write lock. Anything not yet committed in the current write is discarded.
+    //
+    // LevelDB can only be opened once, so the DB can't be reopened while snapshots, iterators or transactions from
+    // CreateTransaction() still hold it. DatabaseException thrown in that case, and the database is left as it was.
+    //
+    // If the DB can't be opened with the new options, it's opened again with the old ones, and the error is rethrown.
+    // If that fails too, the database is left closed: every other call throws until a later Reopen() succeeds.
+    //
+    void Reopen(const DBOptions& options)
     {
-        delete m_pDB;
-        delete m_options.filter_policy;
-        delete m_options.info_log;
+        const bool writing = m_writing;
+        m_pTx.reset();
+
+        LOG_INFO_F("Reopening database {} with profile {}", m_path.u8string(), options.profile);
+
+        // Stopping the writer writes any pending group commit, and joins its thread, even if a transaction still holds it.
+        if (m_pWriter != nullptr)
+        {
+            m_pWriter->Stop();
+        }
+
+        std::unique_lock<std::mutex> lock(m_handleMutex);
+
+        // Only this and the stopped writer should hold the DB. Nothing else can take a new reference while the lock is held.
+        if (m_pDB.use_count() > 2)
+        {
+            m_pWriter = std::make_shared<DBWriter>(m_pDB, m_dbOptions.writer);
+            if (writing)
+            {
+                m_pTx = std::make_shared<DBTransaction>(m_pDB, m_pWriter, m_pCache);
+            }
+
+            ThrowDatabase_F("Can't reopen {} while snapshots, iterators or transactions are still open", m_path);
+        }
+
+        m_pWriter.reset();
+        m_pDB.reset();
+
+        std::exception_ptr pError;
+        try
+        {
+            m_pDB = OpenDB(m_path, options);
+            m_dbOptions = options;
+        }
+        catch (std::exception& e)
+        {
+            LOG_ERROR_F("Failed to reopen {} with profile {}: {}", m_path.u8string(), options.profile, e.what());
+            pError = std::current_exception();
+
+            // Throws, leaving the database closed, if the old options don't work anymore either.
+            m_pDB = OpenDB(m_path, m_dbOptions);
+        }
+
+        m_pWriter = std::make_shared<DBWriter>(m_pDB, m_dbOptions.writer);
+        m_pCache = std::make_shared<ObjectCache>(m_dbOptions.objectCacheBytes);
+
+        if (writing)
+        {
+            m_pTx = std::make_shared<DBTransaction>(m_pDB, m_pWriter, m_pCache);
+        }
+
+        if (pError != nullptr)
+        {
+            std::rethrow_exception(pError);
+        }
     }
 
+    const DBOptions& GetOptions() const noexcept { return m_dbOptions; }
+
+    //
+    // False only after a Reopen() that couldn't open the DB again.
+    //
+    bool IsOpen() const noexcept { return m_pDB != nullptr; }
+
     //
     // Operations
     //
     template<typename T,
         typename SFINAE = typename std::enable_if_t<std::is_base_of_v<Traits::ISerializable, T>>>
-    std::unique_ptr<DBEntry<T>> Get(const DBTable& table, const std::string& key) const noexcept
+    std::unique_ptr<DBEntry<T>> Get(const DBTable& table, const std::string& key) const
     {
-        if (m_pTx != nullptr)
+        CheckOpen();
+        TraceScope trace(ETraceEvent::DB_GET, table.GetPrefix(), 0);
+        static Histogram& latency = MetricsAPI::GetHistogram("db_get_seconds", "Time to read one key.");
+        LatencyTimer timer(latency);
+
+        const std::string dbKey = table.BuildKey(key);
+        const uint64_t version = table.IsCached() ? m_pCache->GetVersion(dbKey) : 0;
+
+        auto foundOpt = FindInMemory(table, dbKey);
+        if (foundOpt.has_value())
         {
-            return m_pTx->Get<T>(m_pContext, table, key);
+            auto pObject = std::dynamic_pointer_cast<const T>(foundOpt.value());
+            trace.SetPayload2(pObject != nullptr ? 1 : 0);
+            return pObject != nullptr ? std::make_unique<DBEntry<T>>(key, pObject) : nullptr;
         }
 
         std::string itemStr;
-        leveldb::Status status = m_pDB->Get(leveldb::ReadOptions(), table.BuildKey(key), &itemStr);
+        leveldb::Status status = m_pDB->Get(leveldb::ReadOptions(), dbKey, &itemStr);
         if (status.ok())
         {
             Deserializer deserializer(std::vector<uint8_t>(itemStr.cbegin(), itemStr.cend()));
-            return std::make_unique<DBEntry<T>>(key, T::Deserialize(m_pContext, deserializer));
+            auto pObject = T::Deserialize(m_pContext, deserializer);
+            if (table.IsCached())
+            {
+                m_pCache->Fill(dbKey, pObject, itemStr.size(), version);
+            }
+
+            trace.SetPayload2(1);
+            return std::make_unique<DBEntry<T>>(key, pObject);
         }
 
         return nullptr;
     }
 
+    //
+    // Looks up all of the keys as one bulk read.
+    // Returns an entry per key, in the same order as the keys, with nullptr for keys that weren't found.
+    //
+    // Keys are sorted and read from one snapshot through a shared iterator, so the iterator only moves forward.
+    // Batches of at least 2 * MULTI_GET_KEYS_PER_RANGE keys are split into sorted ranges read in parallel on the shared pool.
+    //
+    template<typename T,
+        typename SFINAE = typename std::enable_if_t<std::is_base_of_v<Traits::ISerializable, T>>>
+    std::vector<std::unique_ptr<DBEntry<T>>> MultiGet(const DBTable& table, const std::vector<std::string>& keys) const
+    {
+        CheckOpen();
+        MW_TRACE_SCOPE(DB_MULTI_GET, table.GetPrefix(), keys.size());
+        static Histogram& latency = MetricsAPI::GetHistogram("db_multi_get_seconds", "Time to read a batch of keys with MultiGet.");
+        LatencyTimer timer(latency);
+
+        std::vector<std::unique_ptr<DBEntry<T>>> entries(keys.size());
+
+        // Pending writes and cached objects are resolved first. Everything else is read from the DB in key order.
+        std::vector<std::pair<std::string, size_t>> sortedKeys;
+        std::vector<uint64_t> versions(table.IsCached() ? keys.size() : 0);
+        sortedKeys.reserve(keys.size());
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            std::string key = table.BuildKey(keys[i]);
+            if (table.IsCached())
+            {
+                versions[i] = m_pCache->GetVersion(key);
+            }
+
+            auto foundOpt = FindInMemory(table, key);
+            if (foundOpt.has_value())
+            {
+                auto pObject = std::dynamic_pointer_cast<const T>(foundOpt.value());
+                if (pObject != nullptr)
+                {
+                    entries[i] = std::make_unique<DBEntry<T>>(keys[i], pObject);
+                }
+            }
+            else
+            {
+                sortedKeys.push_back({ std::move(key), i });
+            }
+        }
+
+        if (sortedKeys.empty())
+        {
+            return entries;
+        }
+
+        std::sort(sortedKeys.begin(), sortedKeys.end());
+
+        std::shared_ptr<const leveldb::Snapshot> pSnapshot(
+            m_pDB->GetSnapshot(),
+            [pDB = m_pDB](const leveldb::Snapshot* pSnapshot) { pDB->ReleaseSnapshot(pSnapshot); }
+        );
+        leveldb::ReadOptions readOptions;
+        readOptions.snapshot = pSnapshot.get();
+
+        auto readRange = [this, &table, &readOptions, &sortedKeys, &versions, &keys, &entries](const size_t begin, const size_t end) {
+            std::unique_ptr<leveldb::Iterator> pIter(m_pDB->NewIterator(readOptions));
+            pIter->Seek(sortedKeys[begin].first);
+
+            for (size_t i = begin; i < end && pIter->Valid(); i++)
+            {
+                const std::string& key = sortedKeys[i].first;
+                if (pIter->key().compare(key) < 0)
+                {
+                    pIter->Seek(key);
+                    if (!pIter->Valid())
+                    {
+                        break;
+                    }
+                }
+
+                if (pIter->key() == key)
+                {
+                    const leveldb::Slice value = pIter->value();
+                    Deserializer deserializer(std::vector<uint8_t>(value.data(), value.data() + value.size()));
+
+                    const size_t index = sortedKeys[i].second;
+                    auto pObject = T::Deserialize(m_pContext, deserializer);
+                    if (table.IsCached())
+                    {
+                        m_pCache->Fill(key, pObject, value.size(), versions[index]);
+                    }
+
+                    entries[index] = std::make_unique<DBEntry<T>>(keys[index], pObject);
+                }
+            }
+
+            if (!pIter->status().ok())
+            {
+                ThrowDatabase_F("MultiGet failed with status {}", pIter->status().ToString());
+            }
+        };
+
+        ThreadPool& pool = ThreadPoolAPI::GetDefaultPool();
+        const size_t numRanges = std::min<size_t>(pool.GetNumThreads(), sortedKeys.size() / MULTI_GET_KEYS_PER_RANGE);
+        if (numRanges <= 1)
+        {
+            readRange(0, sortedKeys.size());
+            return entries;
+        }
+
+        pool.ParallelFor(0, sortedKeys.size(), (sortedKeys.size() + numRanges - 1) / numRanges, readRange, ETaskPriority::HIGH);
+
+        return entries;
+    }
+
+    //
+    // Outside of a batch, the entries are queued for the next group commit, and are readable immediately.
+    // The returned future is satisfied once they are durable.
+    // Inside of a batch, the entries are written when the batch is committed, so the returned future is already satisfied.
+    //
     template<typename T,
         typename SFINAE = typename std::enable_if_t<std::is_base_of_v<Traits::ISerializable, T>>>
-    void Put(const DBTable& table, const std::vector<DBEntry<T>>& entries)
+    std::shared_future<void> Put(const DBTable& table, const std::vector<DBEntry<T>>& entries)
     {
         assert(!entries.empty());
+        CheckOpen();
+        MW_TRACE_SCOPE(DB_PUT, table.GetPrefix(), entries.size());
 
         if (m_pTx != nullptr)
         {
             m_pTx->Put(table, entries);
+            return Satisfied();
         }
-        else
+
+        return DBTransaction(m_pDB, m_pWriter, m_pCache).Put(table, entries).CommitAsync();
+    }
+
+    //
+    // Deletes the keys. Like Put, deletes outside of a batch are readable immediately and durable once the future is satisfied.
+    //
+    std::shared_future<void> Delete(const DBTable& table, const std::vector<std::string>& keys)
+    {
+        CheckOpen();
+        MW_TRACE_SCOPE(DB_DELETE, table.GetPrefix(), keys.size());
+
+        DBTransaction tx(m_pDB, m_pWriter, m_pCache);
+        DBTransaction& transaction = m_pTx != nullptr ? *m_pTx : tx;
+        for (const std::string& key : keys)
+        {
+            transaction.Delete(m_pContext, table, key);
+        }
+
+        return m_pTx != nullptr ? Satisfied() : tx.CommitAsync();
+    }
+
+    //
+    // Deletes every key in the table.
+    //
+    std::shared_future<void> DeleteAll(const DBTable& table)
+    {
+        CheckOpen();
+        DBTransaction tx(m_pDB, m_pWriter, m_pCache);
+        DBTransaction& transaction = m_pTx != nullptr ? *m_pTx : tx;
+
+        // The scan sees pending writes, so nothing needs to be flushed first.
+        // Its view is fixed when it starts, so the deletes don't disturb it.
+        for (DBIterator iter = Scan(table); iter.Valid(); iter.Next())
+        {
+            transaction.Delete(m_pContext, table, iter.GetKey());
+        }
+
+        return m_pTx != nullptr ? Satisfied() : tx.CommitAsync();
+    }
+
+    //
+    // Iterates over the table's entries with item keys in [begin, end), in key order. An empty end means the end of the table.
+    // Writes in the current batch, and writes still waiting in the writer, are merged over a snapshot of the DB,
+    // so nothing is flushed, and entries are read a few at a time rather than all at once.
+    //
+    DBIterator Scan(
+        const DBTable& table,
+        const std::string& begin = "",
+        const std::string& end = "",
+        const DBIterator::Options& options = DBIterator::Options::Default()) const
+    {
+        return CreateIterator(table.BuildKey(begin), end.empty() ? table.GetEndKey() : table.BuildKey(end), options);
+    }
+
+    //
+    // Iterates over the table's entries with item keys starting with the prefix, in key order.
+    //
+    DBIterator ScanPrefix(
+        const DBTable& table,
+        const std::string& prefix,
+        const DBIterator::Options& options = DBIterator::Options::Default()) const
+    {
+        const std::string begin = table.BuildKey(prefix);
+        std::string end = DBTable::GetPrefixEnd(begin);
+        return CreateIterator(begin, end.empty() ? table.GetEndKey() : std::move(end), options);
+    }
+
+    //
+    // Returns a read-only view of everything committed so far. Writes in the current batch aren't included.
+    // Can be called from any thread, without holding the lock, even while another thread is in the middle of a batch.
+    // The snapshot keeps the DB open, so Reopen() fails until it's released.
+    //
+    DBSnapshot::CPtr GetSnapshot() const
+    {
+        // Reopen() swaps the DB and writer under the same mutex.
+        std::unique_lock<std::mutex> lock(m_handleMutex);
+        CheckOpen();
+        auto snapshot = m_pWriter->GetSnapshot();
+        return std::make_shared<const DBSnapshot>(m_pContext, m_pDB, snapshot.first, std::move(snapshot.second));
+    }
+
+    //
+    // Calls the visitor with the item key of every entry in the table, in key order.
+    //
+    void ForEachKey(const DBTable& table, const std::function<void(const std::string&)>& visitor) const
+    {
+        for (DBIterator iter = Scan(table); iter.Valid(); iter.Next())
         {
-            DBTransaction(m_pDB).Put(table, entries).Commit();
+            visitor(iter.GetKey());
         }
     }
 
-    // FUTURE: std::vector<DBEntry<T>> CustomGet(const DBTable& table, const Query& query) const;
+    //
+    // Creates a transaction that is independent of the current batch, for background jobs.
+    // Its writes go through the same group commits as foreground writes, so neither stalls the other.
+    //
+    DBTransaction CreateTransaction() const
+    {
+        CheckOpen();
+        return DBTransaction(m_pDB, m_pWriter, m_pCache);
+    }
+
+    //
+    // Compacts the table's key range, so space used by deleted entries is reclaimed.
+    //
+    void Compact(const DBTable& table)
+    {
+        CheckOpen();
+        const std::string begin = table.BuildKey(std::string());
+        const std::string end = table.GetEndKey();
+
+        const leveldb::Slice beginSlice(begin);
+        const leveldb::Slice endSlice(end);
+        m_pDB->CompactRange(&beginSlice, &endSlice);
+    }
+
+    //
+    // Approximate number of bytes used on disk by the table.
+    //
+    uint64_t GetApproximateSize(const DBTable& table) const
+    {
+        CheckOpen();
+        const std::string begin = table.BuildKey(std::string());
+        const std::string end = table.GetEndKey();
+
+        const leveldb::Range range(begin, end);
+        uint64_t size = 0;
+        m_pDB->GetApproximateSizes(&range, 1, &size);
+        return size;
+    }
+
+    //
+    // Hit rate and size of the cache of deserialized objects from cached tables.
+    //
+    ObjectCache::Stats GetCacheStats() const noexcept { return m_pCache->GetStats(); }
+
+    //
+    // Writes any pending group commit without waiting for the flush latency.
+    //
+    std::shared_future<void> Flush()
+    {
+        CheckOpen();
+        return m_pWriter->Flush();
+    }
+
+    //
+    // The sequence last committed with CommitJournaled(), or 0 if there hasn't been one.
+    //
+    uint64_t GetCommitSequence() const
+    {
+        auto pEntry = Get<CommitSequence>(META_TABLE, COMMIT_SEQUENCE_KEY);
+        return pEntry != nullptr ? pEntry->item->GetValue() : 0;
+    }
+
+    //
+    // Commits the batch together with a CommitJournal sequence, and waits until both are durable.
+    //
+    void CommitJournaled(const uint64_t sequence)
+    {
+        assert(m_pTx != nullptr);
+        CheckOpen();
+        MW_TRACE_SCOPE(DB_COMMIT, sequence, 0);
+        static Histogram& latency = MetricsAPI::GetHistogram("db_commit_seconds", "Time to commit a batch, until it's durable.");
+        LatencyTimer timer(latency);
+
+        auto pSequence = std::make_shared<const CommitSequence>(sequence);
+        m_pTx->Put(META_TABLE, std::vector<DBEntry<CommitSequence>>({ DBEntry<CommitSequence>(COMMIT_SEQUENCE_KEY, pSequence) }));
+        m_pTx->Commit();
+    }
 
     //
     // Batchable
@@ -100,27 +481,197 @@ public:
     void OnInitWrite() noexcept final
     {
         assert(m_pTx == nullptr);
-        m_pTx = std::make_shared<DBTransaction>(m_pDB);
+        m_pTx = std::make_shared<DBTransaction>(m_pDB, m_pWriter, m_pCache);
+        m_writing = true;
     }
 
     void OnEndWrite() noexcept final
     {
         m_pTx.reset();
+        m_writing = false;
     }
 
     void Commit() final
     {
         assert(m_pTx != nullptr);
+        CheckOpen();
+        MW_TRACE_SCOPE(DB_COMMIT, 0, 0);
+        static Histogram& latency = MetricsAPI::GetHistogram("db_commit_seconds", "Time to commit a batch, until it's durable.");
+        LatencyTimer timer(latency);
         m_pTx->Commit();
     }
     void Rollback() noexcept final { m_pTx.reset(); }
     
 private:
-    Database(const Context::CPtr& pContext, leveldb::Options&& options, leveldb::DB* pDB) noexcept
-        : m_pContext(pContext), m_options(std::move(options)), m_pDB(pDB), m_pTx(nullptr) { }
+    class CommitSequence : public Traits::ISerializable
+    {
+    public:
+        CommitSequence(const uint64_t value) : m_value(value) { }
+
+        uint64_t GetValue() const noexcept { return m_value; }
+
+        Serializer& Serialize(Serializer& serializer) const noexcept final { return serializer.Append<uint64_t>(m_value); }
+
+        static std::shared_ptr<const CommitSequence> Deserialize(const Context::CPtr&, Deserializer& deserializer)
+        {
+            return std::make_shared<const CommitSequence>(deserializer.Read<uint64_t>());
+        }
+
+    private:
+        uint64_t m_value;
+    };
+
+    static std::shared_future<void> Satisfied()
+    {
+        std::promise<void> promise;
+        promise.set_value();
+        return promise.get_future().share();
+    }
+
+    Database(
+        const Context::CPtr& pContext,
+        const FilePath& path,
+        const DBOptions& dbOptions,
+        const std::shared_ptr<leveldb::DB>& pDB)
+        : m_pContext(pContext),
+        m_path(path),
+        m_dbOptions(dbOptions),
+        m_pDB(pDB),
+        m_pWriter(std::make_shared<DBWriter>(pDB, dbOptions.writer)),
+        m_pCache(std::make_shared<ObjectCache>(dbOptions.objectCacheBytes)),
+        m_pTx(nullptr),
+        m_writing(false) { }
+
+    //
+    // The DB is closed, and the objects its options own are deleted, once the last reference is released.
+    //
+    static std::shared_ptr<leveldb::DB> OpenDB(const FilePath& path, const DBOptions& dbOptions)
+    {
+        leveldb::Options options;
+        options.create_if_missing = true;
+        options.info_log = new DBLogger();
+        options.filter_policy = new DBFilterPolicy();
+        dbOptions.Apply(options);
+
+        // Snappy compression is fast, but not useful for pseudorandom data like hashes & commitments.
+        options.compression = leveldb::kNoCompression;
+
+        leveldb::DB* pDB = nullptr;
+        leveldb::Status status = leveldb::DB::Open(options, path.u8string(), &pDB); // TODO: Add tests for windows unicode paths.
+        if (!status.ok())
+        {
+            CloseDB(nullptr, options);
+            ThrowDatabase_F("Open failed with status {}", status.ToString());
+        }
+
+        return std::shared_ptr<leveldb::DB>(pDB, [options](leveldb::DB* pDB) mutable { CloseDB(pDB, options); });
+    }
+
+    void CheckOpen() const
+    {
+        if (!IsOpen())
+        {
+            ThrowDatabase_F("{} is closed, since it couldn't be reopened", m_path);
+        }
+    }
+
+    static void CloseDB(leveldb::DB* pDB, leveldb::Options& options) noexcept
+    {
+        delete pDB;
+        delete options.filter_policy;
+        delete options.info_log;
+        delete options.block_cache;
+
+        options.filter_policy = nullptr;
+        options.info_log = nullptr;
+        options.block_cache = nullptr;
+    }
+
+    //
+    // Writes in the current batch are newer than the writer's, so they take precedence.
+    //
+    DBIterator CreateIterator(const std::string& begin, std::string&& end, const DBIterator::Options& options) const
+    {
+        CheckOpen();
+        auto snapshot = m_pWriter->GetSnapshot(begin, end);
+        std::vector<DBWriter::PendingWrite>& overlay = snapshot.second;
+        if (m_pTx != nullptr)
+        {
+            std::vector<DBWriter::PendingWrite> local = m_pTx->FindLocalRange(begin, end);
+            if (!local.empty())
+            {
+                std::vector<DBWriter::PendingWrite> merged;
+                merged.reserve(overlay.size() + local.size());
+
+                auto pendingIter = overlay.begin();
+                for (DBWriter::PendingWrite& write : local)
+                {
+                    for (; pendingIter != overlay.end() && pendingIter->first < write.first; pendingIter++)
+                    {
+                        merged.push_back(std::move(*pendingIter));
+                    }
+
+                    if (pendingIter != overlay.end() && pendingIter->first == write.first)
+                    {
+                        pendingIter++;
+                    }
+
+                    merged.push_back(std::move(write));
+                }
+
+                std::move(pendingIter, overlay.end(), std::back_inserter(merged));
+                overlay = std::move(merged);
+            }
+        }
+
+        // Item keys start after the 1 byte table prefix.
+        return DBIterator(m_pContext, m_pDB, snapshot.first, begin, std::move(end), 1, std::move(overlay), options);
+    }
+
+    //
+    // Looks up the key in the current batch, the cache, and the writer's pending writes, in that order.
+    // Returns tl::nullopt if the DB must be read, or nullptr if the key was deleted.
+    //
+    tl::optional<std::shared_ptr<const Traits::ISerializable>> FindInMemory(const DBTable& table, const std::string& key) const noexcept
+    {
+        if (m_pTx != nullptr)
+        {
+            auto localOpt = m_pTx->FindLocal(key);
+            if (localOpt.has_value())
+            {
+                return localOpt;
+            }
+        }
+
+        if (table.IsCached())
+        {
+            auto pCached = m_pCache->Get(key);
+            if (pCached != nullptr)
+            {
+                return tl::make_optional(pCached);
+            }
+        }
+
+        return m_pWriter->Find(key);
+    }
+
+    // Minimum number of keys in each range MultiGet reads in parallel.
+    static constexpr size_t MULTI_GET_KEYS_PER_RANGE = 1024;
+
+    // Shares the meta table with DBMigration's version key.
+    static inline const DBTable META_TABLE = { 'M' };
+    static inline const std::string COMMIT_SEQUENCE_KEY = "commit_sequence";
 
     Context::CPtr m_pContext;
-    leveldb::Options m_options;
-    leveldb::DB* m_pDB;
+    FilePath m_path;
+    DBOptions m_dbOptions;
+    // Swapped by Reopen(), and read without the Locked<> lock by GetSnapshot(), so both hold m_handleMutex.
+    mutable std::mutex m_handleMutex;
+    std::shared_ptr<leveldb::DB> m_pDB;
+    DBWriter::Ptr m_pWriter;
+    ObjectCache::Ptr m_pCache;
     DBTransaction::Ptr m_pTx;
+
+    // Between OnInitWrite() and OnEndWrite(). Unlike m_pTx, it survives a Reopen() that leaves the DB closed.
+    bool m_writing;
 };
\ No newline at end of file
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <mw/core/common/Metrics.h>
+#include <mw/core/traits/Serializable.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+//
+// Size-bounded LRU cache of deserialized objects, keyed by their full database key.
+//
+// Entries are spread across NUM_SHARDS independently locked shards, so concurrent readers rarely contend.
+// Each shard evicts its least recently used entries once it holds more than its share of maxBytes.
+//
+// To keep a read that races with a write from caching the old value, readers take a version with GetVersion()
+// before reading the database, and Fill() drops the object if the key's shard was invalidated in the meantime.
+//
+class ObjectCache
+{
+public:
+    using Ptr = std::shared_ptr<ObjectCache>;
+
+    struct Stats
+    {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        uint64_t invalidations;
+        size_t numEntries;
+        size_t numBytes;
+
+        double GetHitRate() const noexcept { return hits + misses > 0 ? (double)hits / (hits + misses) : 0.0; }
+    };
+
+    ObjectCache(const size_t maxBytes)
+        : m_maxShardBytes(maxBytes / NUM_SHARDS), m_hits(0), m_misses(0), m_evictions(0), m_invalidations(0) { }
+
+    //
+    // Returns the cached object, or nullptr on a miss.
+    //
+    std::shared_ptr<const Traits::ISerializable> Get(const std::string& key) noexcept
+    {
+        static Counter& hitsTotal = MetricsAPI::GetCounter("db_cache_hits_total", "Reads of cached tables served from the object cache.");
+        static Counter& missesTotal = MetricsAPI::GetCounter("db_cache_misses_total", "Reads of cached tables that missed the object cache.");
+
+        Shard& shard = GetShard(key);
+        std::unique_lock<std::mutex> lock(shard.mutex);
+
+        auto iter = shard.entries.find(key);
+        if (iter == shard.entries.end())
+        {
+            m_misses++;
+            missesTotal.Add();
+            return nullptr;
+        }
+
+        m_hits++;
+        hitsTotal.Add();
+        shard.lru.splice(shard.lru.begin(), shard.lru, iter->second);
+        return iter->second->pObject;
+    }
+
+    uint64_t GetVersion(const std::string& key) const noexcept
+    {
+        const Shard& shard = GetShard(key);
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        return shard.version;
+    }
+
+    //
+    // Caches an object read from the database, unless its shard was invalidated since version was taken.
+    // numBytes is the object's serialized size, which approximates its size in memory.
+    //
+    void Fill(const std::string& key, const std::shared_ptr<const Traits::ISerializable>& pObject, const size_t numBytes, const uint64_t version)
+    {
+        Shard& shard = GetShard(key);
+        std::unique_lock<std::mutex> lock(shard.mutex);
+
+        if (shard.version != version || shard.entries.find(key) != shard.entries.end())
+        {
+            return;
+        }
+
+        const size_t entryBytes = numBytes + ENTRY_OVERHEAD + key.size();
+        shard.lru.push_front(Entry({ key, pObject, entryBytes }));
+        shard.entries.insert({ key, shard.lru.begin() });
+        shard.numBytes += entryBytes;
+
+        while (shard.numBytes > m_maxShardBytes && !shard.lru.empty())
+        {
+            const std::string evictedKey = shard.lru.back().key;
+            Erase(shard, evictedKey);
+            m_evictions++;
+        }
+    }
+
+    //
+    // Removes the key, and invalidates versions taken by in-flight reads of its shard.
+    //
+    void Invalidate(const std::string& key)
+    {
+        Shard& shard = GetShard(key);
+        std::unique_lock<std::mutex> lock(shard.mutex);
+
+        shard.version++;
+        if (shard.entries.find(key) != shard.entries.end())
+        {
+            Erase(shard, key);
+            m_invalidations++;
+        }
+    }
+
+    Stats GetStats() const noexcept
+    {
+        Stats stats({ m_hits, m_misses, m_evictions, m_invalidations, 0, 0 });
+        for (const Shard& shard : m_shards)
+        {
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            stats.numEntries += shard.entries.size();
+            stats.numBytes += shard.numBytes;
+        }
+
+        return stats;
+    }
+
+private:
+    static constexpr size_t NUM_SHARDS = 16;
+
+    // List node, hash node and object headers.
+    static constexpr size_t ENTRY_OVERHEAD = 128;
+
+    struct Entry
+    {
+        std::string key;
+        std::shared_ptr<const Traits::ISerializable> pObject;
+        size_t numBytes;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;
+        std::unordered_map<std::string, std::list<Entry>::iterator> entries;
+        size_t numBytes = 0;
+        uint64_t version = 0;
+    };
+
+    Shard& GetShard(const std::string& key) noexcept { return m_shards[std::hash<std::string>()(key) % NUM_SHARDS]; }
+    const Shard& GetShard(const std::string& key) const noexcept { return m_shards[std::hash<std::string>()(key) % NUM_SHARDS]; }
+
+    static void Erase(Shard& shard, const std::string& key)
+    {
+        auto iter = shard.entries.find(key);
+        shard.numBytes -= iter->second->numBytes;
+        shard.lru.erase(iter->second);
+        shard.entries.erase(iter);
+    }
+
+    size_t m_maxShardBytes;
+    std::array<Shard, NUM_SHARDS> m_shards;
+
+    std::atomic<uint64_t> m_hits;
+    std::atomic<uint64_t> m_misses;
+    std::atomic<uint64_t> m_evictions;
+    std::atomic<uint64_t> m_invalidations;
+};
\ No newline at end of file
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <mw/core/traits/Serializable.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+//
+// Bump allocator for the keys and values of a WriteSet.
+// Memory is handed out from 64KB blocks, and is only freed when the arena is destroyed.
+//
+class Arena
+{
+public:
+    Arena() : m_pNext(nullptr), m_remaining(0), m_allocatedBytes(0) { }
+
+    std::string_view Copy(const uint8_t* pData, const size_t length)
+    {
+        if (length == 0)
+        {
+            return std::string_view();
+        }
+
+        uint8_t* pDest = Allocate(length);
+        memcpy(pDest, pData, length);
+        return std::string_view((const char*)pDest, length);
+    }
+
+    size_t GetAllocatedBytes() const noexcept { return m_allocatedBytes; }
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    uint8_t* Allocate(const size_t length)
+    {
+        // Large values get a block of their own, so the rest of the current block isn't wasted.
+        if (length > BLOCK_SIZE / 4)
+        {
+            m_blocks.push_back(std::make_unique<uint8_t[]>(length));
+            m_allocatedBytes += length;
+            return m_blocks.back().get();
+        }
+
+        if (length > m_remaining)
+        {
+            m_blocks.push_back(std::make_unique<uint8_t[]>(BLOCK_SIZE));
+            m_allocatedBytes += BLOCK_SIZE;
+            m_pNext = m_blocks.back().get();
+            m_remaining = BLOCK_SIZE;
+        }
+
+        uint8_t* pResult = m_pNext;
+        m_pNext += length;
+        m_remaining -= length;
+        return pResult;
+    }
+
+    std::vector<std::unique_ptr<uint8_t[]>> m_blocks;
+    uint8_t* m_pNext;
+    size_t m_remaining;
+    size_t m_allocatedBytes;
+};
+
+//
+// The latest write to each key in a transaction.
+//
+// Keys and serialized values are copied into an arena, and entries are kept in one flat vector, so they don't
+// need an allocation each. The index still allocates a node per new key. A key written again is updated in place,
+// but its old value stays in the arena until the set is destroyed. A deleted key is kept as a tombstone, so it
+// hides older values in the writer or DB.
+//
+// Entries can be visited in key order for range scans. The order is sorted lazily, when first needed after new keys
+// are added. Const methods may be called from several threads at once, as long as nothing is being written.
+//
+class WriteSet
+{
+public:
+    struct Entry
+    {
+        std::string_view key;
+
+        // The serialized value. Empty for a tombstone.
+        std::string_view value;
+
+        // The object the value was serialized from, or nullptr for a tombstone.
+        std::shared_ptr<const Traits::ISerializable> pObject;
+
+        // Whether the key belongs to a cached table, so must be invalidated on commit.
+        bool cached;
+
+        bool IsDeleted() const noexcept { return pObject == nullptr; }
+    };
+
+    WriteSet() : m_sorted(true) { }
+
+    void Put(
+        const std::string& key,
+        const uint8_t* pValue,
+        const size_t valueLength,
+        const std::shared_ptr<const Traits::ISerializable>& pObject,
+        const bool cached)
+    {
+        Entry& entry = Upsert(key, cached);
+        entry.value = m_arena.Copy(pValue, valueLength);
+        entry.pObject = pObject;
+    }
+
+    void Delete(const std::string& key, const bool cached)
+    {
+        Entry& entry = Upsert(key, cached);
+        entry.value = std::string_view();
+        entry.pObject = nullptr;
+    }
+
+    //
+    // Returns the latest write to the key, or nullptr if the key wasn't written.
+    //
+    const Entry* Find(const std::string& key) const noexcept
+    {
+        auto iter = m_index.find(std::string_view(key));
+        return iter != m_index.cend() ? &m_entries[iter->second] : nullptr;
+    }
+
+    //
+    // Visits every entry, tombstones included, in key order.
+    //
+    template<typename F>
+    void ForEach(const F& visitor) const
+    {
+        for (const size_t index : GetOrder())
+        {
+            visitor(m_entries[index]);
+        }
+    }
+
+    //
+    // Visits the entries whose keys start with the prefix, tombstones included, in key order.
+    //
+    template<typename F>
+    void ForEachWithPrefix(const std::string& prefix, const F& visitor) const
+    {
+        const std::vector<size_t>& order = GetOrder();
+
+        auto iter = LowerBound(order, prefix);
+        for (; iter != order.cend() && m_entries[*iter].key.substr(0, prefix.size()) == prefix; iter++)
+        {
+            visitor(m_entries[*iter]);
+        }
+    }
+
+    //
+    // Visits the entries with keys in [begin, end), tombstones included, in key order.
+    //
+    template<typename F>
+    void ForEachInRange(const std::string& begin, const std::string& end, const F& visitor) const
+    {
+        const std::vector<size_t>& order = GetOrder();
+
+        auto iter = LowerBound(order, begin);
+        for (; iter != order.cend() && m_entries[*iter].key < std::string_view(end); iter++)
+        {
+            visitor(m_entries[*iter]);
+        }
+    }
+
+    size_t Size() const noexcept { return m_entries.size(); }
+    bool IsEmpty() const noexcept { return m_entries.empty(); }
+    size_t GetArenaBytes() const noexcept { return m_arena.GetAllocatedBytes(); }
+
+private:
+    Entry& Upsert(const std::string& key, const bool cached)
+    {
+        auto iter = m_index.find(std::string_view(key));
+        if (iter != m_index.end())
+        {
+            Entry& entry = m_entries[iter->second];
+            entry.cached |= cached;
+            return entry;
+        }
+
+        const std::string_view arenaKey = m_arena.Copy((const uint8_t*)key.data(), key.size());
+        m_index.insert({ arenaKey, m_entries.size() });
+        m_order.push_back(m_entries.size());
+        m_entries.push_back(Entry({ arenaKey, std::string_view(), nullptr, cached }));
+        m_sorted.store(false, std::memory_order_relaxed);
+
+        return m_entries.back();
+    }
+
+    std::vector<size_t>::const_iterator LowerBound(const std::vector<size_t>& order, const std::string& key) const
+    {
+        return std::lower_bound(
+            order.cbegin(), order.cend(), std::string_view(key),
+            [this](const size_t index, const std::string_view& key) { return m_entries[index].key < key; }
+        );
+    }
+
+    //
+    // The first reader after new keys are added sorts the order, while any others wait for it.
+    //
+    const std::vector<size_t>& GetOrder() const
+    {
+        if (!m_sorted.load(std::memory_order_acquire))
+        {
+            std::unique_lock<std::mutex> lock(m_sortMutex);
+            if (!m_sorted.load(std::memory_order_relaxed))
+            {
+                std::sort(
+                    m_order.begin(), m_order.end(),
+                    [this](const size_t lhs, const size_t rhs) { return m_entries[lhs].key < m_entries[rhs].key; }
+                );
+                m_sorted.store(true, std::memory_order_release);
+            }
+        }
+
+        return m_order;
+    }
+
+    Arena m_arena;
+    std::vector<Entry> m_entries;
+
+    // Keys point into the arena, so they stay valid as m_entries grows.
+    std::unordered_map<std::string_view, size_t> m_index;
+
+    // Indices into m_entries, in key order once sorted.
+    mutable std::vector<size_t> m_order;
+    mutable std::atomic<bool> m_sorted;
+    mutable std::mutex m_sortMutex;
+};
\ No newline at end of file
@@ -4,6 +4,7 @@
 #if defined(_WIN32)
 #include <Windows.h>
 #else
+#include <fcntl.h>
 #include <unistd.h>
 #endif
 
@@ -49,7 +50,7 @@ void File::Truncate(const uint64_t size)
 
     CloseHandle(hFile);
 #else
-    sucess = (truncate(m_path.c_str(), size) == 0);
+    success = (truncate(m_path.u8string().c_str(), size) == 0);
 #endif
 
     if (!success)
@@ -158,6 +159,39 @@ void File::WriteBytes(const std::map<uint64_t, uint8_t>& bytes)
     file.close();
 }
 
+void File::Sync() const
+{
+    bool success = false;
+
+#if defined(WIN32)
+    HANDLE hFile = CreateFile(
+        m_path.ToString().c_str(),
+        GENERIC_WRITE,
+        FILE_SHARE_READ | FILE_SHARE_WRITE,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL
+    );
+
+    success = hFile != INVALID_HANDLE_VALUE && FlushFileBuffers(hFile);
+
+    CloseHandle(hFile);
+#else
+    const int fd = open(m_path.u8string().c_str(), O_RDWR);
+    if (fd >= 0)
+    {
+        success = (fsync(fd) == 0);
+        close(fd);
+    }
+#endif
+
+    if (!success)
+    {
+        ThrowFile_F("Failed to sync {}", m_path);
+    }
+}
+
 size_t File::GetSize() const
 {
     std::error_code ec;
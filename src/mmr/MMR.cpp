@@ -1,11 +1,18 @@
 #include <mw/core/mmr/MMR.h>
 #include <mw/core/mmr/backends/FileBackend.h>
+#include <mw/core/common/Metrics.h>
+#include <mw/core/common/Tracer.h>
 
 using namespace mmr;
 
 void MMR::Add(std::vector<uint8_t>&& data)
 {
     const LeafIndex leafIdx = m_pBackend->GetNextLeaf();
+    MW_TRACE_SCOPE(MMR_APPEND, leafIdx.GetLeafIndex(), data.size());
+
+    static Counter& numAppended = MetricsAPI::GetCounter("mmr_leaves_appended_total", "Leaves added to any MMR.");
+    numAppended.Add();
+
     m_pBackend->AddLeaf(Leaf::Create(leafIdx, std::move(data)));
 }
 
@@ -75,6 +82,10 @@ void MMR::Rewind(const uint64_t numNodes)
 {
     const Index nextIdx = Index::At(numNodes);
     assert(nextIndex.IsLeaf());
+    MW_TRACE_SCOPE(MMR_REWIND, GetNumNodes(), numNodes);
+
+    static Counter& numRewinds = MetricsAPI::GetCounter("mmr_rewinds_total", "Rewinds of any MMR.");
+    numRewinds.Add();
 
     m_pBackend->Rewind(LeafIndex(nextIdx.GetLeafIndex(), nextIdx.GetPosition()));
 }
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include <mw/core/net/AsyncSocket.h>
+
+AsyncSocket::AsyncSocket(asio::ip::tcp::socket&& socket, const size_t maxQueuedBytes)
+    : m_socket(std::move(socket)),
+    m_readTimer(m_socket.get_executor()),
+    m_writeTimer(m_socket.get_executor()),
+    m_timedOut(false),
+    m_reading(false),
+    m_writing(false),
+    m_maxQueuedBytes(maxQueuedBytes),
+    m_queuedBytes(0)
+{
+
+}
+
+void AsyncSocket::AsyncConnect(
+    IOContextPool& pool,
+    const SocketAddress& address,
+    const Duration& timeout,
+    ConnectHandler handler,
+    const size_t maxQueuedBytes)
+{
+    auto pSocket = AsyncSocket::Ptr(new AsyncSocket(asio::ip::tcp::socket(pool.GetContext()), maxQueuedBytes));
+
+    asio::post(pSocket->m_socket.get_executor(), [pSocket, endpoint = address.GetEndpoint(), timeout, handler = std::move(handler)]() {
+        pSocket->StartDeadline(pSocket->m_readTimer, timeout);
+        pSocket->m_socket.async_connect(endpoint, [pSocket, handler](const asio::error_code& ec) {
+            StopDeadline(pSocket->m_readTimer);
+
+            const asio::error_code result = pSocket->ToResult(ec);
+            handler(result, result ? nullptr : pSocket);
+        });
+    });
+}
+
+void AsyncSocket::AsyncAccept(
+    asio::ip::tcp::acceptor& acceptor,
+    IOContextPool& pool,
+    ConnectHandler handler,
+    const size_t maxQueuedBytes)
+{
+    // Started on the acceptor's executor, like the cancels in Socket::Accept and Server, so the two never race.
+    asio::post(acceptor.get_executor(), [&acceptor, &pool, handler = std::move(handler), maxQueuedBytes]() {
+        acceptor.async_accept(pool.GetContext(), [handler, maxQueuedBytes](const asio::error_code& ec, asio::ip::tcp::socket socket) {
+            if (ec)
+            {
+                handler(ec, nullptr);
+                return;
+            }
+
+            auto pSocket = AsyncSocket::Ptr(new AsyncSocket(std::move(socket), maxQueuedBytes));
+
+            // The handler belongs on the new socket's thread, not the acceptor's.
+            asio::post(pSocket->m_socket.get_executor(), [pSocket, handler]() { handler(asio::error_code(), pSocket); });
+        });
+    });
+}
+
+void AsyncSocket::AsyncReadLine(const Duration& timeout, ReadLineHandler handler)
+{
+    asio::post(m_socket.get_executor(), [pSelf = shared_from_this(), timeout, handler = std::move(handler)]() {
+        if (pSelf->m_reading)
+        {
+            handler(asio::error::already_started, std::string());
+            return;
+        }
+
+        // Completes immediately if the buffer already holds a line.
+        pSelf->m_reading = true;
+        pSelf->StartDeadline(pSelf->m_readTimer, timeout);
+        asio::async_read_until(
+            pSelf->m_socket,
+            asio::dynamic_buffer(pSelf->m_readBuffer, MAX_LINE_LENGTH),
+            '\n',
+            [pSelf, handler](const asio::error_code& ec, const size_t length) {
+                pSelf->m_reading = false;
+                StopDeadline(pSelf->m_readTimer);
+
+                if (ec)
+                {
+                    handler(pSelf->ToResult(ec), std::string());
+                    return;
+                }
+
+                std::string line(pSelf->m_readBuffer.substr(0, length - 1));
+                pSelf->m_readBuffer.erase(0, length);
+                handler(asio::error_code(), std::move(line));
+            }
+        );
+    });
+}
+
+void AsyncSocket::AsyncRead(const size_t numBytes, const Duration& timeout, ReadHandler handler)
+{
+    asio::post(m_socket.get_executor(), [pSelf = shared_from_this(), numBytes, timeout, handler = std::move(handler)]() {
+        if (pSelf->m_reading)
+        {
+            handler(asio::error::already_started, std::vector<uint8_t>());
+            return;
+        }
+
+        if (pSelf->m_readBuffer.size() >= numBytes)
+        {
+            handler(asio::error_code(), pSelf->TakeBytes(numBytes));
+            return;
+        }
+
+        pSelf->m_reading = true;
+        pSelf->StartDeadline(pSelf->m_readTimer, timeout);
+        asio::async_read(
+            pSelf->m_socket,
+            asio::dynamic_buffer(pSelf->m_readBuffer),
+            asio::transfer_exactly(numBytes - pSelf->m_readBuffer.size()),
+            [pSelf, numBytes, handler](const asio::error_code& ec, const size_t) {
+                pSelf->m_reading = false;
+                StopDeadline(pSelf->m_readTimer);
+
+                if (ec)
+                {
+                    handler(pSelf->ToResult(ec), std::vector<uint8_t>());
+                    return;
+                }
+
+                handler(asio::error_code(), pSelf->TakeBytes(numBytes));
+            }
+        );
+    });
+}
+
+bool AsyncSocket::AsyncWrite(std::vector<uint8_t>&& data, const Duration& timeout, WriteHandler handler)
+{
+    const size_t size = data.size();
+
+    size_t queued = m_queuedBytes.load(std::memory_order_relaxed);
+    do
+    {
+        if (queued != 0 && queued + size > m_maxQueuedBytes)
+        {
+            return false;
+        }
+    } while (!m_queuedBytes.compare_exchange_weak(queued, queued + size, std::memory_order_relaxed));
+
+    asio::post(m_socket.get_executor(), [pSelf = shared_from_this(), request = WriteRequest({ std::move(data), timeout, std::move(handler) })]() mutable {
+        pSelf->m_writeQueue.push_back(std::move(request));
+        if (!pSelf->m_writing)
+        {
+            pSelf->m_writing = true;
+            pSelf->WriteNext();
+        }
+    });
+
+    return true;
+}
+
+void AsyncSocket::WriteNext()
+{
+    const WriteRequest& request = m_writeQueue.front();
+
+    StartDeadline(m_writeTimer, request.timeout);
+    asio::async_write(m_socket, asio::buffer(request.data), [pSelf = shared_from_this()](const asio::error_code& ec, const size_t) {
+        StopDeadline(pSelf->m_writeTimer);
+
+        WriteRequest written = std::move(pSelf->m_writeQueue.front());
+        pSelf->m_writeQueue.pop_front();
+        pSelf->m_queuedBytes.fetch_sub(written.data.size(), std::memory_order_relaxed);
+
+        const asio::error_code result = pSelf->ToResult(ec);
+        written.handler(result);
+
+        if (result)
+        {
+            // The rest of the stream can't be delivered in order, so everything still queued fails too.
+            while (!pSelf->m_writeQueue.empty())
+            {
+                WriteRequest failed = std::move(pSelf->m_writeQueue.front());
+                pSelf->m_writeQueue.pop_front();
+                pSelf->m_queuedBytes.fetch_sub(failed.data.size(), std::memory_order_relaxed);
+                failed.handler(result);
+            }
+        }
+
+        if (pSelf->m_writeQueue.empty())
+        {
+            pSelf->m_writing = false;
+        }
+        else
+        {
+            pSelf->WriteNext();
+        }
+    });
+}
+
+void AsyncSocket::Close()
+{
+    asio::post(m_socket.get_executor(), [pSelf = shared_from_this()]() { pSelf->CloseSocket(); });
+}
+
+void AsyncSocket::StartDeadline(asio::steady_timer& timer, const Duration& timeout)
+{
+    timer.expires_after(timeout);
+    timer.async_wait([pWeak = weak_from_this(), &timer](const asio::error_code& ec) {
+        auto pSelf = pWeak.lock();
+        if (ec || pSelf == nullptr)
+        {
+            return;
+        }
+
+        // The operation may have completed after the timer fired, but before this ran.
+        if (timer.expiry() <= asio::steady_timer::clock_type::now())
+        {
+            pSelf->m_timedOut = true;
+            pSelf->CloseSocket();
+        }
+    });
+}
+
+void AsyncSocket::StopDeadline(asio::steady_timer& timer)
+{
+    // Also cancels the pending wait, and tells a wait that already fired that it's stale.
+    timer.expires_at(asio::steady_timer::time_point::max());
+}
+
+asio::error_code AsyncSocket::ToResult(const asio::error_code& ec) const noexcept
+{
+    if (ec && m_timedOut)
+    {
+        return asio::error::timed_out;
+    }
+
+    return ec;
+}
+
+std::vector<uint8_t> AsyncSocket::TakeBytes(const size_t numBytes)
+{
+    std::vector<uint8_t> bytes(m_readBuffer.begin(), m_readBuffer.begin() + numBytes);
+    m_readBuffer.erase(0, numBytes);
+    return bytes;
+}
+
+void AsyncSocket::CloseSocket() noexcept
+{
+    asio::error_code ec;
+    m_socket.close(ec);
+}
\ No newline at end of file
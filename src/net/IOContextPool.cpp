@@ -0,0 +1,11 @@
+#include <mw/core/net/IOContextPool.h>
+
+IOContextPool& IOContextPool::GetDefault()
+{
+    // Never destroyed, since sockets may still be closing on it at exit.
+    // A few threads are plenty, as none of them should ever block.
+    static IOContextPool::Ptr* pPool = new IOContextPool::Ptr(IOContextPool::Create(
+        std::min<size_t>(std::max<size_t>(std::thread::hardware_concurrency() / 2, 1), 4)
+    ));
+    return **pPool;
+}
\ No newline at end of file
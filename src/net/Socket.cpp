@@ -1,54 +1,118 @@
 #include <mw/core/net/Socket.h>
 
+#include <future>
+
 // TODO: Currently this always creates a real Socket. Need to add support for mock sockets.
 Socket::Ptr Socket::Connect(
     const SocketAddress& address,
     const std::chrono::steady_clock::duration& timeout)
 {
-    auto pContext = std::make_shared<asio::io_context>();
-    auto pSocket = std::make_shared<asio::ip::tcp::socket>(*pContext);
-    auto ptr = std::shared_ptr<Socket>(new Socket(pContext, pSocket));
-
-    // Start the asynchronous operation itself. The boost::lambda function
-    // object is used as a callback and will update the ec variable when the
-    // operation completes. The blocking_udp_client.cpp example shows how you
-    // can use boost::bind rather than boost::lambda.
-    asio::error_code ec;
-    ptr->m_pSocket->async_connect(
-        address.GetEndpoint(),
-        std::bind(&Socket::HandleConnect, std::placeholders::_1, &ec)
-    );
-
-    // Run the operation until it completes, or until the timeout.
-    ptr->run(timeout);
-
-    // Determine whether a connection was successfully established.
-    if (ec)
+    auto pPromise = std::make_shared<std::promise<AsyncSocket::Ptr>>();
+    std::future<AsyncSocket::Ptr> future = pPromise->get_future();
+
+    AsyncSocket::AsyncConnect(IOContextPool::GetDefault(), address, timeout, [pPromise](const asio::error_code& ec, AsyncSocket::Ptr pSocket) {
+        if (ec)
+        {
+            pPromise->set_exception(std::make_exception_ptr(asio::system_error(ec)));
+        }
+        else
+        {
+            pPromise->set_value(pSocket);
+        }
+    });
+
+    return std::shared_ptr<Socket>(new Socket(future.get()));
+}
+
+Socket::Ptr Socket::Accept(
+    asio::ip::tcp::acceptor& acceptor,
+    const std::chrono::steady_clock::duration& timeout)
+{
+    auto pPromise = std::make_shared<std::promise<AsyncSocket::Ptr>>();
+    std::future<AsyncSocket::Ptr> future = pPromise->get_future();
+
+    AsyncSocket::AsyncAccept(acceptor, IOContextPool::GetDefault(), [pPromise](const asio::error_code& ec, AsyncSocket::Ptr pSocket) {
+        if (ec)
+        {
+            pPromise->set_exception(std::make_exception_ptr(asio::system_error(ec)));
+        }
+        else
+        {
+            pPromise->set_value(pSocket);
+        }
+    });
+
+    if (future.wait_for(timeout) == std::future_status::timeout)
     {
-        throw asio::system_error(ec);
+        // The acceptor can only be touched from its own executor. If a connection arrives first, it's returned anyway.
+        asio::post(acceptor.get_executor(), [&acceptor]() {
+            asio::error_code ec;
+            acceptor.cancel(ec);
+        });
     }
 
-    return ptr;
+    return std::shared_ptr<Socket>(new Socket(future.get()));
 }
 
-Socket::Ptr Socket::Accept(
-    std::shared_ptr<asio::io_context> pContext,
-    asio::ip::tcp::acceptor& acceptor)
+std::string Socket::ReadLine(const std::chrono::steady_clock::duration& timeout)
+{
+    auto pPromise = std::make_shared<std::promise<std::string>>();
+    std::future<std::string> future = pPromise->get_future();
+
+    m_pSocket->AsyncReadLine(timeout, [pPromise](const asio::error_code& ec, std::string&& line) {
+        if (ec)
+        {
+            pPromise->set_exception(std::make_exception_ptr(asio::system_error(ec)));
+        }
+        else
+        {
+            pPromise->set_value(std::move(line));
+        }
+    });
+
+    return future.get();
+}
+
+std::vector<uint8_t> Socket::Read(const size_t numBytes, const std::chrono::steady_clock::duration& timeout)
 {
-    auto pSocket = std::make_shared<asio::ip::tcp::socket>(*pContext);
-    auto ptr = std::shared_ptr<Socket>(new Socket(pContext, pSocket));
+    auto pPromise = std::make_shared<std::promise<std::vector<uint8_t>>>();
+    std::future<std::vector<uint8_t>> future = pPromise->get_future();
 
-    asio::error_code ec;
-    acceptor.async_accept(*pSocket, [&ec, pContext](const asio::error_code& error) {
-        ec = error;
+    m_pSocket->AsyncRead(numBytes, timeout, [pPromise](const asio::error_code& ec, std::vector<uint8_t>&& bytes) {
+        if (ec)
+        {
+            pPromise->set_exception(std::make_exception_ptr(asio::system_error(ec)));
+        }
+        else
+        {
+            pPromise->set_value(std::move(bytes));
+        }
     });
 
-    ptr->run(std::chrono::milliseconds(100));
+    return future.get();
+}
+
+void Socket::WriteBytes(std::vector<uint8_t>&& bytes, const std::chrono::steady_clock::duration& timeout)
+{
+    auto pPromise = std::make_shared<std::promise<void>>();
+    std::future<void> future = pPromise->get_future();
+
+    // Nothing else is queued while this blocks, unless the AsyncSocket is also being used directly.
+    const bool queued = m_pSocket->AsyncWrite(std::move(bytes), timeout, [pPromise](const asio::error_code& ec) {
+        if (ec)
+        {
+            pPromise->set_exception(std::make_exception_ptr(asio::system_error(ec)));
+        }
+        else
+        {
+            pPromise->set_value();
+        }
+    });
 
-    if (ec)
+    if (!queued)
     {
-        throw asio::system_error(ec);
+        throw asio::system_error(asio::error::no_buffer_space);
     }
 
-    return ptr;
+    future.get();
 }
\ No newline at end of file
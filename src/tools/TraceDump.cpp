@@ -0,0 +1,136 @@
+#include <mw/core/common/Tracer.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//
+// Reads a trace file written by TracerAPI::Dump().
+//
+// Usage: TraceDump <trace file> [--raw]
+//
+// Prints how long each event took, matching BEGIN and END records per thread.
+// With --raw, every record is printed too, one per line, with timestamps relative to the first record.
+//
+struct EventStats
+{
+    std::vector<uint64_t> durations;
+};
+
+static void PrintRecords(const TraceDump& dump)
+{
+    const uint64_t start = dump.records.empty() ? 0 : dump.records.front().timestamp;
+    for (const TraceRecord& record : dump.records)
+    {
+        const char* phase = record.phase == ETracePhase::BEGIN ? "B" : (record.phase == ETracePhase::END ? "E" : "I");
+        std::printf(
+            "%14.3fus  thread %-4u %s %-20s %llu %llu\n",
+            (record.timestamp - start) / 1000.0,
+            record.threadId,
+            phase,
+            TracerAPI::GetEventName(record.event).c_str(),
+            (unsigned long long)record.payload1,
+            (unsigned long long)record.payload2
+        );
+    }
+}
+
+static void PrintSummary(const TraceDump& dump)
+{
+    // Events nest, so each thread keeps a stack of the ones it's inside.
+    std::unordered_map<uint32_t, std::vector<const TraceRecord*>> openByThread;
+    std::map<std::string, EventStats> statsByEvent;
+    size_t numUnmatched = 0;
+
+    for (const TraceRecord& record : dump.records)
+    {
+        std::vector<const TraceRecord*>& open = openByThread[record.threadId];
+        if (record.phase == ETracePhase::BEGIN)
+        {
+            open.push_back(&record);
+        }
+        else if (record.phase == ETracePhase::END)
+        {
+            // The BEGIN may have been overwritten in the ring buffer before the dump.
+            if (open.empty() || open.back()->event != record.event)
+            {
+                numUnmatched++;
+                continue;
+            }
+
+            statsByEvent[TracerAPI::GetEventName(record.event)].durations.push_back(record.timestamp - open.back()->timestamp);
+            open.pop_back();
+        }
+        else
+        {
+            statsByEvent[TracerAPI::GetEventName(record.event)].durations.push_back(0);
+        }
+    }
+
+    std::printf("%-20s %10s %14s %12s %12s %12s\n", "event", "count", "total_us", "mean_us", "p99_us", "max_us");
+    for (auto& entry : statsByEvent)
+    {
+        std::vector<uint64_t>& durations = entry.second.durations;
+        std::sort(durations.begin(), durations.end());
+
+        uint64_t total = 0;
+        for (const uint64_t duration : durations)
+        {
+            total += duration;
+        }
+
+        std::printf(
+            "%-20s %10zu %14.1f %12.2f %12.2f %12.2f\n",
+            entry.first.c_str(),
+            durations.size(),
+            total / 1000.0,
+            total / 1000.0 / durations.size(),
+            durations[(size_t)(0.99 * (durations.size() - 1))] / 1000.0,
+            durations.back() / 1000.0
+        );
+    }
+
+    std::printf("\n%zu records from %zu threads", dump.records.size(), dump.threads.size());
+    if (numUnmatched > 0)
+    {
+        std::printf(", %zu END records without a BEGIN", numUnmatched);
+    }
+
+    std::printf("\n");
+    for (const auto& thread : dump.threads)
+    {
+        std::printf("  thread %-4u %s\n", thread.first, thread.second.c_str());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: TraceDump <trace file> [--raw]" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        const TraceDump dump = TracerAPI::Load(FilePath(fs::u8path(argv[1])));
+        if (argc > 2 && std::string(argv[2]) == "--raw")
+        {
+            PrintRecords(dump);
+            std::printf("\n");
+        }
+
+        PrintSummary(dump);
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
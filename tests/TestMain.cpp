@@ -25,7 +25,9 @@ void RunTest(const std::string& tests)
 int main(int, char*[])
 {
     RunTest("Common");
+    RunTest("Consensus");
     RunTest("Crypto");
+    RunTest("Database");
     RunTest("File");
     RunTest("MMR");
     RunTest("Models");
@@ -0,0 +1,224 @@
+#include <catch.hpp>
+
+#include <mw/core/common/Lock.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TestBatchable : public Traits::IBatchable
+{
+public:
+    void Commit() final { numCommits++; }
+    void Rollback() noexcept final { numRollbacks++; }
+    void OnInitWrite() noexcept final { numWrites++; }
+
+    int value = 0;
+    int numWrites = 0;
+    int numCommits = 0;
+    int numRollbacks = 0;
+};
+
+TEST_CASE("Locked - Writes")
+{
+    Locked<TestBatchable> locked(std::make_shared<TestBatchable>());
+
+    {
+        auto writer = locked.Write();
+        writer->value = 1;
+    }
+
+    REQUIRE(locked.Read()->value == 1);
+    REQUIRE(locked.Read()->numCommits == 1);
+
+    // Batches are rolled back, unless committed.
+    {
+        auto writer = locked.BatchWrite();
+        writer->value = 2;
+    }
+
+    REQUIRE(locked.Read()->numRollbacks == 1);
+
+    {
+        auto writer = locked.BatchWrite();
+        writer->Commit();
+        writer->SetDirty(false);
+    }
+
+    REQUIRE(locked.Read()->numCommits == 2);
+    REQUIRE(locked.Read()->numRollbacks == 1);
+    REQUIRE(locked.Read()->numWrites == 3);
+
+    // Moving a writer hands over the lock, and clearing it releases the lock.
+    Writer<TestBatchable> writer;
+    REQUIRE(writer.IsNull());
+    writer = locked.Write();
+    Writer<TestBatchable> moved(std::move(writer));
+    REQUIRE(writer.IsNull());
+    REQUIRE_FALSE(moved.IsNull());
+    moved.Clear();
+    REQUIRE(moved.IsNull());
+
+    // Copies share the lock and the object.
+    Locked<TestBatchable> copy(locked);
+    copy.Write()->value = 3;
+    REQUIRE(locked.Read()->value == 3);
+    REQUIRE(locked.Read()->numCommits == 4);
+
+    Locked<std::string> notBatchable(std::make_shared<std::string>("test"));
+    REQUIRE_THROWS_AS(notBatchable.BatchWrite(), UnimplementedException);
+    REQUIRE(*notBatchable.Read() == "test");
+}
+
+TEST_CASE("Locked - MultiLocker")
+{
+    Locked<TestBatchable> locked1(std::make_shared<TestBatchable>());
+    Locked<TestBatchable> locked2(std::make_shared<TestBatchable>());
+
+    {
+        auto writers = MultiLocker().Lock(locked1, locked2);
+        std::get<0>(writers)->value = 1;
+        std::get<1>(writers)->value = 2;
+    }
+
+    {
+        auto readers = MultiLocker().LockShared(locked1, locked2);
+        REQUIRE(std::get<0>(readers)->value == 1);
+        REQUIRE(std::get<1>(readers)->value == 2);
+    }
+
+    {
+        auto writers = MultiLocker().BatchLock(locked1, locked2);
+    }
+
+    REQUIRE(locked1.Read()->numCommits == 1);
+    REQUIRE(locked1.Read()->numRollbacks == 1);
+}
+
+struct Triple
+{
+    uint64_t a;
+    uint64_t b;
+    uint32_t c;
+};
+
+TEST_CASE("SeqLocked")
+{
+    SeqLocked<Triple> triple(Triple({ 0, 0, 0 }));
+
+    std::atomic_bool stop(false);
+    std::thread writer([&triple, &stop] {
+        for (uint64_t i = 1; i <= 200000; i++)
+        {
+            triple.Update([i](Triple& value) {
+                value.a = i;
+                value.b = i * 2;
+                value.c = (uint32_t)(i * 3);
+            });
+        }
+
+        stop = true;
+    });
+
+    // Readers never see a partial write.
+    std::vector<std::thread> readers;
+    std::atomic<size_t> numTorn(0);
+    for (size_t r = 0; r < 3; r++)
+    {
+        readers.push_back(std::thread([&triple, &stop, &numTorn] {
+            uint64_t last = 0;
+            while (!stop)
+            {
+                const Triple value = triple.Load();
+                if (value.b != value.a * 2 || value.c != (uint32_t)(value.a * 3) || value.a < last)
+                {
+                    numTorn++;
+                }
+
+                last = value.a;
+            }
+        }));
+    }
+
+    writer.join();
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+
+    REQUIRE(numTorn == 0);
+    REQUIRE(triple.Load().a == 200000);
+
+    triple.Store(Triple({ 7, 14, 21 }));
+    REQUIRE(triple.Load().c == 21);
+}
+
+//
+// Nanoseconds per lock and unlock, for each thread, when numThreads threads do the same.
+// The values read are summed per thread, and only published to the sink at the end, so the
+// threads don't contend on anything but the lock being measured.
+//
+template<typename F>
+static double Measure(const size_t numThreads, std::atomic<uint64_t>& sink, const F& lockAndUnlock)
+{
+    const size_t numIterations = 1'000'000;
+
+    std::vector<std::thread> threads;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([&lockAndUnlock, &sink, numIterations] {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < numIterations; i++)
+            {
+                sum += lockAndUnlock();
+            }
+
+            sink.fetch_add(sum, std::memory_order_relaxed);
+        }));
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / numIterations;
+}
+
+TEST_CASE("Locked - Benchmark", "[.benchmark]")
+{
+    Locked<Triple> locked(std::make_shared<Triple>(Triple({ 1, 2, 3 })));
+    SeqLocked<Triple> seqLocked(Triple({ 1, 2, 3 }));
+    std::atomic<uint64_t> sink(0);
+
+    for (size_t numThreads : { 1, 2, 4, 8 })
+    {
+        const double read = Measure(numThreads, sink, [&locked] { return locked.Read()->a; });
+        const double write = Measure(numThreads, sink, [&locked] { return ++locked.Write()->a; });
+        const double seqRead = Measure(numThreads, sink, [&seqLocked] { return seqLocked.Load().a; });
+
+        std::cout << numThreads << " threads: Read " << read << "ns, Write " << write << "ns, SeqLocked::Load " << seqRead << "ns" << std::endl;
+    }
+
+    // Reads while another thread keeps writing.
+    std::atomic_bool stop(false);
+    std::thread writer([&locked, &seqLocked, &stop] {
+        while (!stop)
+        {
+            locked.Write()->a++;
+            seqLocked.Update([](Triple& value) { value.a++; });
+        }
+    });
+
+    const double read = Measure(4, sink, [&locked] { return locked.Read()->a; });
+    const double seqRead = Measure(4, sink, [&seqLocked] { return seqLocked.Load().a; });
+    stop = true;
+    writer.join();
+
+    std::cout << "4 threads with a writer: Read " << read << "ns, SeqLocked::Load " << seqRead << "ns" << std::endl;
+}
\ No newline at end of file
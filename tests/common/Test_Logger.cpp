@@ -0,0 +1,260 @@
+#include <catch.hpp>
+
+#include <mw/core/common/Logger.h>
+#include <LogQueue.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static LogMessage MakeMessage(const LoggerAPI::LogLevel level, const std::string& text)
+{
+    return LogMessage({ LoggerAPI::LogFile::NODE, level, std::chrono::system_clock::now(), "", text });
+}
+
+static std::vector<std::string> PopAll(LogQueue& queue)
+{
+    std::vector<std::string> texts;
+    LogMessage message;
+    while (queue.TryPop(message))
+    {
+        texts.push_back(message.text);
+    }
+
+    return texts;
+}
+
+TEST_CASE("LogQueue - Overflow")
+{
+    auto noop = [] { };
+
+    SECTION("DROP_NEWEST")
+    {
+        LogQueue queue(4, LoggerAPI::OverflowPolicy::DROP_NEWEST);
+        for (int i = 0; i < 6; i++)
+        {
+            REQUIRE(queue.Push(MakeMessage(LoggerAPI::LogLevel::DEBUG, std::to_string(i)), noop) == (i < 4));
+        }
+
+        REQUIRE(queue.GetNumDropped() == 2);
+        REQUIRE(queue.GetMaxDepth() == 4);
+        REQUIRE(PopAll(queue) == std::vector<std::string>({ "0", "1", "2", "3" }));
+        REQUIRE(queue.GetDepth() == 0);
+    }
+
+    SECTION("DROP_OLDEST")
+    {
+        LogQueue queue(4, LoggerAPI::OverflowPolicy::DROP_OLDEST);
+        for (int i = 0; i < 6; i++)
+        {
+            REQUIRE(queue.Push(MakeMessage(LoggerAPI::LogLevel::DEBUG, std::to_string(i)), noop));
+        }
+
+        REQUIRE(queue.GetNumDropped() == 2);
+        REQUIRE(PopAll(queue) == std::vector<std::string>({ "2", "3", "4", "5" }));
+    }
+
+    SECTION("Warnings wait for space")
+    {
+        LogQueue queue(4, LoggerAPI::OverflowPolicy::DROP_NEWEST);
+        for (int i = 0; i < 4; i++)
+        {
+            queue.Push(MakeMessage(LoggerAPI::LogLevel::DEBUG, std::to_string(i)), noop);
+        }
+
+        std::atomic<int> numFull(0);
+        std::thread warner([&queue, &numFull] {
+            queue.Push(MakeMessage(LoggerAPI::LogLevel::WARN, "warning"), [&numFull] { numFull++; });
+        });
+
+        while (numFull == 0)
+        {
+            std::this_thread::yield();
+        }
+
+        LogMessage message;
+        REQUIRE(queue.TryPop(message));
+        warner.join();
+
+        REQUIRE(queue.GetNumDropped() == 0);
+        REQUIRE(PopAll(queue) == std::vector<std::string>({ "1", "2", "3", "warning" }));
+    }
+}
+
+TEST_CASE("LogQueue - Concurrent")
+{
+    LogQueue queue(64, LoggerAPI::OverflowPolicy::BLOCK);
+
+    const size_t numThreads = 4;
+    const size_t numMessages = 50000;
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([&queue, t, numMessages] {
+            for (size_t i = 0; i < numMessages; i++)
+            {
+                queue.Push(MakeMessage(LoggerAPI::LogLevel::TRACE, std::to_string(t) + ":" + std::to_string(i)), [] { });
+            }
+        }));
+    }
+
+    // Each thread's messages come out in the order they went in, and none are lost.
+    std::vector<size_t> nextByThread(numThreads, 0);
+    size_t numReceived = 0;
+    LogMessage message;
+    while (numReceived < numThreads * numMessages)
+    {
+        if (!queue.TryPop(message))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        const size_t separator = message.text.find(':');
+        const size_t t = std::stoull(message.text.substr(0, separator));
+        REQUIRE(std::stoull(message.text.substr(separator + 1)) == nextByThread[t]++);
+        numReceived++;
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE(queue.GetNumDropped() == 0);
+    REQUIRE(queue.GetMaxDepth() <= queue.GetCapacity());
+}
+
+TEST_CASE("Logger - Async")
+{
+    const FilePath logDirectory(fs::temp_directory_path() / ("logger_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count())));
+
+    LoggerAPI::Options options;
+    options.queueSize = 1024;
+    options.overflowPolicy = LoggerAPI::OverflowPolicy::DROP_NEWEST;
+    LoggerAPI::Initialize(logDirectory, "TRACE", options);
+
+    const size_t numThreads = 4;
+    const size_t numMessages = 10000;
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([numMessages] {
+            for (size_t i = 0; i < numMessages; i++)
+            {
+                LOG_INFO_F("Async test message {}", i);
+            }
+        }));
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    LOG_ERROR("Async test error");
+    LoggerAPI::Flush();
+
+    // Every message was either written or counted as dropped, and the error was never dropped.
+    const LoggerAPI::Stats stats = LoggerAPI::GetStats();
+    REQUIRE(stats.queueDepth == 0);
+    REQUIRE(stats.maxQueueDepth <= 1024);
+
+    size_t numLines = 0;
+    size_t numErrors = 0;
+    std::ifstream file(logDirectory.GetChild("Node.log").ToPath());
+    for (std::string line; std::getline(file, line);)
+    {
+        numLines += line.find("Async test message") != std::string::npos ? 1 : 0;
+        numErrors += line.find("Async test error") != std::string::npos ? 1 : 0;
+    }
+
+    REQUIRE(numErrors == 1);
+    REQUIRE(numLines + stats.numDropped == numThreads * numMessages);
+    REQUIRE(stats.numWritten >= numLines + 1);
+
+    // A message below its module's threshold is dropped by the logger itself, before it's queued.
+    const std::atomic<uint8_t> threshold((uint8_t)LoggerAPI::LogLevel::WARN);
+    LoggerAPI::Log(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::INFO, threshold, __FUNCTION__, __LINE__, "Below threshold");
+    LoggerAPI::Log(LoggerAPI::LogFile::NODE, LoggerAPI::LogLevel::WARN, threshold, __FUNCTION__, __LINE__, "At threshold");
+    LoggerAPI::Flush();
+    REQUIRE(LoggerAPI::GetStats().numWritten == stats.numWritten + 1);
+}
+
+//
+// Restores the default level, and this module's level, when the test ends, even if it fails.
+// The module is taken to have had a level of its own if its threshold differed from the default.
+//
+class LogLevelRestorer
+{
+public:
+    LogLevelRestorer()
+        : m_defaultLevel(LoggerAPI::GetLogLevel(LoggerAPI::LogFile::NODE)),
+        m_moduleLevel(ToLevel(LoggerAPI::GetThreshold(LoggerAPI::LogFile::NODE, MW_LOG_MODULE).load())) { }
+
+    ~LogLevelRestorer()
+    {
+        LoggerAPI::SetLogLevel(LoggerAPI::LogFile::NODE, "", m_defaultLevel);
+
+        if (m_moduleLevel == m_defaultLevel)
+        {
+            LoggerAPI::ClearLogLevel(LoggerAPI::LogFile::NODE, MW_LOG_MODULE);
+        }
+        else
+        {
+            LoggerAPI::SetLogLevel(LoggerAPI::LogFile::NODE, MW_LOG_MODULE, m_moduleLevel);
+        }
+    }
+
+private:
+    static LoggerAPI::LogLevel ToLevel(const uint8_t threshold) noexcept
+    {
+        return threshold > LoggerAPI::LogLevel::ERR ? LoggerAPI::LogLevel::NONE : (LoggerAPI::LogLevel)threshold;
+    }
+
+    LoggerAPI::LogLevel m_defaultLevel;
+    LoggerAPI::LogLevel m_moduleLevel;
+};
+
+TEST_CASE("Logger - Levels")
+{
+    LogLevelRestorer restorer;
+
+    int numEvaluated = 0;
+    auto evaluate = [&numEvaluated] { return ++numEvaluated; };
+
+    // Arguments are only evaluated for levels that are enabled.
+    LoggerAPI::SetLogLevel(LoggerAPI::LogFile::NODE, "", LoggerAPI::LogLevel::WARN);
+    LOG_INFO_F("Levels test {}", evaluate());
+    REQUIRE(numEvaluated == 0);
+    LOG_WARNING_F("Levels test {}", evaluate());
+    REQUIRE(numEvaluated == 1);
+
+    // A module's own level overrides the default, and changes take effect immediately.
+    LoggerAPI::SetLogLevel(LoggerAPI::LogFile::NODE, MW_LOG_MODULE, LoggerAPI::LogLevel::DEBUG);
+    LOG_INFO_F("Levels test {}", evaluate());
+    REQUIRE(numEvaluated == 2);
+
+    LoggerAPI::SetLogLevel(LoggerAPI::LogFile::NODE, "", LoggerAPI::LogLevel::TRACE);
+    LOG_INFO_F("Levels test {}", evaluate());
+    REQUIRE(numEvaluated == 3);
+    REQUIRE(LoggerAPI::GetLogLevel(LoggerAPI::LogFile::NODE) == LoggerAPI::LogLevel::TRACE);
+
+    // DEBUG is enabled for this module, but compiled out of release builds.
+    LOG_DEBUG_F("Levels test {}", evaluate());
+    REQUIRE(numEvaluated == (LoggerAPI::LogLevel::DEBUG >= MW_LOG_MIN_LEVEL ? 4 : 3));
+
+    LoggerAPI::SetLogLevel(LoggerAPI::LogFile::NODE, MW_LOG_MODULE, LoggerAPI::LogLevel::NONE);
+    LOG_ERROR_F("Levels test {}", evaluate());
+    REQUIRE(numEvaluated == (LoggerAPI::LogLevel::DEBUG >= MW_LOG_MIN_LEVEL ? 4 : 3));
+
+    // Once cleared, the module follows the default again.
+    LoggerAPI::ClearLogLevel(LoggerAPI::LogFile::NODE, MW_LOG_MODULE);
+    LOG_ERROR_F("Levels test {}", evaluate());
+    REQUIRE(numEvaluated == (LoggerAPI::LogLevel::DEBUG >= MW_LOG_MIN_LEVEL ? 5 : 4));
+}
\ No newline at end of file
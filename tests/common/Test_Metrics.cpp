@@ -0,0 +1,98 @@
+#include <catch.hpp>
+
+#include <mw/core/common/Metrics.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Metrics - Counter")
+{
+    Counter& counter = MetricsAPI::GetCounter("test_counter_total", "Counter test.");
+    REQUIRE(&counter == &MetricsAPI::GetCounter("test_counter_total", "Counter test."));
+    REQUIRE(&counter != &MetricsAPI::GetCounter("test_counter_total", "Counter test.", "shard=\"other\""));
+
+    const size_t numThreads = 8;
+    const size_t numAdds = 100000;
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([&counter, numAdds] {
+            for (size_t i = 0; i < numAdds; i++)
+            {
+                counter.Add();
+            }
+        }));
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE(counter.GetValue() == numThreads * numAdds);
+}
+
+TEST_CASE("Metrics - Histogram")
+{
+    // Every value falls in a bucket whose bounds are within 1/16th of it.
+    for (uint64_t value : { 0ull, 1ull, 15ull, 16ull, 17ull, 31ull, 32ull, 1000ull, 123456789ull, 1ull << 42 })
+    {
+        const size_t index = Histogram::GetBucketIndex(value);
+        REQUIRE(index < Histogram::NUM_BUCKETS);
+        REQUIRE(Histogram::GetUpperBound(index) >= value);
+        REQUIRE(Histogram::GetUpperBound(index) - value <= value / Histogram::NUM_SUB_BUCKETS);
+        REQUIRE((index == 0 || Histogram::GetUpperBound(index - 1) < value));
+    }
+
+    REQUIRE(Histogram::GetBucketIndex(UINT64_MAX) == Histogram::NUM_BUCKETS - 1);
+
+    Histogram histogram;
+    for (uint64_t i = 1; i <= 1000; i++)
+    {
+        histogram.Record(i * 1000);
+    }
+    histogram.Record(std::chrono::milliseconds(50));
+
+    const Histogram::Snapshot snapshot = histogram.GetSnapshot();
+    REQUIRE(snapshot.count == 1001);
+    REQUIRE(snapshot.sum == 500500 * 1000 + 50'000'000);
+    REQUIRE(snapshot.max == 50'000'000);
+    REQUIRE(snapshot.GetQuantile(1.0) == 50'000'000);
+
+    const uint64_t median = snapshot.GetQuantile(0.5);
+    REQUIRE(median >= 501'000);
+    REQUIRE(median <= 501'000 + 501'000 / 16);
+
+    const uint64_t p99 = snapshot.GetQuantile(0.99);
+    REQUIRE(p99 >= 991'000);
+    REQUIRE(p99 <= 991'000 + 991'000 / 16);
+}
+
+TEST_CASE("Metrics - Render")
+{
+    MetricsAPI::GetCounter("test_render_total", "Render test counter.").Add(3);
+    MetricsAPI::GetGauge("test_render_gauge", "Render test gauge.", "name=\"a\"").Set(-7);
+
+    Histogram& histogram = MetricsAPI::GetHistogram("test_render_seconds", "Render test histogram.");
+    histogram.Record(std::chrono::milliseconds(250));
+    histogram.Record(std::chrono::milliseconds(250));
+
+    const std::string text = MetricsAPI::Render();
+    REQUIRE(text.find("# HELP test_render_total Render test counter.\n# TYPE test_render_total counter\ntest_render_total 3\n") != std::string::npos);
+    REQUIRE(text.find("# TYPE test_render_gauge gauge\ntest_render_gauge{name=\"a\"} -7\n") != std::string::npos);
+    REQUIRE(text.find("# TYPE test_render_seconds summary\n") != std::string::npos);
+    REQUIRE(text.find("test_render_seconds{quantile=\"0.5\"} 0.25\n") != std::string::npos);
+    REQUIRE(text.find("test_render_seconds_sum 0.5\n") != std::string::npos);
+    REQUIRE(text.find("test_render_seconds_count 2\n") != std::string::npos);
+}
+TEST_CASE("Metrics - Label Escaping")
+{
+    REQUIRE(MetricsAPI::FormatLabel("mmr", "kernels") == "mmr=\"kernels\"");
+    REQUIRE(MetricsAPI::FormatLabel("path", "C:\\data\\\"mw\"\nnext") == "path=\"C:\\\\data\\\\\\\"mw\\\"\\nnext\"");
+
+    MetricsAPI::GetGauge("test_escaped_gauge", "Escaping test gauge.", MetricsAPI::FormatLabel("name", "a\"b")).Set(1);
+    REQUIRE(MetricsAPI::Render().find("test_escaped_gauge{name=\"a\\\"b\"} 1\n") != std::string::npos);
+}
\ No newline at end of file
@@ -28,4 +28,109 @@ TEST_CASE("Scheduler")
     REQUIRE(secondTask == 1);
     REQUIRE(thirdTask == 0);
     REQUIRE(fourthTask == 1);
+}
+
+TEST_CASE("Scheduler - Cancel")
+{
+    auto pScheduler = Scheduler::Create(2);
+
+    // The third run waits to be released, so it's still running when it's cancelled.
+    std::atomic<int> timesRun(0);
+    std::promise<void> thirdRunStarted;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    Scheduler::Handle handle = pScheduler->RunEvery([&timesRun, &thirdRunStarted, released] {
+        if (++timesRun == 3)
+        {
+            thirdRunStarted.set_value();
+            released.wait();
+        }
+    }, std::chrono::milliseconds(5));
+
+    thirdRunStarted.get_future().wait();
+    REQUIRE(handle.Cancel());
+    REQUIRE(handle.IsCancelled());
+    REQUIRE_FALSE(handle.Cancel());
+
+    // The run that started before the cancel finishes, but isn't rescheduled.
+    // A later one-off task runs after where the next run would have been due.
+    release.set_value();
+    std::promise<void> markerRan;
+    pScheduler->RunAfter([&markerRan] { markerRan.set_value(); }, std::chrono::milliseconds(20));
+    markerRan.get_future().wait();
+    REQUIRE(timesRun == 3);
+
+    // A one-off task that already ran can't be cancelled.
+    std::promise<void> ran;
+    Scheduler::Handle onceHandle = pScheduler->RunOnce([&ran] { ran.set_value(); });
+    ran.get_future().wait();
+    REQUIRE_FALSE(onceHandle.Cancel());
+
+    // Nor once the scheduler is gone, while a task that never ran still can be.
+    std::promise<void> ranBeforeDestroy;
+    Scheduler::Handle ranHandle = pScheduler->RunOnce([&ranBeforeDestroy] { ranBeforeDestroy.set_value(); });
+    ranBeforeDestroy.get_future().wait();
+    Scheduler::Handle lateHandle = pScheduler->RunAfter([] { }, std::chrono::hours(1));
+    pScheduler.reset();
+    REQUIRE_FALSE(ranHandle.Cancel());
+    REQUIRE(lateHandle.Cancel());
+    REQUIRE_FALSE(lateHandle.Cancel());
+}
+
+//
+// Schedules and cancels a million timers from several threads.
+// Half are due in an hour, so every cancel succeeds, and the heap has to be compacted to stay small.
+// The rest are due within a couple of milliseconds, so cancels race with the workers, and a task must run exactly when its cancel fails.
+//
+TEST_CASE("Scheduler - Schedule and cancel stress")
+{
+    auto pScheduler = Scheduler::Create(4);
+
+    const size_t numThreads = 4;
+    const size_t iterations = 125000;
+
+    std::atomic<size_t> numRun(0);
+    std::atomic<size_t> numLongRun(0);
+    std::atomic<size_t> numCancelFailed(0);
+    std::atomic<size_t> numLongCancelFailed(0);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([&, t] {
+            for (size_t i = 0; i < iterations; i++)
+            {
+                Scheduler::Handle longHandle = pScheduler->RunAfter([&numLongRun] { numLongRun++; }, std::chrono::hours(1));
+
+                const std::chrono::milliseconds delay((i + t) % 3);
+                Scheduler::Handle shortHandle = pScheduler->RunAfter([&numRun] { numRun++; }, delay);
+                if (i % 7 == 0)
+                {
+                    std::this_thread::yield();
+                }
+
+                if (!shortHandle.Cancel())
+                {
+                    numCancelFailed++;
+                }
+
+                if (!longHandle.Cancel())
+                {
+                    numLongCancelFailed++;
+                }
+            }
+        }));
+    }
+
+    ThreadUtil::JoinAll(threads);
+
+    // Everything left in the heap was cancelled, so it's been compacted away.
+    REQUIRE(pScheduler->GetNumTimers() < 1000);
+
+    // Workers finish the runs they've started before they exit.
+    pScheduler.reset();
+
+    REQUIRE(numLongRun == 0);
+    REQUIRE(numLongCancelFailed == 0);
+    REQUIRE(numRun == numCancelFailed);
 }
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include <catch.hpp>
+
+#include <mw/core/common/Scheduler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+using namespace std::chrono;
+
+//
+// Collects how late each run was, in microseconds.
+//
+class Latencies
+{
+public:
+    void Add(const Scheduler::Clock::duration& latency)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_latencies.push_back(duration_cast<microseconds>(latency).count());
+    }
+
+    void Print(const std::string& name)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        std::sort(m_latencies.begin(), m_latencies.end());
+
+        auto percentile = [this](const double p) { return m_latencies[(size_t)(p * (m_latencies.size() - 1))]; };
+        std::cout << name << ": " << m_latencies.size() << " runs, latency p50 " << percentile(0.5)
+            << "us, p99 " << percentile(0.99) << "us, max " << m_latencies.back() << "us" << std::endl;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<int64_t> m_latencies;
+};
+
+//
+// CPU time used by the whole process, so the workers are included.
+//
+static double GetCPUSeconds()
+{
+    return (double)std::clock() / CLOCKS_PER_SEC;
+}
+
+//
+// Measures dispatch latency of one-off and periodic tasks, and the CPU used while 10k periodic tasks are idle.
+// Hidden, so it only runs when asked for: Common_Tests [benchmark]
+//
+TEST_CASE("Scheduler - Dispatch benchmark", "[.benchmark]")
+{
+    auto pScheduler = Scheduler::Create(4);
+
+    // One-off tasks, from RunOnce to the start of the task.
+    {
+        Latencies latencies;
+        for (size_t i = 0; i < 10000; i++)
+        {
+            const auto queued = Scheduler::Clock::now();
+            pScheduler->RunOnce([&latencies, queued] { latencies.Add(Scheduler::Clock::now() - queued); });
+
+            if (i % 100 == 0)
+            {
+                std::this_thread::sleep_for(milliseconds(1));
+            }
+        }
+
+        std::this_thread::sleep_for(milliseconds(500));
+        latencies.Print("RunOnce");
+    }
+
+    // 10k periodic tasks with staggered 100ms intervals, measured against when each run was due.
+    {
+        Latencies latencies;
+        std::vector<Scheduler::Clock::time_point> lastRuns(10000, Scheduler::Clock::now());
+        std::vector<Scheduler::Handle> handles;
+        for (size_t i = 0; i < lastRuns.size(); i++)
+        {
+            const milliseconds interval(100 + i % 50);
+            lastRuns[i] = Scheduler::Clock::now();
+            handles.push_back(pScheduler->RunEvery([&latencies, &lastRuns, i, interval] {
+                const auto now = Scheduler::Clock::now();
+                latencies.Add(now - lastRuns[i] - interval);
+                lastRuns[i] = now;
+            }, interval));
+        }
+
+        std::this_thread::sleep_for(seconds(2));
+        for (Scheduler::Handle& handle : handles)
+        {
+            handle.Cancel();
+        }
+
+        std::this_thread::sleep_for(milliseconds(200));
+        latencies.Print("RunEvery (10k tasks)");
+    }
+
+    // 10k periodic tasks that aren't due for an hour, so the scheduler should sit idle.
+    {
+        for (size_t i = 0; i < 10000; i++)
+        {
+            pScheduler->RunEvery([] { }, hours(1));
+        }
+
+        const double cpuBefore = GetCPUSeconds();
+        std::this_thread::sleep_for(seconds(2));
+        const double cpuUsed = GetCPUSeconds() - cpuBefore;
+
+        std::cout << "Idle CPU (10k tasks): " << (cpuUsed / 2.0) * 100.0 << "% of a core" << std::endl;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include <catch.hpp>
+
+#include <mw/core/common/ThreadManager.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+static std::string ExpectedName(const std::string& name, const std::thread::id& threadId)
+{
+    std::stringstream ss;
+    ss << "[" << name << ":" << threadId << "]";
+    return ss.str();
+}
+
+TEST_CASE("ThreadManager - CreateThread")
+{
+    int received = 0;
+    std::string name;
+    std::thread::id threadId;
+    std::thread thread = ThreadManagerAPI::CreateThread(
+        "TEST_THREAD",
+        [&received, &name, &threadId](const int value) {
+            received = value;
+            name = ThreadManagerAPI::GetCurrentThreadName();
+            threadId = std::this_thread::get_id();
+        },
+        5
+    );
+    thread.join();
+
+    REQUIRE(received == 5);
+    REQUIRE(name == ExpectedName("TEST_THREAD", threadId));
+}
+
+TEST_CASE("ThreadManager - Renaming")
+{
+    std::atomic_bool renamed(false);
+    std::atomic_bool done(false);
+    std::string before;
+    std::string first;
+    std::string after;
+
+    std::thread thread([&] {
+        before = ThreadManagerAPI::GetCurrentThreadName();
+        ThreadManagerAPI::SetCurrentThreadName("FIRST");
+        first = ThreadManagerAPI::GetCurrentThreadName();
+
+        // A name set by another thread replaces the cached one.
+        done = true;
+        while (!renamed)
+        {
+            std::this_thread::yield();
+        }
+
+        after = ThreadManagerAPI::GetCurrentThreadName();
+    });
+
+    while (!done)
+    {
+        std::this_thread::yield();
+    }
+
+    ThreadManagerAPI::SetThreadName(thread.get_id(), "SECOND");
+    renamed = true;
+
+    const std::thread::id threadId = thread.get_id();
+    thread.join();
+
+    std::stringstream ss;
+    ss << "[THREAD:" << threadId << "]";
+    REQUIRE(before == ss.str());
+    REQUIRE(first == ExpectedName("FIRST", threadId));
+    REQUIRE(after == ExpectedName("SECOND", threadId));
+}
+
+#if defined(__linux__)
+TEST_CASE("ThreadManager - OS Name and Affinity")
+{
+    // Pin to a CPU the process may actually run on, which isn't always CPU 0 under taskset or in a container.
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    REQUIRE(sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+
+    int target = 0;
+    while (!CPU_ISSET(target, &allowed))
+    {
+        target++;
+    }
+
+    char osName[16] = { 0 };
+    int cpu = -1;
+    int numAllowed = 0;
+    std::thread thread = ThreadManagerAPI::CreateThread(
+        ThreadManagerAPI::ThreadOptions({ "PINNED_THREAD_WITH_A_LONG_NAME", (size_t)target }),
+        [&osName, &cpu, &numAllowed] {
+            pthread_getname_np(pthread_self(), osName, sizeof(osName));
+            cpu = sched_getcpu();
+
+            cpu_set_t pinned;
+            CPU_ZERO(&pinned);
+            if (sched_getaffinity(0, sizeof(pinned), &pinned) == 0)
+            {
+                numAllowed = CPU_COUNT(&pinned);
+            }
+        }
+    );
+    thread.join();
+
+    REQUIRE(std::string(osName) == "PINNED_THREAD_W");
+    REQUIRE(cpu == target);
+    REQUIRE(numAllowed == 1);
+}
+#endif
+
+TEST_CASE("ThreadManager - Benchmark", "[.benchmark]")
+{
+    ThreadManagerAPI::SetCurrentThreadName("BENCHMARK");
+
+    const size_t numCalls = 10'000'000;
+    size_t totalLength = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < numCalls; i++)
+    {
+        totalLength += ThreadManagerAPI::GetCurrentThreadName().size();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "GetCurrentThreadName: "
+        << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / numCalls << "ns per call ("
+        << totalLength << ")" << std::endl;
+}
\ No newline at end of file
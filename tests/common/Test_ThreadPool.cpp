@@ -0,0 +1,168 @@
+#include <catch.hpp>
+
+#include <mw/core/common/ThreadPool.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("ThreadPool - Submit")
+{
+    auto pPool = ThreadPool::Create(4);
+
+    std::vector<std::future<size_t>> futures;
+    for (size_t i = 0; i < 1000; i++)
+    {
+        futures.push_back(pPool->Submit([i] { return i * i; }));
+    }
+
+    for (size_t i = 0; i < futures.size(); i++)
+    {
+        REQUIRE(futures[i].get() == i * i);
+    }
+
+    std::future<void> failed = pPool->Submit([] { throw std::runtime_error("failed"); });
+    REQUIRE_THROWS_AS(failed.get(), std::runtime_error);
+}
+
+TEST_CASE("ThreadPool - ParallelFor")
+{
+    auto pPool = ThreadPool::Create(4);
+
+    // Every index is visited exactly once.
+    std::vector<std::atomic<int>> visits(10007);
+    pPool->ParallelFor(0, visits.size(), 100, [&visits](const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            visits[i]++;
+        }
+    });
+
+    for (const std::atomic<int>& numVisits : visits)
+    {
+        REQUIRE(numVisits == 1);
+    }
+
+    // Nested inside tasks on the same pool, with more loops than workers, so the callers have to do the work.
+    std::atomic<size_t> total(0);
+    std::vector<std::future<void>> futures;
+    for (size_t i = 0; i < 16; i++)
+    {
+        futures.push_back(pPool->Submit([&pPool, &total] {
+            pPool->ParallelFor(0, 1000, 10, [&total](const size_t begin, const size_t end) { total += end - begin; });
+        }));
+    }
+
+    for (auto& future : futures)
+    {
+        future.get();
+    }
+
+    REQUIRE(total == 16000);
+
+    // The first exception is rethrown, once every chunk has run.
+    std::atomic<size_t> numRun(0);
+    REQUIRE_THROWS_AS(
+        pPool->ParallelFor(0, 100, 1, [&numRun](const size_t begin, const size_t) {
+            numRun++;
+            if (begin == 50)
+            {
+                throw std::runtime_error("failed");
+            }
+        }),
+        std::runtime_error
+    );
+    REQUIRE(numRun == 100);
+}
+
+TEST_CASE("ThreadPool - Priority")
+{
+    auto pPool = ThreadPool::Create(1);
+
+    // Hold the only worker, so everything below is queued before anything runs.
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::future<void> blocker = pPool->Submit([released] { released.wait(); });
+
+    std::mutex mutex;
+    std::vector<ETaskPriority> order;
+    auto record = [&mutex, &order](const ETaskPriority priority) {
+        return [&mutex, &order, priority] {
+            std::unique_lock<std::mutex> lock(mutex);
+            order.push_back(priority);
+        };
+    };
+
+    std::vector<std::future<void>> futures;
+    futures.push_back(pPool->Submit(record(ETaskPriority::LOW), ETaskPriority::LOW));
+    futures.push_back(pPool->Submit(record(ETaskPriority::NORMAL), ETaskPriority::NORMAL));
+    futures.push_back(pPool->Submit(record(ETaskPriority::HIGH), ETaskPriority::HIGH));
+
+    release.set_value();
+    blocker.get();
+    for (auto& future : futures)
+    {
+        future.get();
+    }
+
+    REQUIRE(order == std::vector<ETaskPriority>({ ETaskPriority::HIGH, ETaskPriority::NORMAL, ETaskPriority::LOW }));
+}
+
+TEST_CASE("WorkStealingDeque")
+{
+    WorkStealingDeque<size_t*> deque(2);
+    std::vector<size_t> items(100000);
+
+    // The owner pushes and pops while thieves steal. Every item must be taken exactly once.
+    std::atomic<size_t> numTaken(0);
+    std::vector<std::atomic<int>> taken(items.size());
+    std::atomic_bool done(false);
+
+    std::vector<std::thread> thieves;
+    for (size_t t = 0; t < 3; t++)
+    {
+        thieves.push_back(std::thread([&] {
+            while (!done)
+            {
+                size_t* pItem = deque.Steal();
+                if (pItem != nullptr)
+                {
+                    taken[pItem - items.data()]++;
+                    numTaken++;
+                }
+            }
+        }));
+    }
+
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        deque.Push(&items[i]);
+        if (i % 3 == 0)
+        {
+            size_t* pItem = deque.Pop();
+            if (pItem != nullptr)
+            {
+                taken[pItem - items.data()]++;
+                numTaken++;
+            }
+        }
+    }
+
+    for (size_t* pItem = deque.Pop(); pItem != nullptr; pItem = deque.Pop())
+    {
+        taken[pItem - items.data()]++;
+        numTaken++;
+    }
+
+    while (numTaken < items.size()) { }
+    done = true;
+    for (auto& thief : thieves)
+    {
+        thief.join();
+    }
+
+    for (const std::atomic<int>& numTimes : taken)
+    {
+        REQUIRE(numTimes == 1);
+    }
+}
\ No newline at end of file
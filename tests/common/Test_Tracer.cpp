@@ -0,0 +1,181 @@
+#include <catch.hpp>
+
+#include <mw/core/common/ThreadManager.h>
+#include <mw/core/common/Tracer.h>
+#include <TracerImpl.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+
+static std::vector<TraceRecord> Filter(const TraceDump& dump, const uint64_t payload2)
+{
+    std::vector<TraceRecord> records;
+    std::copy_if(
+        dump.records.cbegin(), dump.records.cend(), std::back_inserter(records),
+        [payload2](const TraceRecord& record) { return record.payload2 == payload2; }
+    );
+    return records;
+}
+
+TEST_CASE("Tracer - Disabled")
+{
+    TracerAPI::SetEnabled(false);
+    REQUIRE_FALSE(Tracer::IsEnabled());
+
+    std::thread([] {
+        MW_TRACE_SCOPE(MMR_APPEND, 0, 0xD15AB1ED);
+        MW_TRACE_EVENT(MMR_APPEND, 0, 0xD15AB1ED);
+    }).join();
+
+    REQUIRE(Filter(TracerAPI::Collect(), 0xD15AB1ED).empty());
+}
+
+TEST_CASE("Tracer - Threads")
+{
+    TracerAPI::SetEnabled(true);
+
+    const size_t numThreads = 4;
+    const size_t numScopes = 1000;
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([t, numScopes] {
+            for (size_t i = 0; i < numScopes; i++)
+            {
+                MW_TRACE_SCOPE(MMR_APPEND, t * numScopes + i, 0x7EAD);
+            }
+        }));
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    TracerAPI::SetEnabled(false);
+
+    const std::vector<TraceRecord> records = Filter(TracerAPI::Collect(), 0x7EAD);
+    REQUIRE(records.size() == numThreads * numScopes * 2);
+    REQUIRE(std::is_sorted(
+        records.cbegin(), records.cend(),
+        [](const TraceRecord& lhs, const TraceRecord& rhs) { return lhs.timestamp < rhs.timestamp; }
+    ));
+
+    // Each thread's scopes come out in order, with every BEGIN followed by its END.
+    std::map<uint32_t, std::vector<TraceRecord>> byThread;
+    for (const TraceRecord& record : records)
+    {
+        byThread[record.threadId].push_back(record);
+    }
+
+    REQUIRE(byThread.size() == numThreads);
+    for (const auto& thread : byThread)
+    {
+        const std::vector<TraceRecord>& threadRecords = thread.second;
+        for (size_t i = 0; i < threadRecords.size(); i += 2)
+        {
+            REQUIRE(threadRecords[i].phase == ETracePhase::BEGIN);
+            REQUIRE(threadRecords[i + 1].phase == ETracePhase::END);
+            REQUIRE(threadRecords[i].payload1 == threadRecords[i + 1].payload1);
+            REQUIRE(threadRecords[i].event == ETraceEvent::MMR_APPEND);
+            REQUIRE((i == 0 || threadRecords[i].payload1 == threadRecords[i - 1].payload1 + 1));
+        }
+    }
+}
+
+TEST_CASE("Tracer - Wrap")
+{
+    TracerAPI::SetEnabled(true);
+
+    // Only the most recent events are kept. The oldest slot is the one the owner would write next, so it's never copied.
+    const uint64_t numEvents = TraceBuffers::BUFFER_SIZE * 3 + 5;
+    std::thread([numEvents] {
+        for (uint64_t i = 0; i < numEvents; i++)
+        {
+            MW_TRACE_EVENT(DB_GET, i, 0x3A9);
+        }
+    }).join();
+
+    TracerAPI::SetEnabled(false);
+
+    const std::vector<TraceRecord> records = Filter(TracerAPI::Collect(), 0x3A9);
+    REQUIRE(records.size() == TraceBuffers::BUFFER_SIZE - 1);
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        REQUIRE(records[i].payload1 == numEvents - records.size() + i);
+        REQUIRE(records[i].phase == ETracePhase::INSTANT);
+    }
+}
+
+TEST_CASE("Tracer - Thread churn")
+{
+    TracerAPI::SetEnabled(true);
+
+    // Each thread reuses the buffer the last one gave back, so only the names of threads whose events are still there are kept.
+    const uint64_t numThreads = TraceBuffers::BUFFER_SIZE + 500;
+    for (uint64_t i = 0; i < numThreads; i++)
+    {
+        std::thread([i] {
+            ThreadManagerAPI::SetCurrentThreadName("TRACE_CHURN");
+            MW_TRACE_EVENT(DB_PUT, i, 0xC4);
+        }).join();
+    }
+
+    TracerAPI::SetEnabled(false);
+
+    const TraceDump dump = TracerAPI::Collect();
+    const std::vector<TraceRecord> records = Filter(dump, 0xC4);
+    REQUIRE(records.size() == TraceBuffers::BUFFER_SIZE - 1);
+    REQUIRE(records.back().payload1 == numThreads - 1);
+
+    std::map<uint32_t, std::string> names(dump.threads.cbegin(), dump.threads.cend());
+    size_t numChurnNames = 0;
+    for (const auto& thread : dump.threads)
+    {
+        numChurnNames += thread.second.find("TRACE_CHURN") != std::string::npos ? 1 : 0;
+    }
+
+    // Names are only pruned when a thread takes the buffer, so the owner of the slot its first event overwrites is still listed.
+    REQUIRE(numChurnNames <= TraceBuffers::BUFFER_SIZE + 1);
+    for (const TraceRecord& record : records)
+    {
+        REQUIRE(names[record.threadId].find("TRACE_CHURN") != std::string::npos);
+    }
+}
+
+TEST_CASE("Tracer - Dump")
+{
+    const FilePath path(fs::temp_directory_path() / ("trace_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count())));
+
+    TracerAPI::SetEnabled(true);
+    {
+        MW_TRACE_SCOPE(DB_COMMIT, 42, 0xD0);
+    }
+    TracerAPI::SetEnabled(false);
+
+    TracerAPI::Dump(path);
+    const TraceDump loaded = TracerAPI::Load(path);
+    const TraceDump collected = TracerAPI::Collect();
+
+    REQUIRE(loaded.threads == collected.threads);
+    REQUIRE(loaded.records.size() == collected.records.size());
+    REQUIRE(std::equal(
+        loaded.records.cbegin(), loaded.records.cend(), collected.records.cbegin(),
+        [](const TraceRecord& lhs, const TraceRecord& rhs) {
+            return lhs.timestamp == rhs.timestamp && lhs.threadId == rhs.threadId && lhs.event == rhs.event && lhs.phase == rhs.phase
+                && lhs.payload1 == rhs.payload1 && lhs.payload2 == rhs.payload2;
+        }
+    ));
+
+    const std::vector<TraceRecord> records = Filter(loaded, 0xD0);
+    REQUIRE(records.size() == 2);
+    REQUIRE(records[0].payload1 == 42);
+    REQUIRE(TracerAPI::GetEventName(records[0].event) == "DB_COMMIT");
+
+    path.Remove();
+    REQUIRE_THROWS(TracerAPI::Load(path));
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include <catch.hpp>
+
+#include <mw/core/consensus/CutThroughVerifier.h>
+#include <mw/core/crypto/Random.h>
+
+static Commitment RandomCommitment()
+{
+    return Crypto::CommitBlinded(Random::CSPRNG<1>().GetBigInt()[0], Random::CSPRNG<32>().GetBigInt());
+}
+
+static Output CreateOutput(const Commitment& commitment)
+{
+    return Output(
+        EOutputFeatures::DEFAULT_OUTPUT,
+        Commitment(commitment),
+        std::make_shared<const RangeProof>(std::vector<uint8_t>({ 1, 2, 3 }))
+    );
+}
+
+TEST_CASE("CutThroughVerifier")
+{
+    const Commitment commit1 = RandomCommitment();
+    const Commitment commit2 = RandomCommitment();
+    const Commitment commit3 = RandomCommitment();
+    const Commitment commit4 = RandomCommitment();
+
+    std::vector<Output> outputs({ CreateOutput(commit1), CreateOutput(commit2), CreateOutput(commit3) });
+
+    // No overlap
+    {
+        std::vector<Input> inputs({ Input(EOutputFeatures::DEFAULT_OUTPUT, Commitment(commit4)) });
+
+        REQUIRE_NOTHROW(CutThroughVerifier::VerifyCutThrough(inputs, outputs));
+        REQUIRE(CutThroughVerifier::FindCutThrough(inputs, outputs).empty());
+    }
+
+    // Input spends an output in the same set
+    {
+        std::vector<Input> inputs({
+            Input(EOutputFeatures::DEFAULT_OUTPUT, Commitment(commit4)),
+            Input(EOutputFeatures::DEFAULT_OUTPUT, Commitment(commit3))
+        });
+
+        REQUIRE_THROWS_AS(CutThroughVerifier::VerifyCutThrough(inputs, outputs), ValidationException);
+
+        const auto pairs = CutThroughVerifier::FindCutThrough(inputs, outputs);
+        REQUIRE(pairs.size() == 1);
+        REQUIRE(pairs[0].first == 1);
+        REQUIRE(pairs[0].second == 2);
+    }
+
+    // Duplicate commitments are matched one-to-one
+    {
+        outputs.push_back(CreateOutput(commit1));
+
+        std::vector<Input> inputs({
+            Input(EOutputFeatures::DEFAULT_OUTPUT, Commitment(commit1)),
+            Input(EOutputFeatures::DEFAULT_OUTPUT, Commitment(commit2)),
+            Input(EOutputFeatures::DEFAULT_OUTPUT, Commitment(commit1)),
+            Input(EOutputFeatures::DEFAULT_OUTPUT, Commitment(commit1))
+        });
+
+        const auto pairs = CutThroughVerifier::FindCutThrough(inputs, outputs);
+        REQUIRE(pairs.size() == 3);
+        for (const auto& pair : pairs)
+        {
+            REQUIRE(inputs[pair.first].GetCommitment() == outputs[pair.second].GetCommitment());
+        }
+    }
+
+    // Empty sets
+    {
+        REQUIRE_NOTHROW(CutThroughVerifier::VerifyCutThrough(std::vector<Input>(), outputs));
+        REQUIRE(CutThroughVerifier::FindCutThrough(std::vector<Input>(), outputs).empty());
+    }
+}
\ No newline at end of file
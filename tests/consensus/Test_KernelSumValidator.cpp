@@ -0,0 +1,67 @@
+#include <catch.hpp>
+
+#include <mw/core/consensus/KernelSumValidator.h>
+#include <mw/core/crypto/Random.h>
+
+TEST_CASE("KernelSumValidator")
+{
+    const BlindingFactor inputBlind = Random::CSPRNG<32>().GetBigInt();
+    const BlindingFactor outputBlind = Random::CSPRNG<32>().GetBigInt();
+    const BlindingFactor offset = Random::CSPRNG<32>().GetBigInt();
+
+    // 10 in, 8 out, 2 overage (fee)
+    const Commitment input = Crypto::CommitBlinded(10, inputBlind);
+    const Commitment output = Crypto::CommitBlinded(8, outputBlind);
+    const Commitment excess = Crypto::CommitBlinded(0, Crypto::AddBlindingFactors({ outputBlind }, { inputBlind, offset }));
+
+    // Valid sums
+    const BlockSums blockSums = KernelSumValidator::ValidateKernelSums({ &input }, { &output }, { &excess }, 2, offset, tl::nullopt);
+    REQUIRE(blockSums.GetKernelSum() == Crypto::AddCommitments({ excess }, {}));
+    REQUIRE(blockSums.GetOutputSum() == Crypto::AddCommitments({ output, Crypto::CommitTransparent(2) }, { input }));
+
+    // Wrong overage or offset
+    REQUIRE_THROWS_AS(KernelSumValidator::ValidateKernelSums({ &input }, { &output }, { &excess }, 3, offset, tl::nullopt), ValidationException);
+    REQUIRE_THROWS_AS(KernelSumValidator::ValidateKernelSums({ &input }, { &output }, { &excess }, 2, BlindingFactor(), tl::nullopt), ValidationException);
+
+    // Next block builds on the previous sums
+    const BlindingFactor nextOutputBlind = Random::CSPRNG<32>().GetBigInt();
+    const BlindingFactor nextOffset = Random::CSPRNG<32>().GetBigInt();
+    const Commitment nextOutput = Crypto::CommitBlinded(7, nextOutputBlind);
+    const Commitment nextExcess = Crypto::CommitBlinded(0, Crypto::AddBlindingFactors({ nextOutputBlind }, { outputBlind, nextOffset }));
+    const BlindingFactor totalOffset = Crypto::AddBlindingFactors({ offset, nextOffset }, {});
+
+    REQUIRE_NOTHROW(KernelSumValidator::ValidateKernelSums({ &output }, { &nextOutput }, { &nextExcess }, 1, totalOffset, blockSums));
+    REQUIRE_THROWS_AS(KernelSumValidator::ValidateKernelSums({ &output }, { &nextOutput }, { &nextExcess }, 1, totalOffset, tl::nullopt), ValidationException);
+
+    // The most negative overage is committed to without overflowing
+    REQUIRE_THROWS_AS(KernelSumValidator::ValidateKernelSums({ &input }, { &output }, { &excess }, INT64_MIN, offset, tl::nullopt), ValidationException);
+
+    // Sums that aren't cached aren't treated as zero
+    BlockSumsCache cache;
+    const Hash previousHash = Random::CSPRNG<32>().GetBigInt();
+    REQUIRE_THROWS_AS(
+        KernelSumValidator::ValidateKernelSums(TxBody(), 0, BlindingFactor(), previousHash, Random::CSPRNG<32>().GetBigInt(), cache),
+        MissingBlockSumsException
+    );
+}
+
+TEST_CASE("BlockSumsCache")
+{
+    BlockSumsCache cache(2);
+
+    const Hash hash1 = Random::CSPRNG<32>().GetBigInt();
+    const Hash hash2 = Random::CSPRNG<32>().GetBigInt();
+    const Hash hash3 = Random::CSPRNG<32>().GetBigInt();
+    const BlockSums sums(Crypto::CommitTransparent(1), Crypto::CommitTransparent(2));
+
+    REQUIRE(!cache.Get(hash1).has_value());
+
+    cache.Add(hash1, sums);
+    REQUIRE(cache.Get(hash1).value() == sums);
+
+    // Least recently used entry is evicted
+    cache.Add(hash2, sums);
+    cache.Add(hash3, sums);
+    REQUIRE(!cache.Get(hash1).has_value());
+    REQUIRE(cache.Get(hash3).has_value());
+}
\ No newline at end of file
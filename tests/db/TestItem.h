@@ -0,0 +1,29 @@
+#pragma once
+
+#include <mw/core/Context.h>
+#include <mw/core/serialization/Serializer.h>
+#include <mw/core/traits/Serializable.h>
+#include <memory>
+
+//
+// Minimal serializable item for database tests.
+//
+class TestItem : public Traits::ISerializable
+{
+public:
+    using CPtr = std::shared_ptr<const TestItem>;
+
+    TestItem(const uint64_t value) : m_value(value) { }
+
+    uint64_t GetValue() const noexcept { return m_value; }
+
+    Serializer& Serialize(Serializer& serializer) const noexcept final { return serializer.Append<uint64_t>(m_value); }
+
+    static TestItem::CPtr Deserialize(const Context::CPtr&, Deserializer& deserializer)
+    {
+        return std::make_shared<const TestItem>(deserializer.Read<uint64_t>());
+    }
+
+private:
+    uint64_t m_value;
+};
\ No newline at end of file
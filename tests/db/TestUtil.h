@@ -0,0 +1,32 @@
+#pragma once
+
+#include <mw/core/file/FilePath.h>
+#include <mw/core/crypto/Random.h>
+#include <leveldb/db.h>
+
+class TestUtil
+{
+public:
+    static FilePath GetTempDir()
+    {
+        return FilePath(fs::temp_directory_path() / (Random::CSPRNG<8>().GetBigInt().ToHex() + ".db"));
+    }
+
+    static leveldb::DB* OpenDB(const FilePath& path)
+    {
+        path.CreateDirIfMissing();
+
+        leveldb::Options options;
+        options.create_if_missing = true;
+
+        leveldb::DB* pDB = nullptr;
+        leveldb::Status status = leveldb::DB::Open(options, path.u8string(), &pDB);
+        return status.ok() ? pDB : nullptr;
+    }
+
+    static bool Exists(leveldb::DB* pDB, const std::string& key)
+    {
+        std::string value;
+        return pDB->Get(leveldb::ReadOptions(), key, &value).ok();
+    }
+};
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include <catch.hpp>
+
+#include "TestUtil.h"
+#include "BlockDB.h"
+
+#include <mw/core/exceptions/DatabaseException.h>
+
+#include <fstream>
+#include <string>
+
+TEST_CASE("BlockDB - Reads After Failed Reconfigure")
+{
+    const FilePath path = TestUtil::GetTempDir();
+    {
+        auto pDatabase = Database::Open(nullptr, path.GetChild("blocks"), DBOptions::Sync());
+        auto pJournal = CommitJournal::Open(path.GetChild("journal.bin"), pDatabase->GetCommitSequence(), true);
+        auto pBlockDB = std::make_shared<BlockDB>(pDatabase, ChainStore::Load(path.GetChild("chain")), pJournal);
+        Config config({});
+        config.Set("db.profile", "steady");
+
+        // Breaks the next open, like in "Database::Reopen - Open Fails"
+        const std::string currentPath = path.GetChild("blocks").GetChild("CURRENT").u8string();
+        std::string current;
+        {
+            std::ifstream file(currentPath);
+            std::getline(file, current);
+        }
+        std::ofstream(currentPath, std::ios::trunc) << "MANIFEST-999999\n";
+
+        // Reconfigure is called while holding the write lock
+        pBlockDB->OnInitWrite();
+        REQUIRE_THROWS_AS(pBlockDB->Reconfigure(config), DatabaseException);
+        REQUIRE_FALSE(pDatabase->IsOpen());
+
+        // The reads are noexcept, so they find nothing rather than throwing
+        const Hash hash = Random::CSPRNG<32>().GetBigInt();
+        REQUIRE(pBlockDB->GetHeaderByHash(hash) == nullptr);
+        REQUIRE(pBlockDB->GetBlockByHash(hash) == nullptr);
+        REQUIRE(pBlockDB->GetBlockByHeight(0) == nullptr);
+        REQUIRE(pBlockDB->GetHeadersByHash({ hash }).empty());
+
+        const Commitment commitment(Random::CSPRNG<33>().GetBigInt());
+        REQUIRE(pBlockDB->GetUTXOInfos({ commitment }).empty());
+        REQUIRE(pBlockDB->GetUTXOs({ commitment }).empty());
+
+        std::ofstream(currentPath, std::ios::trunc) << current << "\n";
+        pBlockDB->Reconfigure(config);
+        REQUIRE(pDatabase->IsOpen());
+        REQUIRE(pBlockDB->GetHeaderByHash(hash) == nullptr);
+        pBlockDB->Commit();
+        pBlockDB->OnEndWrite();
+    }
+    path.Remove();
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include <catch.hpp>
+
+#include "TestUtil.h"
+#include "TestItem.h"
+#include "BlockPruner.h"
+
+static const DBTable BLOCK_TABLE = { 'B' };
+static const DBTable STATE_TABLE = { 'R' };
+
+TEST_CASE("BlockPruner")
+{
+    const FilePath path = TestUtil::GetTempDir();
+    const BlockPruner::Options options({ 2, std::chrono::milliseconds(1), 4 });
+
+    std::vector<Hash> hashes;
+    std::vector<DBEntry<TestItem>> entries;
+    for (uint64_t height = 0; height < 10; height++)
+    {
+        hashes.push_back(Random::CSPRNG<32>().GetBigInt());
+        entries.push_back(DBEntry<TestItem>(DBTable::ToItemKey(hashes.back()), std::make_shared<const TestItem>(height)));
+    }
+
+    {
+        auto pDatabase = Database::Open(nullptr, path);
+        pDatabase->Put(BLOCK_TABLE, entries).get();
+
+        BlockPruner pruner(pDatabase, BLOCK_TABLE, STATE_TABLE, options);
+        REQUIRE(pruner.GetScheduledHeight() == 0);
+
+        pruner.Prune(5, std::vector<Hash>(hashes.begin(), hashes.begin() + 5));
+        REQUIRE(pruner.GetScheduledHeight() == 5);
+        pruner.WaitUntilIdle();
+
+        for (uint64_t height = 0; height < 10; height++)
+        {
+            const bool exists = pDatabase->Get<TestItem>(BLOCK_TABLE, DBTable::ToItemKey(hashes[height])) != nullptr;
+            REQUIRE(exists == (height >= 5));
+        }
+
+        // Compacted after 4 blocks, and again once the queue drained.
+        // bytesReclaimed isn't checked, since blocks this small may never leave the memtable.
+        const BlockPruner::Stats stats = pruner.GetStats();
+        REQUIRE(stats.prunedHeight == 5);
+        REQUIRE(stats.blocksRemoved == 5);
+        REQUIRE(stats.numCompactions == 2);
+    }
+
+    // Pruning resumes where it left off
+    {
+        auto pDatabase = Database::Open(nullptr, path);
+        BlockPruner pruner(pDatabase, BLOCK_TABLE, STATE_TABLE, options);
+        REQUIRE(pruner.GetScheduledHeight() == 5);
+
+        pruner.Prune(7, std::vector<Hash>(hashes.begin() + 5, hashes.begin() + 7));
+        pruner.WaitUntilIdle();
+        REQUIRE(pDatabase->Get<TestItem>(BLOCK_TABLE, DBTable::ToItemKey(hashes[6])) == nullptr);
+        REQUIRE(pDatabase->Get<TestItem>(BLOCK_TABLE, DBTable::ToItemKey(hashes[7])) != nullptr);
+        REQUIRE(pruner.GetStats().prunedHeight == 7);
+        REQUIRE(pruner.GetStats().blocksRemoved == 2);
+    }
+
+    path.Remove();
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include <catch.hpp>
+
+#include "TestUtil.h"
+#include "ChainStore.h"
+
+#include <mw/core/exceptions/DatabaseException.h>
+#include <mw/core/file/File.h>
+
+TEST_CASE("ChainStore")
+{
+    const FilePath path = TestUtil::GetTempDir();
+
+    std::vector<Hash> hashes;
+    for (size_t i = 0; i < 10; i++)
+    {
+        hashes.push_back(Random::CSPRNG<32>().GetBigInt());
+    }
+
+    {
+        auto pChainStore = ChainStore::Load(path);
+        REQUIRE(pChainStore->GetNumBlocks() == 0);
+        REQUIRE(!pChainStore->GetHashByHeight(0).has_value());
+
+        for (size_t height = 0; height < 5; height++)
+        {
+            pChainStore->AddHash(height, hashes[height]);
+        }
+
+        // Readable before commit
+        REQUIRE(pChainStore->GetHashByHeight(4).value() == hashes[4]);
+        pChainStore->Commit();
+
+        REQUIRE(pChainStore->GetNumBlocks() == 5);
+        REQUIRE(pChainStore->GetHashByHeight(0).value() == hashes[0]);
+        REQUIRE(pChainStore->GetHashByHeight(4).value() == hashes[4]);
+        REQUIRE(!pChainStore->GetHashByHeight(5).has_value());
+        REQUIRE_THROWS_AS(pChainStore->AddHash(6, hashes[6]), DatabaseException);
+
+        // Rollback discards the changes
+        pChainStore->Rewind(2);
+        pChainStore->AddHash(2, hashes[9]);
+        REQUIRE(pChainStore->GetHashByHeight(2).value() == hashes[9]);
+        pChainStore->Rollback();
+        REQUIRE(pChainStore->GetHashByHeight(2).value() == hashes[2]);
+        REQUIRE(pChainStore->GetNumBlocks() == 5);
+
+        // Reorg: replace heights 3 and 4, then extend
+        pChainStore->AddHash(3, hashes[7]);
+        pChainStore->AddHash(4, hashes[8]);
+        pChainStore->AddHash(5, hashes[9]);
+        pChainStore->Commit();
+    }
+
+    {
+        auto pChainStore = ChainStore::Load(path);
+        REQUIRE(pChainStore->GetNumBlocks() == 6);
+        REQUIRE(pChainStore->GetHashByHeight(2).value() == hashes[2]);
+        REQUIRE(pChainStore->GetHashByHeight(3).value() == hashes[7]);
+        REQUIRE(pChainStore->GetHashByHeight(5).value() == hashes[9]);
+    }
+
+    // A partially written hash is dropped on load
+    File(path.GetChild("hashes.bin")).Write(6 * 32, std::vector<uint8_t>(10, 1), false);
+    {
+        auto pChainStore = ChainStore::Load(path);
+        REQUIRE(pChainStore->GetNumBlocks() == 6);
+        REQUIRE(pChainStore->GetHashByHeight(5).value() == hashes[9]);
+    }
+
+    path.Remove();
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include <catch.hpp>
+
+#include "common/CuckooFilter.h"
+
+#include <mw/core/crypto/Random.h>
+
+static std::vector<std::vector<uint8_t>> RandomKeys(const size_t count)
+{
+    std::vector<std::vector<uint8_t>> keys;
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto bytes = Random::CSPRNG<33>().GetBigInt();
+        keys.push_back(std::vector<uint8_t>(bytes.data(), bytes.data() + bytes.size()));
+    }
+
+    return keys;
+}
+
+TEST_CASE("CuckooFilter")
+{
+    CuckooFilter filter(10000);
+
+    const auto keys = RandomKeys(10000);
+    for (const auto& key : keys)
+    {
+        filter.Insert(key.data(), key.size());
+    }
+
+    // No false negatives
+    REQUIRE(filter.Size() == keys.size());
+    for (const auto& key : keys)
+    {
+        REQUIRE(filter.MayContain(key.data(), key.size()));
+    }
+
+    // Few false positives
+    size_t falsePositives = 0;
+    for (const auto& key : RandomKeys(10000))
+    {
+        falsePositives += filter.MayContain(key.data(), key.size()) ? 1 : 0;
+    }
+    REQUIRE(falsePositives < 20);
+
+    // Erase
+    for (size_t i = 0; i < keys.size() / 2; i++)
+    {
+        filter.Erase(keys[i].data(), keys[i].size());
+    }
+    REQUIRE(filter.Size() == keys.size() / 2);
+    for (size_t i = keys.size() / 2; i < keys.size(); i++)
+    {
+        REQUIRE(filter.MayContain(keys[i].data(), keys[i].size()));
+    }
+
+    filter.Clear();
+    REQUIRE(filter.Size() == 0);
+    REQUIRE(!filter.MayContain(keys.back().data(), keys.back().size()));
+}
+
+TEST_CASE("CuckooFilter - Overfilled")
+{
+    CuckooFilter filter(100);
+
+    // Far more keys than fit in the buckets end up in the stash
+    const auto keys = RandomKeys(2000);
+    for (const auto& key : keys)
+    {
+        filter.Insert(key.data(), key.size());
+    }
+
+    REQUIRE(filter.IsOverloaded());
+    for (const auto& key : keys)
+    {
+        REQUIRE(filter.MayContain(key.data(), key.size()));
+    }
+
+    for (const auto& key : keys)
+    {
+        filter.Erase(key.data(), key.size());
+    }
+    REQUIRE(filter.Size() == 0);
+    REQUIRE(!filter.IsOverloaded());
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include <catch.hpp>
+
+#include "TestUtil.h"
+#include "common/DBMigration.h"
+#include "UTXOProof.h"
+
+#include <mw/core/crypto/Random.h>
+#include <mw/core/models/crypto/Hash.h>
+#include <mw/core/models/tx/UTXOInfo.h>
+
+TEST_CASE("DBTable::BuildKey")
+{
+    const DBTable table('H');
+    const Hash hash = Random::CSPRNG<32>().GetBigInt();
+
+    const std::string key = table.BuildKey(hash.data(), hash.size());
+    REQUIRE(key.size() == 33);
+    REQUIRE(key[0] == 'H');
+    REQUIRE(key == table.BuildKey(DBTable::ToItemKey(hash)));
+}
+
+TEST_CASE("DBMigration")
+{
+    const FilePath path = TestUtil::GetTempDir();
+    leveldb::DB* pDB = TestUtil::OpenDB(path);
+    REQUIRE(pDB != nullptr);
+
+    const Hash hash1 = Random::CSPRNG<32>().GetBigInt();
+    const Hash hash2 = Random::CSPRNG<32>().GetBigInt();
+
+    // Write version 0 (hex) keys
+    REQUIRE(pDB->Put(leveldb::WriteOptions(), "H" + hash1.ToHex(), "header1").ok());
+    REQUIRE(pDB->Put(leveldb::WriteOptions(), "B" + hash2.ToHex(), "block2").ok());
+    REQUIRE(DBMigration::GetVersion(pDB) == 0);
+
+    DBMigration::Migrate(pDB);
+    REQUIRE(DBMigration::GetVersion(pDB) == DBMigration::CURRENT_VERSION);
+
+    const std::string headerKey = DBTable('H').BuildKey(DBTable::ToItemKey(hash1));
+    const std::string blockKey = DBTable('B').BuildKey(DBTable::ToItemKey(hash2));
+
+    std::string value;
+    REQUIRE(pDB->Get(leveldb::ReadOptions(), headerKey, &value).ok());
+    REQUIRE(value == "header1");
+    REQUIRE(pDB->Get(leveldb::ReadOptions(), blockKey, &value).ok());
+    REQUIRE(value == "block2");
+    REQUIRE(!TestUtil::Exists(pDB, "H" + hash1.ToHex()));
+    REQUIRE(!TestUtil::Exists(pDB, "B" + hash2.ToHex()));
+
+    // Migrating again is a no-op
+    DBMigration::Migrate(pDB);
+    REQUIRE(TestUtil::Exists(pDB, headerKey));
+    REQUIRE(TestUtil::Exists(pDB, blockKey));
+
+    delete pDB;
+    path.Remove();
+}
+
+TEST_CASE("DBMigration - Split UTXOs")
+{
+    const FilePath path = TestUtil::GetTempDir();
+    leveldb::DB* pDB = TestUtil::OpenDB(path);
+    REQUIRE(pDB != nullptr);
+
+    Output output(
+        EOutputFeatures::COINBASE_OUTPUT,
+        Commitment(Random::CSPRNG<33>().GetBigInt()),
+        std::make_shared<const RangeProof>(std::vector<uint8_t>(100, 1))
+    );
+    const UTXO utxo(5, mmr::LeafIndex::At(7), std::move(output));
+    const std::string itemKey = DBTable::ToItemKey(utxo.GetOutput().GetCommitment());
+
+    // Write a version 1 UTXO, including its output
+    Serializer version;
+    version.Append<uint32_t>(1);
+    REQUIRE(pDB->Put(leveldb::WriteOptions(), DBTable('M').BuildKey("version"), leveldb::Slice((const char*)version.data(), version.size())).ok());
+    const std::vector<uint8_t> serialized = utxo.Serialized();
+    REQUIRE(pDB->Put(leveldb::WriteOptions(), DBTable('U').BuildKey(itemKey), leveldb::Slice((const char*)serialized.data(), serialized.size())).ok());
+
+    DBMigration::Migrate(pDB);
+    REQUIRE(DBMigration::GetVersion(pDB) == DBMigration::CURRENT_VERSION);
+
+    std::string value;
+    REQUIRE(pDB->Get(leveldb::ReadOptions(), DBTable('U').BuildKey(itemKey), &value).ok());
+    Deserializer infoDeserializer(std::vector<uint8_t>(value.cbegin(), value.cend()));
+    UTXOInfo::CPtr pInfo = UTXOInfo::Deserialize(nullptr, infoDeserializer);
+    REQUIRE(pInfo->GetBlockHeight() == 5);
+    REQUIRE(pInfo->GetLeafIndex().GetLeafIndex() == 7);
+    REQUIRE(pInfo->GetFeatures() == EOutputFeatures::COINBASE_OUTPUT);
+
+    REQUIRE(pDB->Get(leveldb::ReadOptions(), DBTable('P').BuildKey(itemKey), &value).ok());
+    Deserializer proofDeserializer(std::vector<uint8_t>(value.cbegin(), value.cend()));
+    REQUIRE(UTXOProof::Deserialize(nullptr, proofDeserializer)->GetRangeProof()->vec() == utxo.GetOutput().GetRangeProof()->vec());
+
+    delete pDB;
+    path.Remove();
+}
\ No newline at end of file
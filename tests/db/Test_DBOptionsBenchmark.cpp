@@ -0,0 +1,92 @@
+#include <catch.hpp>
+
+#include "TestUtil.h"
+#include "common/Database.h"
+
+#include <chrono>
+#include <iostream>
+
+static const DBTable BLOB_TABLE = { 'X' };
+
+//
+// Opaque item of a fixed size, standing in for serialized headers and blocks.
+//
+class BlobItem : public Traits::ISerializable
+{
+public:
+    BlobItem(std::vector<uint8_t>&& bytes) : m_bytes(std::move(bytes)) { }
+
+    Serializer& Serialize(Serializer& serializer) const noexcept final { return serializer.Append(m_bytes); }
+
+    static std::shared_ptr<const BlobItem> Deserialize(const Context::CPtr&, Deserializer& deserializer)
+    {
+        return std::make_shared<const BlobItem>(deserializer.ReadVector(deserializer.GetRemainingSize()));
+    }
+
+private:
+    std::vector<uint8_t> m_bytes;
+};
+
+//
+// Writes numItems blobs of itemSize bytes in batches of 100, and returns the items written per second.
+//
+static double MeasureIngest(const DBOptions& options, const size_t numItems, const size_t itemSize)
+{
+    const FilePath path = TestUtil::GetTempDir();
+    double itemsPerSecond = 0.0;
+    {
+        auto pDatabase = Database::Open(nullptr, path, options);
+
+        const auto start = std::chrono::steady_clock::now();
+        std::shared_future<void> written;
+        for (size_t i = 0; i < numItems; i += 100)
+        {
+            std::vector<DBEntry<BlobItem>> entries;
+            for (size_t j = i; j < i + 100 && j < numItems; j++)
+            {
+                std::vector<uint8_t> bytes(itemSize, (uint8_t)j);
+                entries.push_back(DBEntry<BlobItem>(std::to_string(j), std::make_shared<const BlobItem>(std::move(bytes))));
+            }
+
+            written = pDatabase->Put(BLOB_TABLE, entries);
+        }
+
+        written.get();
+        pDatabase->Flush().get();
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        itemsPerSecond = numItems / elapsed.count();
+    }
+    path.Remove();
+
+    return itemsPerSecond;
+}
+
+//
+// Compares ingest under the sync and steady profiles. Hidden, so it only runs when asked for: Database_Tests [benchmark]
+//
+TEST_CASE("DBOptions - Ingest benchmark", "[.benchmark]")
+{
+    struct Workload
+    {
+        std::string name;
+        size_t numItems;
+        size_t itemSize;
+    };
+
+    const std::vector<Workload> workloads({
+        { "headers", 200000, 250 },
+        { "blocks", 10000, 20 * 1024 }
+    });
+
+    for (const Workload& workload : workloads)
+    {
+        for (const DBOptions& options : { DBOptions::Sync(), DBOptions::Steady() })
+        {
+            const double itemsPerSecond = MeasureIngest(options, workload.numItems, workload.itemSize);
+            std::cout << workload.name << " (" << options.profile << "): "
+                << (uint64_t)itemsPerSecond << " items/s, "
+                << (uint64_t)(itemsPerSecond * workload.itemSize / (1024 * 1024)) << " MB/s" << std::endl;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include <catch.hpp>
+
+#include "TestUtil.h"
+#include "common/DBWriter.h"
+
+#include <mw/core/crypto/Random.h>
+#include <mw/core/models/crypto/Hash.h>
+
+TEST_CASE("DBWriter")
+{
+    const FilePath path = TestUtil::GetTempDir();
+    std::shared_ptr<leveldb::DB> pDB(TestUtil::OpenDB(path));
+    REQUIRE(pDB != nullptr);
+
+    const auto pHash1 = std::make_shared<const Hash>(Random::CSPRNG<32>().GetBigInt());
+    const auto pHash2 = std::make_shared<const Hash>(Random::CSPRNG<32>().GetBigInt());
+
+    // Writes are readable before they are durable, and grouped until the flush latency passes
+    {
+        DBWriter writer(pDB, DBWriter::Options({ std::chrono::milliseconds(50), 1024 * 1024, false }));
+
+        leveldb::WriteBatch batch1;
+        batch1.Put("K1", pHash1->ToHex());
+        auto future1 = writer.Write(std::move(batch1), { { "K1", pHash1 } });
+
+        leveldb::WriteBatch batch2;
+        batch2.Put("K2", pHash2->ToHex());
+        auto future2 = writer.Write(std::move(batch2), { { "K2", pHash2 } });
+
+        REQUIRE(writer.Find("K1").value() == pHash1);
+        REQUIRE(writer.Find("K2").value() == pHash2);
+        REQUIRE(!writer.Find("K3").has_value());
+
+        future1.get();
+        future2.get();
+        REQUIRE(TestUtil::Exists(pDB.get(), "K1"));
+        REQUIRE(TestUtil::Exists(pDB.get(), "K2"));
+        REQUIRE(!writer.Find("K1").has_value());
+
+        // Deletes are pending as null values
+        leveldb::WriteBatch batch3;
+        batch3.Delete("K1");
+        writer.Write(std::move(batch3), { { "K1", nullptr } });
+        REQUIRE(writer.Find("K1").value() == nullptr);
+
+        writer.Flush().get();
+        REQUIRE(!TestUtil::Exists(pDB.get(), "K1"));
+        REQUIRE(!writer.Find("K1").has_value());
+        REQUIRE(writer.Flush().wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    }
+
+    // A full group is written without waiting for the flush latency
+    {
+        DBWriter writer(pDB, DBWriter::Options({ std::chrono::hours(1), 64, false }));
+
+        leveldb::WriteBatch batch;
+        batch.Put("K3", std::string(100, 'x'));
+        auto future = writer.Write(std::move(batch), { { "K3", pHash1 } });
+        REQUIRE(future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        REQUIRE(TestUtil::Exists(pDB.get(), "K3"));
+    }
+
+    // Pending writes are flushed on shutdown
+    {
+        DBWriter writer(pDB, DBWriter::Options({ std::chrono::hours(1), 1024 * 1024, false }));
+
+        leveldb::WriteBatch batch;
+        batch.Put("K4", pHash2->ToHex());
+        writer.Write(std::move(batch), { { "K4", pHash2 } });
+    }
+    REQUIRE(TestUtil::Exists(pDB.get(), "K4"));
+
+    // Stop() writes pending writes and joins the thread, even while the writer is still shared, and later writes throw
+    {
+        auto pWriter = std::make_shared<DBWriter>(pDB, DBWriter::Options({ std::chrono::hours(1), 1024 * 1024, false }));
+        DBWriter::Ptr pShared = pWriter;
+
+        leveldb::WriteBatch batch;
+        batch.Put("K5", pHash1->ToHex());
+        auto future = pWriter->Write(std::move(batch), { { "K5", pHash1 } });
+
+        pWriter->Stop();
+        REQUIRE(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+        REQUIRE(TestUtil::Exists(pDB.get(), "K5"));
+
+        leveldb::WriteBatch batch2;
+        batch2.Put("K6", pHash2->ToHex());
+        REQUIRE_THROWS_AS(pShared->Write(std::move(batch2), { { "K6", pHash2 } }), DatabaseException);
+    }
+
+    pDB.reset();
+    path.Remove();
+}
\ No newline at end of file
@@ -1,10 +1,370 @@
 #include <catch.hpp>
 
-#include <mw/core/file/FilePath.h>
+#include "TestUtil.h"
+#include "TestItem.h"
+#include "common/Database.h"
 
-TEST_CASE("Database")
+#include <fstream>
+
+static const DBTable ITEM_TABLE = { 'I' };
+
+static std::string ToKey(const uint64_t value)
+{
+    return std::to_string(value);
+}
+
+static std::vector<DBEntry<TestItem>> CreateEntries(const uint64_t begin, const uint64_t end)
+{
+    std::vector<DBEntry<TestItem>> entries;
+    for (uint64_t i = begin; i < end; i++)
+    {
+        entries.push_back(DBEntry<TestItem>(ToKey(i), std::make_shared<const TestItem>(i)));
+    }
+
+    return entries;
+}
+
+TEST_CASE("Database::MultiGet")
+{
+    const FilePath path = TestUtil::GetTempDir();
+    {
+        auto pDatabase = Database::Open(nullptr, path);
+        pDatabase->Put(ITEM_TABLE, CreateEntries(0, 5000)).get();
+
+        // Unsorted keys, with duplicates and misses
+        std::vector<std::string> keys({ ToKey(42), ToKey(7000), ToKey(3), ToKey(42), ToKey(4999) });
+        auto entries = pDatabase->MultiGet<TestItem>(ITEM_TABLE, keys);
+        REQUIRE(entries.size() == 5);
+        REQUIRE(entries[0]->item->GetValue() == 42);
+        REQUIRE(entries[1] == nullptr);
+        REQUIRE(entries[2]->item->GetValue() == 3);
+        REQUIRE(entries[3]->item->GetValue() == 42);
+        REQUIRE(entries[4]->item->GetValue() == 4999);
+
+        // Large batch, read across threads
+        keys.clear();
+        for (uint64_t i = 0; i < 6000; i++)
+        {
+            keys.push_back(ToKey((i * 7919) % 6000));
+        }
+
+        entries = pDatabase->MultiGet<TestItem>(ITEM_TABLE, keys);
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            const uint64_t value = (i * 7919) % 6000;
+            if (value < 5000)
+            {
+                REQUIRE(entries[i]->item->GetValue() == value);
+            }
+            else
+            {
+                REQUIRE(entries[i] == nullptr);
+            }
+        }
+
+        // Pending writes are visible
+        pDatabase->OnInitWrite();
+        pDatabase->Put(ITEM_TABLE, CreateEntries(5000, 5001));
+        entries = pDatabase->MultiGet<TestItem>(ITEM_TABLE, { ToKey(5000), ToKey(1) });
+        REQUIRE(entries[0]->item->GetValue() == 5000);
+        REQUIRE(entries[1]->item->GetValue() == 1);
+        pDatabase->Rollback();
+        pDatabase->OnEndWrite();
+
+        REQUIRE(pDatabase->MultiGet<TestItem>(ITEM_TABLE, { ToKey(5000) })[0] == nullptr);
+    }
+    path.Remove();
+}
+
+TEST_CASE("Database - Object cache")
+{
+    const DBTable CACHED_TABLE('C', DBTable::Options({ false, true }));
+
+    const FilePath path = TestUtil::GetTempDir();
+    {
+        auto pDatabase = Database::Open(nullptr, path);
+        pDatabase->Put(CACHED_TABLE, CreateEntries(0, 10)).get();
+        pDatabase->Flush().get();
+
+        // First read fills the cache, second read hits it
+        REQUIRE(pDatabase->Get<TestItem>(CACHED_TABLE, ToKey(1))->item->GetValue() == 1);
+        const auto pFirst = pDatabase->Get<TestItem>(CACHED_TABLE, ToKey(1))->item;
+        REQUIRE(pDatabase->Get<TestItem>(CACHED_TABLE, ToKey(1))->item == pFirst);
+        REQUIRE(pDatabase->MultiGet<TestItem>(CACHED_TABLE, { ToKey(1), ToKey(2) })[0]->item == pFirst);
+
+        ObjectCache::Stats stats = pDatabase->GetCacheStats();
+        REQUIRE(stats.numEntries == 2);
+        REQUIRE(stats.hits == 3);
+
+        // Writes in a batch are seen by the batch, but don't touch the cache until commit
+        pDatabase->OnInitWrite();
+        pDatabase->Put(CACHED_TABLE, std::vector<DBEntry<TestItem>>({ DBEntry<TestItem>(ToKey(1), std::make_shared<const TestItem>(100)) }));
+        REQUIRE(pDatabase->Get<TestItem>(CACHED_TABLE, ToKey(1))->item->GetValue() == 100);
+        pDatabase->Rollback();
+        pDatabase->OnEndWrite();
+        REQUIRE(pDatabase->Get<TestItem>(CACHED_TABLE, ToKey(1))->item == pFirst);
+
+        // Committed writes and deletes invalidate
+        pDatabase->Put(CACHED_TABLE, std::vector<DBEntry<TestItem>>({ DBEntry<TestItem>(ToKey(1), std::make_shared<const TestItem>(100)) }));
+        REQUIRE(pDatabase->Get<TestItem>(CACHED_TABLE, ToKey(1))->item->GetValue() == 100);
+        pDatabase->Delete(CACHED_TABLE, { ToKey(2) });
+        REQUIRE(pDatabase->Get<TestItem>(CACHED_TABLE, ToKey(2)) == nullptr);
+        REQUIRE(pDatabase->GetCacheStats().invalidations == 2);
+
+        // Background transactions invalidate too
+        pDatabase->Flush().get();
+        REQUIRE(pDatabase->Get<TestItem>(CACHED_TABLE, ToKey(3)) != nullptr);
+        DBTransaction tx = pDatabase->CreateTransaction();
+        tx.Delete(nullptr, CACHED_TABLE, ToKey(3));
+        tx.Commit();
+        REQUIRE(pDatabase->Get<TestItem>(CACHED_TABLE, ToKey(3)) == nullptr);
+    }
+    path.Remove();
+}
+
+TEST_CASE("ObjectCache")
+{
+    ObjectCache cache(16 * 1024);
+
+    // A fill racing with an invalidation is dropped
+    const uint64_t version = cache.GetVersion("a");
+    cache.Invalidate("a");
+    cache.Fill("a", std::make_shared<const TestItem>(1), 8, version);
+    REQUIRE(cache.Get("a") == nullptr);
+
+    cache.Fill("a", std::make_shared<const TestItem>(1), 8, cache.GetVersion("a"));
+    REQUIRE(cache.Get("a") != nullptr);
+
+    // Least recently used entries are evicted once over budget
+    for (uint64_t i = 0; i < 1000; i++)
+    {
+        const std::string key = ToKey(i);
+        cache.Fill(key, std::make_shared<const TestItem>(i), 8, cache.GetVersion(key));
+    }
+
+    const ObjectCache::Stats stats = cache.GetStats();
+    REQUIRE(stats.numBytes <= 16 * 1024);
+    REQUIRE(stats.evictions > 0);
+    REQUIRE(cache.Get(ToKey(0)) == nullptr);
+    REQUIRE(cache.Get(ToKey(999)) != nullptr);
+    REQUIRE(cache.GetStats().GetHitRate() > 0.0);
+}
+
+TEST_CASE("DBOptions::FromConfig")
+{
+    const DBOptions steady = DBOptions::FromConfig(Config({}));
+    REQUIRE(steady.profile == "steady");
+    REQUIRE(steady.writer.sync);
+
+    Config config({ { "db.profile", "sync" }, { "db.block_cache_mb", "100" }, { "db.max_open_files", "64" } });
+    const DBOptions sync = DBOptions::FromConfig(config);
+    REQUIRE(sync.profile == "sync");
+    REQUIRE(!sync.writer.sync);
+    REQUIRE(sync.writeBufferBytes == DBOptions::Sync().writeBufferBytes);
+    REQUIRE(sync.blockCacheBytes == 100 * 1024 * 1024);
+    REQUIRE(sync.maxOpenFiles == 64);
+
+    // Invalid values fall back to the profile
+    config.Set("db.sync", "true");
+    config.Set("db.object_cache_mb", "lots");
+    const DBOptions overridden = DBOptions::FromConfig(config);
+    REQUIRE(overridden.writer.sync);
+    REQUIRE(overridden.objectCacheBytes == DBOptions::Sync().objectCacheBytes);
+
+    // Keys outside of DBOptions use the same parsing
+    config.Set("db.utxo_cache_mb", "-");
+    REQUIRE(DBOptions::GetSize(config, "db.utxo_cache_mb", 128 * 1024 * 1024) == 128 * 1024 * 1024);
+    config.Set("db.utxo_cache_mb", "16");
+    REQUIRE(DBOptions::GetSize(config, "db.utxo_cache_mb", 128 * 1024 * 1024) == 16 * 1024 * 1024);
+}
+
+TEST_CASE("Database::Reopen")
 {
+    const FilePath path = TestUtil::GetTempDir();
+    {
+        auto pDatabase = Database::Open(nullptr, path, DBOptions::Sync());
+        pDatabase->Put(ITEM_TABLE, CreateEntries(0, 100));
+
+        // Pending group commits are written before the database is closed
+        pDatabase->Reopen(DBOptions::Steady());
+        REQUIRE(pDatabase->GetOptions().profile == "steady");
+        REQUIRE(pDatabase->Get<TestItem>(ITEM_TABLE, ToKey(99))->item->GetValue() == 99);
+
+        // A write in progress continues on the reopened database
+        pDatabase->OnInitWrite();
+        pDatabase->Reopen(DBOptions::Sync());
+        pDatabase->Put(ITEM_TABLE, CreateEntries(100, 101));
+        pDatabase->Commit();
+        pDatabase->OnEndWrite();
+        REQUIRE(pDatabase->Get<TestItem>(ITEM_TABLE, ToKey(100))->item->GetValue() == 100);
+
+        // An open snapshot holds the DB, so reopening fails and leaves the database as it was
+        DBSnapshot::CPtr pSnapshot = pDatabase->GetSnapshot();
+        REQUIRE_THROWS_AS(pDatabase->Reopen(DBOptions::Steady()), DatabaseException);
+        REQUIRE(pDatabase->GetOptions().profile == "sync");
+        pDatabase->Put(ITEM_TABLE, CreateEntries(101, 102));
+        REQUIRE(pDatabase->Get<TestItem>(ITEM_TABLE, ToKey(101))->item->GetValue() == 101);
+        REQUIRE(pSnapshot->Get<TestItem>(ITEM_TABLE, ToKey(100))->item->GetValue() == 100);
+        REQUIRE(pSnapshot->Get<TestItem>(ITEM_TABLE, ToKey(101)) == nullptr);
+
+        pSnapshot.reset();
+        pDatabase->Reopen(DBOptions::Steady());
+        REQUIRE(pDatabase->Get<TestItem>(ITEM_TABLE, ToKey(101))->item->GetValue() == 101);
+
+        // Snapshots keep the DB open after the database is destroyed
+        pSnapshot = pDatabase->GetSnapshot();
+        pDatabase.reset();
+        REQUIRE(pSnapshot->Get<TestItem>(ITEM_TABLE, ToKey(101))->item->GetValue() == 101);
+        REQUIRE(pSnapshot->Scan(ITEM_TABLE).Valid());
+    }
+    path.Remove();
+}
+
+TEST_CASE("Database::Reopen - Open Fails")
+{
+    const FilePath path = TestUtil::GetTempDir();
+    {
+        auto pDatabase = Database::Open(nullptr, path, DBOptions::Sync());
+        pDatabase->Put(ITEM_TABLE, CreateEntries(0, 10));
+
+        // LevelDB only reads CURRENT when it's opened, so pointing it at a missing manifest breaks the next open.
+        const std::string currentPath = path.GetChild("CURRENT").u8string();
+        std::string current;
+        {
+            std::ifstream file(currentPath);
+            std::getline(file, current);
+        }
+        std::ofstream(currentPath, std::ios::trunc) << "MANIFEST-999999\n";
+
+        // Opening with the old options fails too, so the database is left closed
+        REQUIRE_THROWS_AS(pDatabase->Reopen(DBOptions::Steady()), DatabaseException);
+        REQUIRE_THROWS_AS(pDatabase->Get<TestItem>(ITEM_TABLE, ToKey(0)), DatabaseException);
+        REQUIRE_THROWS_AS(pDatabase->Put(ITEM_TABLE, CreateEntries(10, 11)), DatabaseException);
+        REQUIRE_THROWS_AS(pDatabase->GetSnapshot(), DatabaseException);
+        REQUIRE_THROWS_AS(pDatabase->Scan(ITEM_TABLE), DatabaseException);
+
+        // Until it's reopened successfully
+        std::ofstream(currentPath, std::ios::trunc) << current << "\n";
+        pDatabase->Reopen(DBOptions::Steady());
+        REQUIRE(pDatabase->GetOptions().profile == "steady");
+        REQUIRE(pDatabase->Get<TestItem>(ITEM_TABLE, ToKey(9))->item->GetValue() == 9);
+    }
+    path.Remove();
+}
+
+TEST_CASE("Database::Scan")
+{
+    const FilePath path = TestUtil::GetTempDir();
+    {
+        DBOptions options = DBOptions::Steady();
+        options.writer.flushLatency = std::chrono::milliseconds(60000);
+        auto pDatabase = Database::Open(nullptr, path, options);
+
+        // 10-19 on disk, 20-24 waiting in the writer
+        pDatabase->Put(ITEM_TABLE, CreateEntries(10, 20));
+        pDatabase->Flush().get();
+        pDatabase->Put(ITEM_TABLE, CreateEntries(20, 25));
+        pDatabase->Put(DBTable('J'), CreateEntries(0, 5));
+
+        // Uncommitted writes and deletes in the batch
+        pDatabase->OnInitWrite();
+        pDatabase->Put(ITEM_TABLE, std::vector<DBEntry<TestItem>>({ DBEntry<TestItem>(ToKey(15), std::make_shared<const TestItem>(150)) }));
+        pDatabase->Delete(ITEM_TABLE, { ToKey(11), ToKey(21) });
+
+        auto scan = [](DBIterator iter) {
+            std::vector<uint64_t> values;
+            for (; iter.Valid(); iter.Next())
+            {
+                // 150 replaces 15
+                const uint64_t value = iter.GetItem<TestItem>()->GetValue();
+                REQUIRE(ToKey(value < 100 ? value : value / 10) == iter.GetKey());
+                values.push_back(value);
+            }
+            return values;
+        };
+
+        const std::vector<uint64_t> expected({ 10, 12, 13, 14, 150, 16, 17, 18, 19, 20, 22, 23, 24 });
+        REQUIRE(scan(pDatabase->Scan(ITEM_TABLE)) == expected);
+        REQUIRE(scan(pDatabase->Scan(ITEM_TABLE, "", "", DBIterator::Options({ 1, false }))) == expected);
+        REQUIRE(scan(pDatabase->Scan(ITEM_TABLE, ToKey(14), ToKey(21))) == std::vector<uint64_t>({ 14, 150, 16, 17, 18, 19, 20 }));
+        REQUIRE(scan(pDatabase->ScanPrefix(ITEM_TABLE, "2")) == std::vector<uint64_t>({ 20, 22, 23, 24 }));
+
+        // Deletes through the scan
+        pDatabase->DeleteAll(ITEM_TABLE);
+        REQUIRE(!pDatabase->Scan(ITEM_TABLE).Valid());
+        pDatabase->Commit();
+        pDatabase->OnEndWrite();
+
+        REQUIRE(!pDatabase->Scan(ITEM_TABLE).Valid());
+        REQUIRE(scan(pDatabase->Scan(DBTable('J'))).size() == 5);
+    }
+    path.Remove();
+}
+
+TEST_CASE("Database::GetSnapshot")
+{
+    const FilePath path = TestUtil::GetTempDir();
+    {
+        DBOptions options = DBOptions::Steady();
+        options.writer.flushLatency = std::chrono::milliseconds(60000);
+        auto pDatabase = Database::Open(nullptr, path, options);
+
+        // 10-14 on disk, 15-19 waiting in the writer
+        pDatabase->Put(ITEM_TABLE, CreateEntries(10, 15));
+        pDatabase->Flush().get();
+        pDatabase->Put(ITEM_TABLE, CreateEntries(15, 20));
+
+        // Uncommitted writes aren't in the snapshot
+        pDatabase->OnInitWrite();
+        pDatabase->Delete(ITEM_TABLE, { ToKey(10) });
+        pDatabase->Put(ITEM_TABLE, CreateEntries(20, 25));
+
+        DBSnapshot::CPtr pSnapshot = pDatabase->GetSnapshot();
+
+        pDatabase->Commit();
+        pDatabase->OnEndWrite();
+        pDatabase->Flush().get();
+        REQUIRE(pDatabase->Get<TestItem>(ITEM_TABLE, ToKey(10)) == nullptr);
+        REQUIRE(pDatabase->Get<TestItem>(ITEM_TABLE, ToKey(20)) != nullptr);
+
+        REQUIRE(pSnapshot->Get<TestItem>(ITEM_TABLE, ToKey(10))->item->GetValue() == 10);
+        REQUIRE(pSnapshot->Get<TestItem>(ITEM_TABLE, ToKey(17))->item->GetValue() == 17);
+        REQUIRE(pSnapshot->Get<TestItem>(ITEM_TABLE, ToKey(20)) == nullptr);
+
+        auto entries = pSnapshot->MultiGet<TestItem>(ITEM_TABLE, { ToKey(14), ToKey(22), ToKey(15) });
+        REQUIRE(entries.size() == 3);
+        REQUIRE(entries[0]->item->GetValue() == 14);
+        REQUIRE(entries[1] == nullptr);
+        REQUIRE(entries[2]->item->GetValue() == 15);
+
+        std::vector<uint64_t> values;
+        for (DBIterator iter = pSnapshot->Scan(ITEM_TABLE); iter.Valid(); iter.Next())
+        {
+            values.push_back(iter.GetItem<TestItem>()->GetValue());
+        }
+        REQUIRE(values == std::vector<uint64_t>({ 10, 11, 12, 13, 14, 15, 16, 17, 18, 19 }));
+    }
+    path.Remove();
+}
+
+TEST_CASE("Database::CommitJournaled")
+{
+    const FilePath path = TestUtil::GetTempDir();
+    {
+        auto pDatabase = Database::Open(nullptr, path);
+        REQUIRE(pDatabase->GetCommitSequence() == 0);
+
+        pDatabase->OnInitWrite();
+        pDatabase->Put(ITEM_TABLE, CreateEntries(0, 5));
+        pDatabase->CommitJournaled(7);
+        pDatabase->OnEndWrite();
+
+        REQUIRE(pDatabase->GetCommitSequence() == 7);
+        REQUIRE(pDatabase->Get<TestItem>(ITEM_TABLE, ToKey(4)) != nullptr);
+    }
     {
-        //FilePath path()
+        auto pDatabase = Database::Open(nullptr, path);
+        REQUIRE(pDatabase->GetCommitSequence() == 7);
     }
+    path.Remove();
 }
\ No newline at end of file
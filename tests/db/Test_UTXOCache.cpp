@@ -0,0 +1,238 @@
+#include <catch.hpp>
+
+#include "TestUtil.h"
+#include "UTXOCache.h"
+#include "CachedBlockDB.h"
+#include "BlockDB.h"
+
+static UTXO::CPtr CreateUTXO(const uint64_t blockHeight)
+{
+    Output output(
+        EOutputFeatures::DEFAULT_OUTPUT,
+        Commitment(Random::CSPRNG<33>().GetBigInt()),
+        std::make_shared<const RangeProof>(std::vector<uint8_t>(100, 1))
+    );
+    return std::make_shared<const UTXO>(blockHeight, mmr::LeafIndex::At(blockHeight), std::move(output));
+}
+
+static const Commitment& GetCommitment(const UTXO::CPtr& pUTXO)
+{
+    return pUTXO->GetOutput().GetCommitment();
+}
+
+static CommitJournal::Ptr OpenJournal(const Database::Ptr& pDatabase, const FilePath& path)
+{
+    return CommitJournal::Open(path.GetChild("journal.bin"), pDatabase->GetCommitSequence(), false);
+}
+
+TEST_CASE("UTXOCache")
+{
+    UTXOCache cache(1024 * 1024);
+
+    const UTXO::CPtr pUTXO1 = CreateUTXO(1);
+    const UTXO::CPtr pUTXO2 = CreateUTXO(2);
+    REQUIRE(!cache.Get(GetCommitment(pUTXO1)).has_value());
+
+    // Created and spent in the same batch: never written
+    cache.Add(pUTXO1, true);
+    cache.Add(pUTXO2, true);
+    cache.Spend(GetCommitment(pUTXO2));
+    REQUIRE(cache.Get(GetCommitment(pUTXO1)).value() == pUTXO1);
+    REQUIRE(!cache.Get(GetCommitment(pUTXO2)).has_value());
+
+    UTXOCache::Changes changes = cache.GetPendingChanges();
+    REQUIRE(changes.added == std::vector<UTXO::CPtr>({ pUTXO1 }));
+    REQUIRE(changes.removed.empty());
+    cache.Commit();
+
+    // Spending a committed UTXO removes it from the database
+    cache.Spend(GetCommitment(pUTXO1));
+    REQUIRE(cache.Get(GetCommitment(pUTXO1)).value() == nullptr);
+    changes = cache.GetPendingChanges();
+    REQUIRE(changes.added.empty());
+    REQUIRE(changes.removed == std::vector<Commitment>({ GetCommitment(pUTXO1) }));
+
+    // Rollback restores it
+    cache.Rollback();
+    REQUIRE(cache.Get(GetCommitment(pUTXO1)).value() == pUTXO1);
+
+    // SpendAll hides everything until rolled back
+    cache.SpendAll();
+    REQUIRE(cache.Get(GetCommitment(pUTXO1)).value() == nullptr);
+    REQUIRE(cache.GetPendingChanges().removeAll);
+    cache.Rollback();
+    REQUIRE(cache.Get(GetCommitment(pUTXO1)).value() == pUTXO1);
+
+    // Without proof that the database doesn't have it, spending an uncommitted UTXO still removes it from the database
+    const UTXO::CPtr pUTXO3 = CreateUTXO(3);
+    cache.Add(pUTXO3, false);
+    cache.Spend(GetCommitment(pUTXO3));
+    REQUIRE(cache.GetPendingChanges().removed == std::vector<Commitment>({ GetCommitment(pUTXO3) }));
+    cache.Rollback();
+}
+
+TEST_CASE("UTXOCache - Eviction")
+{
+    const UTXO::CPtr pOld = CreateUTXO(1);
+    UTXOCache cache(10 * 1024);
+
+    cache.Add(pOld, true);
+    cache.Commit();
+
+    for (uint64_t height = 2; height < 100; height++)
+    {
+        cache.Add(CreateUTXO(height), true);
+        cache.Commit();
+        REQUIRE(cache.GetCachedBytes() <= 10 * 1024);
+    }
+
+    // Lowest heights are evicted first
+    REQUIRE(!cache.Get(GetCommitment(pOld)).has_value());
+}
+
+TEST_CASE("CachedBlockDB")
+{
+    const FilePath path = TestUtil::GetTempDir();
+    {
+        auto pDatabase = Database::Open(nullptr, path);
+        auto pBlockDB = std::make_shared<BlockDB>(pDatabase, ChainStore::Load(path.GetChild("chain")), OpenJournal(pDatabase, path));
+        Locked<IBlockDB> cachedDB(std::make_shared<CachedBlockDB>(pBlockDB, 1024 * 1024));
+
+        const UTXO::CPtr pUTXO1 = CreateUTXO(1);
+        const UTXO::CPtr pUTXO2 = CreateUTXO(2);
+
+        {
+            auto pWriter = cachedDB.Write();
+            pWriter->AddUTXOs({ pUTXO1, pUTXO2 });
+            REQUIRE(pWriter->GetUTXOs({ GetCommitment(pUTXO1) }).size() == 1);
+
+            // Not written to the database until commit
+            REQUIRE(pBlockDB->GetUTXOs({ GetCommitment(pUTXO1) }).empty());
+        }
+
+        // Written back on commit
+        REQUIRE(pBlockDB->GetUTXOs({ GetCommitment(pUTXO1), GetCommitment(pUTXO2) }).size() == 2);
+
+        {
+            auto pWriter = cachedDB.Write();
+            pWriter->RemoveUTXOs({ GetCommitment(pUTXO1) });
+            REQUIRE(pWriter->GetUTXOs({ GetCommitment(pUTXO1) }).empty());
+            REQUIRE_THROWS_AS(pWriter->RemoveUTXOs({ GetCommitment(pUTXO1) }), DatabaseException);
+        }
+
+        auto utxos = cachedDB.Read()->GetUTXOs({ GetCommitment(pUTXO1), GetCommitment(pUTXO2) });
+        REQUIRE(utxos.size() == 1);
+        REQUIRE(utxos[GetCommitment(pUTXO2)]->GetBlockHeight() == 2);
+
+        auto infos = cachedDB.Read()->GetUTXOInfos({ GetCommitment(pUTXO1), GetCommitment(pUTXO2) });
+        REQUIRE(infos.size() == 1);
+        REQUIRE(infos[GetCommitment(pUTXO2)]->GetLeafIndex().GetLeafIndex() == 2);
+        REQUIRE(pBlockDB->GetUTXOs({ GetCommitment(pUTXO1) }).empty());
+
+        // A UTXO the database has, but the cache doesn't, is removed from the database when it's added again and spent
+        const UTXO::CPtr pUTXO3 = CreateUTXO(3);
+        pBlockDB->AddUTXOs({ pUTXO3 });
+        {
+            auto pWriter = cachedDB.Write();
+            pWriter->AddUTXOs({ pUTXO3 });
+            pWriter->RemoveUTXOs({ GetCommitment(pUTXO3) });
+        }
+        REQUIRE(pBlockDB->GetUTXOs({ GetCommitment(pUTXO3) }).empty());
+
+        {
+            auto pWriter = cachedDB.Write();
+            pWriter->RemoveAllUTXOs();
+        }
+
+        REQUIRE(cachedDB.Read()->GetUTXOs({ GetCommitment(pUTXO2) }).empty());
+        REQUIRE(pBlockDB->GetUTXOs({ GetCommitment(pUTXO2) }).empty());
+    }
+    path.Remove();
+}
+
+TEST_CASE("BlockDB - UTXOs")
+{
+    const FilePath path = TestUtil::GetTempDir();
+    const UTXO::CPtr pUTXO1 = CreateUTXO(1);
+    const UTXO::CPtr pUTXO2 = CreateUTXO(2);
+    const UTXO::CPtr pUTXO3 = CreateUTXO(3);
+
+    {
+        auto pDatabase = Database::Open(nullptr, path);
+        Locked<IBlockDB> blockDB(std::make_shared<BlockDB>(pDatabase, ChainStore::Load(path.GetChild("chain")), OpenJournal(pDatabase, path)));
+
+        blockDB.Write()->AddUTXOs({ pUTXO1, pUTXO2 });
+
+        // Rebuilt from the index and proof store
+        auto utxos = blockDB.Read()->GetUTXOs({ GetCommitment(pUTXO1), GetCommitment(pUTXO2), GetCommitment(pUTXO3) });
+        REQUIRE(utxos.size() == 2);
+        REQUIRE(utxos[GetCommitment(pUTXO1)]->GetOutput() == pUTXO1->GetOutput());
+        REQUIRE(utxos[GetCommitment(pUTXO2)]->GetBlockHeight() == 2);
+
+        auto infos = blockDB.Read()->GetUTXOInfos({ GetCommitment(pUTXO1), GetCommitment(pUTXO3) });
+        REQUIRE(infos.size() == 1);
+        REQUIRE(infos[GetCommitment(pUTXO1)]->GetBlockHeight() == 1);
+        REQUIRE(infos[GetCommitment(pUTXO1)]->GetFeatures() == EOutputFeatures::DEFAULT_OUTPUT);
+
+        // Rolled back changes are undone
+        {
+            auto pWriter = blockDB.BatchWrite();
+            pWriter->AddUTXOs({ pUTXO3 });
+            pWriter->RemoveUTXOs({ GetCommitment(pUTXO1) });
+            REQUIRE(pWriter->GetUTXOInfos({ GetCommitment(pUTXO1), GetCommitment(pUTXO3) }).size() == 1);
+        }
+        REQUIRE(blockDB.Read()->GetUTXOInfos({ GetCommitment(pUTXO1), GetCommitment(pUTXO3) }).size() == 1);
+
+        {
+            auto pWriter = blockDB.Write();
+            pWriter->RemoveUTXOs({ GetCommitment(pUTXO2) });
+            pWriter->AddUTXOs({ pUTXO3 });
+        }
+    }
+
+    // The filter is rebuilt from the index when reopened
+    {
+        auto pDatabase = Database::Open(nullptr, path);
+        Locked<IBlockDB> blockDB(std::make_shared<BlockDB>(pDatabase, ChainStore::Load(path.GetChild("chain")), OpenJournal(pDatabase, path)));
+
+        auto utxos = blockDB.Read()->GetUTXOs({ GetCommitment(pUTXO1), GetCommitment(pUTXO2), GetCommitment(pUTXO3) });
+        REQUIRE(utxos.size() == 2);
+        REQUIRE(utxos.count(GetCommitment(pUTXO2)) == 0);
+
+        // Removing all, then adding in the same batch, keeps the new UTXO
+        {
+            auto pWriter = blockDB.Write();
+            pWriter->RemoveAllUTXOs();
+            pWriter->AddUTXOs({ pUTXO2 });
+        }
+
+        REQUIRE(blockDB.Read()->GetUTXOs({ GetCommitment(pUTXO1), GetCommitment(pUTXO3) }).empty());
+        REQUIRE(blockDB.Read()->GetUTXOs({ GetCommitment(pUTXO2) }).size() == 1);
+    }
+    path.Remove();
+}
+
+TEST_CASE("BlockDB - CommitWith")
+{
+    const FilePath path = TestUtil::GetTempDir();
+    const UTXO::CPtr pUTXO = CreateUTXO(1);
+
+    {
+        auto pDatabase = Database::Open(nullptr, path);
+        Locked<IBlockDB> blockDB(std::make_shared<BlockDB>(pDatabase, ChainStore::Load(path.GetChild("chain")), OpenJournal(pDatabase, path)));
+        auto pFile = AppendOnlyFile::Load(path.GetChild("mmr.bin"));
+
+        {
+            auto pWriter = blockDB.BatchWrite();
+            pWriter->AddUTXOs({ pUTXO });
+            pFile->Append({ 1, 2, 3 });
+            pWriter->CommitWith({ pFile.get() });
+        }
+
+        // Committed together, so the batch writer has nothing left to roll back
+        REQUIRE(blockDB.Read()->GetUTXOs({ GetCommitment(pUTXO) }).size() == 1);
+        REQUIRE(File(path.GetChild("mmr.bin")).GetSize() == 3);
+        REQUIRE(pDatabase->GetCommitSequence() == 1);
+    }
+    path.Remove();
+}
\ No newline at end of file
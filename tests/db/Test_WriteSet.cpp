@@ -0,0 +1,115 @@
+#include <catch.hpp>
+
+#include "TestItem.h"
+#include "common/WriteSet.h"
+
+#include <thread>
+
+static void Put(WriteSet& writeSet, const std::string& key, const uint64_t value)
+{
+    Serializer serializer;
+    serializer.Append<uint64_t>(value);
+    writeSet.Put(key, serializer.data(), serializer.size(), std::make_shared<const TestItem>(value), false);
+}
+
+static uint64_t GetValue(const WriteSet::Entry* pEntry)
+{
+    return std::dynamic_pointer_cast<const TestItem>(pEntry->pObject)->GetValue();
+}
+
+TEST_CASE("WriteSet")
+{
+    WriteSet writeSet;
+    REQUIRE(writeSet.IsEmpty());
+
+    Put(writeSet, "b2", 2);
+    Put(writeSet, "a1", 1);
+    Put(writeSet, "b1", 3);
+    Put(writeSet, "c1", 4);
+
+    // Latest write wins, with its serialized value alongside
+    Put(writeSet, "b2", 5);
+    REQUIRE(writeSet.Size() == 4);
+    REQUIRE(GetValue(writeSet.Find("b2")) == 5);
+    REQUIRE(writeSet.Find("b2")->value.size() == 8);
+    REQUIRE(writeSet.Find("d1") == nullptr);
+
+    // Deletes are kept as tombstones
+    writeSet.Delete("c1", true);
+    writeSet.Delete("d1", false);
+    REQUIRE(writeSet.Find("c1")->IsDeleted());
+    REQUIRE(writeSet.Find("c1")->cached);
+    REQUIRE(writeSet.Find("d1")->IsDeleted());
+
+    // Key order
+    std::vector<std::string> keys;
+    writeSet.ForEach([&keys](const WriteSet::Entry& entry) { keys.push_back(std::string(entry.key)); });
+    REQUIRE(keys == std::vector<std::string>({ "a1", "b1", "b2", "c1", "d1" }));
+
+    // Prefix scans see keys added after the last scan
+    Put(writeSet, "b0", 6);
+    keys.clear();
+    writeSet.ForEachWithPrefix("b", [&keys](const WriteSet::Entry& entry) { keys.push_back(std::string(entry.key)); });
+    REQUIRE(keys == std::vector<std::string>({ "b0", "b1", "b2" }));
+
+    keys.clear();
+    writeSet.ForEachWithPrefix("e", [&keys](const WriteSet::Entry& entry) { keys.push_back(std::string(entry.key)); });
+    REQUIRE(keys.empty());
+}
+
+TEST_CASE("WriteSet - Large batch")
+{
+    WriteSet writeSet;
+    for (uint64_t i = 0; i < 10000; i++)
+    {
+        Put(writeSet, std::to_string(i), i);
+    }
+
+    // Keys stay valid as the entries and arena grow
+    for (uint64_t i = 0; i < 10000; i++)
+    {
+        REQUIRE(GetValue(writeSet.Find(std::to_string(i))) == i);
+    }
+
+    // A large value gets its own block
+    std::vector<uint8_t> bytes(100 * 1024, 7);
+    const size_t arenaBytes = writeSet.GetArenaBytes();
+    writeSet.Put("large", bytes.data(), bytes.size(), std::make_shared<const TestItem>(0), false);
+    REQUIRE(writeSet.GetArenaBytes() == arenaBytes + bytes.size());
+    REQUIRE(writeSet.Find("large")->value == std::string(bytes.size(), 7));
+}
+
+TEST_CASE("WriteSet - Concurrent readers")
+{
+    WriteSet writeSet;
+    for (uint64_t i = 0; i < 1000; i++)
+    {
+        Put(writeSet, std::to_string(i), i);
+    }
+
+    // Readers racing to sort the unsorted order all see it sorted
+    std::vector<size_t> counts(4);
+    std::vector<uint8_t> sorted(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < counts.size(); t++)
+    {
+        threads.push_back(std::thread([&writeSet, &counts, &sorted, t]() {
+            std::string previous;
+            bool inOrder = true;
+            writeSet.ForEach([&](const WriteSet::Entry& entry) {
+                inOrder &= previous < std::string(entry.key);
+                previous = std::string(entry.key);
+                counts[t]++;
+            });
+            sorted[t] = inOrder;
+        }));
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE(counts == std::vector<size_t>(4, 1000));
+    REQUIRE(sorted == std::vector<uint8_t>(4, 1));
+}
\ No newline at end of file
@@ -11,4 +11,11 @@ public:
         FilePath path(fs::temp_directory_path() / (Random::CSPRNG<2>().GetBigInt().ToHex() + ".tmp"));
         return File(std::move(path));
     }
+
+    static FilePath CreateTempDir()
+    {
+        FilePath path(fs::temp_directory_path() / Random::CSPRNG<6>().GetBigInt().ToHex());
+        path.CreateDirIfMissing();
+        return path;
+    }
 };
\ No newline at end of file
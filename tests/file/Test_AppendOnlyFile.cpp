@@ -0,0 +1,104 @@
+#include <catch.hpp>
+
+#include "TestUtil.h"
+
+#include <mw/core/file/AppendOnlyFile.h>
+#include <mw/core/file/FileRemover.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE("AppendOnlyFile - Snapshot")
+{
+    const FilePath dir = TestUtil::CreateTempDir();
+    FileRemover remover(dir);
+
+    auto pFile = AppendOnlyFile::Load(dir.GetChild("append.bin"));
+    pFile->Append({ 1, 2, 3, 4, 5, 6 });
+    pFile->Commit();
+
+    // The committing thread holds a snapshot across a rewind, which mustn't wait for it to be released.
+    AppendOnlyFile::Snapshot snapshot = pFile->GetSnapshot();
+    pFile->Rewind(2);
+    pFile->Append({ 7, 8 });
+    pFile->Commit();
+
+    REQUIRE(pFile->GetSize() == 4);
+    REQUIRE(pFile->Read(0, 4) == std::vector<uint8_t>({ 1, 2, 7, 8 }));
+
+    // The snapshot still sees the rewound bytes, including reads that straddle the truncation point.
+    REQUIRE(snapshot.GetSize() == 6);
+    REQUIRE(snapshot.Read(0, 6) == std::vector<uint8_t>({ 1, 2, 3, 4, 5, 6 }));
+    REQUIRE(snapshot.Read(4, 2) == std::vector<uint8_t>({ 5, 6 }));
+    REQUIRE_THROWS(snapshot.Read(5, 2));
+
+    // Rewinding again, past the first truncation point, preserves the bytes in front of it too.
+    AppendOnlyFile::Snapshot snapshot2 = pFile->GetSnapshot();
+    pFile->Rewind(1);
+    pFile->Commit();
+
+    REQUIRE(snapshot.Read(0, 6) == std::vector<uint8_t>({ 1, 2, 3, 4, 5, 6 }));
+    REQUIRE(snapshot2.Read(0, 4) == std::vector<uint8_t>({ 1, 2, 7, 8 }));
+    REQUIRE(pFile->GetSnapshot().Read(0, 1) == std::vector<uint8_t>({ 1 }));
+}
+
+TEST_CASE("AppendOnlyFile - Concurrent Snapshots")
+{
+    const FilePath dir = TestUtil::CreateTempDir();
+    FileRemover remover(dir);
+
+    // Each commit leaves the file holding byte i at position i, for sizes cycling between 64 and 127.
+    auto pFile = AppendOnlyFile::Load(dir.GetChild("append.bin"));
+    std::vector<uint8_t> bytes(128);
+    for (size_t i = 0; i < bytes.size(); i++)
+    {
+        bytes[i] = (uint8_t)i;
+    }
+
+    pFile->Append(std::vector<uint8_t>(bytes.begin(), bytes.begin() + 64));
+    pFile->Commit();
+
+    std::atomic_bool stop(false);
+    std::atomic<size_t> numMismatches(0);
+    std::vector<std::thread> readers;
+    for (size_t r = 0; r < 2; r++)
+    {
+        readers.push_back(std::thread([&pFile, &stop, &numMismatches, &bytes] {
+            while (!stop)
+            {
+                AppendOnlyFile::Snapshot snapshot = pFile->GetSnapshot();
+                std::this_thread::yield();
+
+                const std::vector<uint8_t> read = snapshot.Read(0, snapshot.GetSize());
+                if (read != std::vector<uint8_t>(bytes.begin(), bytes.begin() + read.size()))
+                {
+                    numMismatches++;
+                }
+            }
+        }));
+    }
+
+    for (size_t i = 0; i < 500; i++)
+    {
+        const uint64_t size = 64 + (i * 37) % 64;
+        if (size < pFile->GetSize())
+        {
+            pFile->Rewind(size);
+        }
+        else
+        {
+            pFile->Append(std::vector<uint8_t>(bytes.begin() + pFile->GetSize(), bytes.begin() + size));
+        }
+
+        pFile->Commit();
+    }
+
+    stop = true;
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+
+    REQUIRE(numMismatches == 0);
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include <catch.hpp>
+
+#include "TestUtil.h"
+
+#include <mw/core/file/AppendOnlyFile.h>
+#include <mw/core/file/BitmapFile.h>
+#include <mw/core/file/CommitJournal.h>
+#include <mw/core/file/FileRemover.h>
+
+#include <stdexcept>
+
+TEST_CASE("CommitJournal")
+{
+    const FilePath dir = TestUtil::CreateTempDir();
+    FileRemover remover(dir);
+
+    const FilePath journalPath = dir.GetChild("journal.bin");
+    const FilePath appendPath = dir.GetChild("append.bin");
+    const File bitmapFile(dir.GetChild("bitmap.bin"));
+
+    auto pJournal = CommitJournal::Open(journalPath, 0, false);
+    uint64_t dbSequence = 0;
+
+    // Commits the database, then crashes before the files are committed.
+    auto crashAfterDB = [&dbSequence](const uint64_t sequence) {
+        dbSequence = sequence;
+        throw std::runtime_error("crash");
+    };
+
+    // Crashes before the database commits.
+    auto crashBeforeDB = [](const uint64_t) { throw std::runtime_error("crash"); };
+
+    {
+        auto pAppendFile = AppendOnlyFile::Load(appendPath);
+        auto pBitmapFile = BitmapFile::Load(bitmapFile);
+
+        // Normal commit
+        pAppendFile->Append({ 1, 2, 3, 4 });
+        pBitmapFile->Set(3);
+        pJournal->Commit({ pAppendFile.get(), pBitmapFile.get() }, [&dbSequence](const uint64_t sequence) { dbSequence = sequence; });
+        REQUIRE(dbSequence == 1);
+        REQUIRE(pJournal->GetSequence() == 1);
+        REQUIRE(File(journalPath).GetSize() == 0);
+        REQUIRE(File(appendPath).ReadBytes() == std::vector<uint8_t>({ 1, 2, 3, 4 }));
+
+        // Nothing written to the files
+        pJournal->Commit({ pAppendFile.get(), pBitmapFile.get() }, [&dbSequence](const uint64_t sequence) { dbSequence = sequence; });
+        REQUIRE(dbSequence == 1);
+
+        // Rewind and append, plus bitmap changes, interrupted after the database commit
+        pAppendFile->Rewind(2);
+        pAppendFile->Append({ 5, 6, 7 });
+        pBitmapFile->Set(9);
+        pBitmapFile->Set(10);
+        pBitmapFile->Unset(3);
+        REQUIRE_THROWS(pJournal->Commit({ pAppendFile.get(), pBitmapFile.get() }, crashAfterDB));
+        REQUIRE(dbSequence == 2);
+        REQUIRE(File(appendPath).ReadBytes() == std::vector<uint8_t>({ 1, 2, 3, 4 }));
+    }
+
+    // Replayed, since the database has the commit
+    pJournal = CommitJournal::Open(journalPath, dbSequence, false);
+    REQUIRE(pJournal->GetSequence() == 2);
+    REQUIRE(File(journalPath).GetSize() == 0);
+    {
+        auto pAppendFile = AppendOnlyFile::Load(appendPath);
+        REQUIRE(pAppendFile->Read(0, pAppendFile->GetSize()) == std::vector<uint8_t>({ 1, 2, 5, 6, 7 }));
+
+        auto pBitmapFile = BitmapFile::Load(bitmapFile);
+        REQUIRE(!pBitmapFile->IsSet(3));
+        REQUIRE(pBitmapFile->IsSet(9));
+        REQUIRE(pBitmapFile->IsSet(10));
+
+        // Interrupted before the database commit
+        pAppendFile->Append({ 8 });
+        pBitmapFile->Set(4);
+        REQUIRE_THROWS(pJournal->Commit({ pAppendFile.get(), pBitmapFile.get() }, crashBeforeDB));
+        REQUIRE(File(journalPath).GetSize() > 0);
+    }
+
+    // Discarded, since the database never saw the commit
+    pJournal = CommitJournal::Open(journalPath, dbSequence, false);
+    REQUIRE(pJournal->GetSequence() == 2);
+    REQUIRE(File(journalPath).GetSize() == 0);
+    {
+        auto pAppendFile = AppendOnlyFile::Load(appendPath);
+        REQUIRE(pAppendFile->GetSize() == 5);
+        REQUIRE(!BitmapFile::Load(bitmapFile)->IsSet(4));
+
+        // Crash while writing the journal
+        pAppendFile->Append({ 9 });
+        REQUIRE_THROWS(pJournal->Commit({ pAppendFile.get() }, crashAfterDB));
+
+        File journalFile(journalPath);
+        journalFile.Truncate(journalFile.GetSize() - 1);
+    }
+
+    // A partial record is discarded
+    pJournal = CommitJournal::Open(journalPath, dbSequence, false);
+    REQUIRE(File(journalPath).GetSize() == 0);
+    REQUIRE(AppendOnlyFile::Load(appendPath)->GetSize() == 5);
+}
\ No newline at end of file
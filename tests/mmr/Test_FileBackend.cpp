@@ -1,5 +1,6 @@
 #include <catch.hpp>
 
+#include <mw/core/mmr/MMR.h>
 #include <mw/core/mmr/backends/FileBackend.h>
 #include <mw/core/models/tx/IKernel.h>
 #include <mw/core/crypto/Random.h>
@@ -26,4 +27,35 @@ TEST_CASE("mmr::FileBackend")
         auto pBackend = FileBackend::Open(tempDir, tl::nullopt);
         REQUIRE(pBackend->GetNumLeaves() == 1);
     }
+}
+
+TEST_CASE("mmr::FileBackend - Snapshot")
+{
+    FilePath tempDir = CreateTempDir();
+    FileRemover remover(tempDir);
+
+    {
+        MMR mmr(FileBackend::Open(tempDir, tl::nullopt));
+        mmr.Add({ 0, 1, 2 });
+        mmr.Add({ 1, 2, 3 });
+        mmr.Add({ 2, 3, 4 });
+        mmr.Commit();
+
+        MMR::CPtr pSnapshot = mmr.CreateSnapshot();
+        const Hash root = mmr.Root();
+        REQUIRE(pSnapshot->GetNumNodes() == 4);
+        REQUIRE(pSnapshot->Root() == root);
+
+        // Changes after the snapshot, committed or not, aren't seen
+        mmr.Add({ 3, 4, 5 });
+        REQUIRE(pSnapshot->GetNumNodes() == 4);
+        mmr.Commit();
+        mmr.Add({ 4, 5, 6 });
+        REQUIRE(mmr.GetNumNodes() == 8);
+
+        REQUIRE(pSnapshot->GetNumNodes() == 4);
+        REQUIRE(pSnapshot->Root() == root);
+        REQUIRE(pSnapshot->Get(LeafIndex::At(2)) == Leaf::Create(LeafIndex::At(2), { 2, 3, 4 }));
+        REQUIRE_THROWS(pSnapshot->Get(LeafIndex::At(3)));
+    }
 }
\ No newline at end of file
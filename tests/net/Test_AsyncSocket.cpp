@@ -0,0 +1,154 @@
+#include <catch.hpp>
+
+#include <mw/core/net/AsyncSocket.h>
+#include <mw/core/net/IOContextPool.h>
+#include <mw/core/net/Socket.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static asio::ip::tcp::acceptor CreateAcceptor(asio::io_context& context)
+{
+    return asio::ip::tcp::acceptor(context, asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0));
+}
+
+TEST_CASE("Socket")
+{
+    asio::ip::tcp::acceptor acceptor = CreateAcceptor(IOContextPool::GetDefault().GetContext());
+    const SocketAddress address("127.0.0.1", acceptor.local_endpoint().port());
+
+    Socket::Ptr pServerSocket;
+    std::thread server([&acceptor, &pServerSocket] { pServerSocket = Socket::Accept(acceptor, std::chrono::seconds(5)); });
+    Socket::Ptr pClientSocket = Socket::Connect(address, std::chrono::seconds(5));
+    server.join();
+    REQUIRE(pServerSocket != nullptr);
+
+    const std::string message = "hello\nworld";
+    pClientSocket->Write(message, std::chrono::seconds(5));
+    REQUIRE(pServerSocket->ReadLine(std::chrono::seconds(5)) == "hello");
+    REQUIRE(pServerSocket->Read(5, std::chrono::seconds(5)) == std::vector<uint8_t>(message.begin() + 6, message.end()));
+
+    pServerSocket->Write(std::vector<uint8_t>({ 1, 2, 3, 4 }), std::chrono::seconds(5));
+    REQUIRE(pClientSocket->ReadArray<4>(std::chrono::seconds(5)) == std::array<uint8_t, 4>({ 1, 2, 3, 4 }));
+
+    // Nothing more is sent, so the deadline closes the socket.
+    const auto start = std::chrono::steady_clock::now();
+    REQUIRE_THROWS_AS(pClientSocket->Read(1, std::chrono::milliseconds(50)), asio::system_error);
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+    REQUIRE_THROWS_AS(pClientSocket->Read(1, std::chrono::seconds(5)), asio::system_error);
+
+    // With no connection arriving, Accept gives up at the deadline.
+    REQUIRE_THROWS_AS(Socket::Accept(acceptor, std::chrono::milliseconds(50)), asio::system_error);
+}
+
+TEST_CASE("AsyncSocket - Many Connections")
+{
+    // Far more connections than threads, each waiting on its peer.
+    IOContextPool::Ptr pPool = IOContextPool::Create(2, "TEST_IO");
+    const size_t numConnections = 200;
+    const auto timeout = std::chrono::seconds(10);
+
+    asio::ip::tcp::acceptor acceptor = CreateAcceptor(pPool->GetContext());
+    const SocketAddress address("127.0.0.1", acceptor.local_endpoint().port());
+
+    // Echoes one line back on each connection.
+    std::atomic<size_t> numAccepted(0);
+    std::function<void()> acceptNext = [&]() {
+        AsyncSocket::AsyncAccept(acceptor, *pPool, [&](const asio::error_code& ec, AsyncSocket::Ptr pSocket) {
+            if (ec)
+            {
+                return;
+            }
+
+            if (++numAccepted < numConnections)
+            {
+                acceptNext();
+            }
+
+            pSocket->AsyncReadLine(timeout, [pSocket, timeout](const asio::error_code& ec, std::string&& line) {
+                if (!ec)
+                {
+                    pSocket->AsyncWrite(std::vector<uint8_t>(line.begin(), line.end()), timeout, [pSocket](const asio::error_code&) { });
+                    pSocket->AsyncWrite(std::vector<uint8_t>({ '\n' }), timeout, [pSocket](const asio::error_code&) { });
+                }
+            });
+        });
+    };
+    acceptNext();
+
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t numFinished = 0;
+    std::atomic<size_t> numEchoed(0);
+    auto finish = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        numFinished++;
+        done.notify_all();
+    };
+
+    for (size_t i = 0; i < numConnections; i++)
+    {
+        const std::string expected = "connection " + std::to_string(i);
+        AsyncSocket::AsyncConnect(*pPool, address, timeout, [&, expected, timeout](const asio::error_code& ec, AsyncSocket::Ptr pSocket) {
+            if (ec)
+            {
+                finish();
+                return;
+            }
+
+            const std::string line = expected + "\n";
+            pSocket->AsyncWrite(std::vector<uint8_t>(line.begin(), line.end()), timeout, [](const asio::error_code&) { });
+            pSocket->AsyncReadLine(timeout, [&, pSocket, expected](const asio::error_code& ec, std::string&& echoed) {
+                if (!ec && echoed == expected)
+                {
+                    numEchoed++;
+                }
+
+                finish();
+            });
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    REQUIRE(done.wait_for(lock, std::chrono::seconds(30), [&] { return numFinished == numConnections; }));
+    REQUIRE(numEchoed == numConnections);
+}
+
+TEST_CASE("AsyncSocket - Backpressure")
+{
+    asio::ip::tcp::acceptor acceptor = CreateAcceptor(IOContextPool::GetDefault().GetContext());
+    const SocketAddress address("127.0.0.1", acceptor.local_endpoint().port());
+
+    Socket::Ptr pServerSocket;
+    std::thread server([&acceptor, &pServerSocket] { pServerSocket = Socket::Accept(acceptor, std::chrono::seconds(5)); });
+
+    auto pPromise = std::make_shared<std::promise<AsyncSocket::Ptr>>();
+    AsyncSocket::AsyncConnect(IOContextPool::GetDefault(), address, std::chrono::seconds(5), [pPromise](const asio::error_code&, AsyncSocket::Ptr pSocket) {
+        pPromise->set_value(pSocket);
+    }, 1024 * 1024);
+    AsyncSocket::Ptr pClientSocket = pPromise->get_future().get();
+    server.join();
+    REQUIRE(pClientSocket != nullptr);
+
+    // The peer never reads, so a write larger than the kernel's buffers stays queued.
+    // A single oversized write is accepted when nothing else is queued, but nothing more is until it's sent.
+    auto pWritten = std::make_shared<std::promise<asio::error_code>>();
+    REQUIRE(pClientSocket->AsyncWrite(std::vector<uint8_t>(64 * 1024 * 1024), std::chrono::seconds(30), [pWritten](const asio::error_code& ec) {
+        pWritten->set_value(ec);
+    }));
+    REQUIRE(pClientSocket->GetQueuedBytes() == 64 * 1024 * 1024);
+    REQUIRE_FALSE(pClientSocket->AsyncWrite(std::vector<uint8_t>(1), std::chrono::seconds(30), [](const asio::error_code&) { }));
+
+    // Closing fails the outstanding write, and frees the queue.
+    pClientSocket->Close();
+    REQUIRE(pWritten->get_future().get());
+    REQUIRE(pClientSocket->GetQueuedBytes() == 0);
+}
\ No newline at end of file
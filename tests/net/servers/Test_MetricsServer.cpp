@@ -0,0 +1,45 @@
+#include <catch.hpp>
+
+#include <mw/core/common/Metrics.h>
+#include <mw/core/net/Socket.h>
+#include <mw/core/net/servers/MetricsServer.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+TEST_CASE("MetricsServer")
+{
+    MetricsAPI::GetCounter("test_metrics_server_total", "MetricsServer test counter.", MetricsAPI::FormatLabel("name", "a\"b")).Add(5);
+
+    MetricsServer::Ptr pServer = MetricsServer::Create();
+    REQUIRE(pServer->GetPortNumber() != 0);
+
+    const auto timeout = std::chrono::seconds(5);
+    Socket::Ptr pSocket = Socket::Connect(SocketAddress("127.0.0.1", pServer->GetPortNumber()), timeout);
+    pSocket->Write(std::string("GET /metrics HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: close\r\n\r\n"), timeout);
+
+    REQUIRE(pSocket->ReadLine(timeout) == "HTTP/1.1 200 OK\r");
+
+    size_t contentLength = 0;
+    std::string contentType;
+    for (std::string header = pSocket->ReadLine(timeout); header != "\r"; header = pSocket->ReadLine(timeout))
+    {
+        const std::string value = header.substr(header.find(':') + 2, header.size() - header.find(':') - 3);
+        if (header.find("Content-Length:") == 0)
+        {
+            contentLength = std::stoul(value);
+        }
+        else if (header.find("Content-Type:") == 0)
+        {
+            contentType = value;
+        }
+    }
+
+    REQUIRE(contentType == "text/plain; version=0.0.4");
+    REQUIRE(contentLength > 0);
+
+    const std::vector<uint8_t> body = pSocket->Read(contentLength, timeout);
+    const std::string text(body.begin(), body.end());
+    REQUIRE(text.find("# TYPE test_metrics_server_total counter\ntest_metrics_server_total{name=\"a\\\"b\"} 5\n") != std::string::npos);
+}
\ No newline at end of file